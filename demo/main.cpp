@@ -1,6 +1,7 @@
 #include "../src/meshoptimizer.h"
 
 #include <assert.h>
+#include <float.h>
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
@@ -329,6 +330,23 @@ void optCache(Mesh& mesh)
 	meshopt_optimizeVertexCache(&mesh.indices[0], &mesh.indices[0], mesh.indices.size(), mesh.vertices.size());
 }
 
+void optCacheChunked(Mesh& mesh)
+{
+	// chunks are much smaller than recommended so that the demo mesh is split into several chunks
+	meshopt_optimizeVertexCacheChunked(&mesh.indices[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), 1024);
+}
+
+void optCacheTable(Mesh& mesh)
+{
+	// example table in the format exported by vcachetuner; this one favors recently used vertices more strongly than the built-in table
+	const meshopt_VertexScoreTable table = {
+	    {0.f, 1.000f, 1.000f, 1.000f, 0.950f, 0.900f, 0.850f, 0.800f, 0.750f, 0.700f, 0.650f, 0.600f, 0.500f, 0.400f, 0.300f, 0.200f, 0.100f},
+	    {0.f, 1.000f, 0.700f, 0.450f, 0.350f, 0.100f, 0.050f, 0.050f, 0.000f},
+	};
+
+	meshopt_optimizeVertexCacheTable(&mesh.indices[0], &mesh.indices[0], mesh.indices.size(), mesh.vertices.size(), &table);
+}
+
 void optCacheFifo(Mesh& mesh)
 {
 	meshopt_optimizeVertexCacheFifo(&mesh.indices[0], &mesh.indices[0], mesh.indices.size(), mesh.vertices.size(), kCacheSize);
@@ -375,6 +393,16 @@ void optComplete(Mesh& mesh)
 	meshopt_optimizeVertexFetch(&mesh.vertices[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0], mesh.vertices.size(), sizeof(Vertex));
 }
 
+void optMesh(Mesh& mesh)
+{
+	// positions are read from the same interleaved stream that is remapped
+	void* streams[] = {&mesh.vertices[0]};
+	size_t stream_sizes[] = {sizeof(Vertex)};
+
+	size_t vertex_count = meshopt_optimizeMesh(&mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), streams, stream_sizes, 1, meshopt_OptimizeMeshOverdraw, 1.05f);
+	mesh.vertices.resize(vertex_count);
+}
+
 struct PackedVertex
 {
 	unsigned short px, py, pz;
@@ -464,6 +492,115 @@ void simplify(const Mesh& mesh, float threshold = 0.2f)
 	    (end - start) * 1000);
 }
 
+void simplifyAttr(const Mesh& mesh, float threshold = 0.2f)
+{
+	Mesh lod;
+
+	double start = timestamp();
+
+	size_t target_index_count = size_t(mesh.indices.size() * threshold);
+	float target_error = 1e-2f;
+	float result_error = 0;
+
+	const float nrm_weight = 0.01f;
+	const float attr_weights[3] = {nrm_weight, nrm_weight, nrm_weight};
+
+	lod.indices.resize(mesh.indices.size()); // note: simplify needs space for index_count elements in the destination array, not target_index_count
+	lod.indices.resize(meshopt_simplifyWithAttributes(&lod.indices[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), &mesh.vertices[0].nx, sizeof(Vertex), attr_weights, 3, target_index_count, target_error, 0, &result_error));
+
+	lod.vertices.resize(lod.indices.size() < mesh.vertices.size() ? lod.indices.size() : mesh.vertices.size()); // note: this is just to reduce the cost of resize()
+	lod.vertices.resize(meshopt_optimizeVertexFetch(&lod.vertices[0], &lod.indices[0], lod.indices.size(), &mesh.vertices[0], mesh.vertices.size(), sizeof(Vertex)));
+
+	double end = timestamp();
+
+	printf("%-9s: %d triangles => %d triangles (%.2f%% deviation) in %.2f msec\n",
+	    "SimplifyA",
+	    int(mesh.indices.size() / 3), int(lod.indices.size() / 3),
+	    result_error * 100,
+	    (end - start) * 1000);
+}
+
+void simplifyOrdered(const Mesh& mesh, float threshold = 0.2f)
+{
+	// compare default and exact order collapse modes at the same triangle count; error limit is relaxed so that both modes reach the target
+	size_t target_index_count = size_t(mesh.indices.size() * threshold);
+	float target_error = 1.f;
+
+	const unsigned int options[2] = {0, meshopt_SimplifyExactOrder};
+	const char* names[2] = {"SimplifyD", "SimplifyO"};
+
+	std::vector<unsigned int> lod(mesh.indices.size());
+
+	for (int mode = 0; mode < 2; ++mode)
+	{
+		double start = timestamp();
+
+		float result_error = 0;
+		size_t lod_index_count = meshopt_simplify(&lod[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), target_index_count, target_error, options[mode], &result_error);
+
+		double end = timestamp();
+
+		printf("%-9s: %d triangles => %d triangles (%.2f%% deviation) in %.2f msec\n",
+		    names[mode],
+		    int(mesh.indices.size() / 3), int(lod_index_count / 3),
+		    result_error * 100,
+		    (end - start) * 1000);
+	}
+}
+
+void simplifyProgressive(const Mesh& mesh, float threshold = 0.2f)
+{
+	double start = timestamp();
+
+	size_t target_index_count = size_t(mesh.indices.size() * threshold);
+	float target_error = 1e-2f;
+
+	std::vector<unsigned int> indices(mesh.indices.size());
+	std::vector<unsigned int> remap(mesh.vertices.size());
+	std::vector<meshopt_VertexSplit> splits(mesh.vertices.size());
+
+	size_t vertex_count = meshopt_simplifyProgressive(&indices[0], &remap[0], &splits[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), target_index_count, target_error);
+
+	std::vector<Vertex> vertices(vertex_count);
+	meshopt_remapVertexBuffer(&vertices[0], &mesh.vertices[0], mesh.vertices.size(), sizeof(Vertex), &remap[0]);
+
+	size_t base_vertex_count = 0;
+	while (base_vertex_count < vertex_count && splits[base_vertex_count].parent == base_vertex_count)
+		base_vertex_count++;
+
+	double middle = timestamp();
+
+	// refine from the base mesh to the full mesh in several steps, similarly to streaming
+	const size_t steps = 16;
+
+	std::vector<unsigned int> lod(indices.size());
+	size_t lod_index_count = meshopt_refineProgressive(&lod[0], &indices[0], &splits[0], 0, base_vertex_count);
+	size_t base_index_count = lod_index_count;
+
+	size_t current = base_vertex_count;
+
+	for (size_t i = 0; i < steps; ++i)
+	{
+		size_t next = base_vertex_count + (vertex_count - base_vertex_count) * (i + 1) / steps;
+
+		// wedges along seams need to be split together to avoid cracks
+		next = splits[next - 1].group_end;
+
+		lod_index_count = meshopt_refineProgressive(&lod[0], &indices[0], &splits[0], current, next);
+		current = next;
+	}
+
+	assert(lod_index_count == splits[vertex_count - 1].triangle_count * 3);
+
+	double end = timestamp();
+
+	printf("%-9s: %d triangles => %d triangles (%.2f%% deviation) in %.2f msec, refined in %.2f msec\n",
+	    "SimplifyM",
+	    int(mesh.indices.size() / 3), int(base_index_count / 3),
+	    splits[base_vertex_count - 1].error * 100,
+	    (middle - start) * 1000, (end - middle) * 1000);
+}
+
 void simplifySloppy(const Mesh& mesh, float threshold = 0.2f)
 {
 	Mesh lod;
@@ -496,7 +633,7 @@ void simplifyPoints(const Mesh& mesh, float threshold = 0.2f)
 	size_t target_vertex_count = size_t(mesh.vertices.size() * threshold);
 
 	std::vector<unsigned int> indices(target_vertex_count);
-	indices.resize(meshopt_simplifyPoints(&indices[0], &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), target_vertex_count));
+	indices.resize(meshopt_simplifyPoints(&indices[0], &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), NULL, 0, 0.f, target_vertex_count));
 
 	double end = timestamp();
 
@@ -505,6 +642,25 @@ void simplifyPoints(const Mesh& mesh, float threshold = 0.2f)
 	    int(mesh.vertices.size()), int(indices.size()), (end - start) * 1000);
 }
 
+void simplifyPointHierarchy(const Mesh& mesh, size_t max_node_points = 256)
+{
+	double start = timestamp();
+
+	std::vector<meshopt_PointNode> nodes(mesh.vertices.size());
+	std::vector<unsigned int> indices(mesh.vertices.size());
+	nodes.resize(meshopt_buildPointHierarchy(&nodes[0], &indices[0], &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), max_node_points, NULL));
+
+	double end = timestamp();
+
+	size_t leaf_count = 0;
+	for (size_t i = 0; i < nodes.size(); ++i)
+		leaf_count += nodes[i].child_count == 0;
+
+	printf("%-9s: %d points => %d nodes (%d leaves, %d root points) in %.2f msec\n",
+	    "SimplifyH",
+	    int(mesh.vertices.size()), int(nodes.size()), int(leaf_count), int(nodes[0].point_count), (end - start) * 1000);
+}
+
 void simplifyComplete(const Mesh& mesh)
 {
 	static const size_t lod_count = 5;
@@ -869,6 +1025,17 @@ void meshlets(const Mesh& mesh, bool scan)
 	    scan ? 'S' : ' ',
 	    int(meshlets.size()), avg_vertices, avg_triangles, int(not_full), (end - start) * 1000);
 
+	meshopt_VertexCacheStatistics mcs = meshopt_analyzeMeshletCache(&meshlets[0], meshlets.size(), &meshlet_triangles[0], 16);
+
+	double starto = timestamp();
+	for (size_t i = 0; i < meshlets.size(); ++i)
+		meshopt_optimizeMeshlet(&meshlet_vertices[meshlets[i].vertex_offset], &meshlet_triangles[meshlets[i].triangle_offset], meshlets[i].triangle_count, meshlets[i].vertex_count);
+	double endo = timestamp();
+
+	meshopt_VertexCacheStatistics mco = meshopt_analyzeMeshletCache(&meshlets[0], meshlets.size(), &meshlet_triangles[0], 16);
+
+	printf("MeshletOp: ACMR %f => %f, ATVR %f => %f in %.2f msec\n", mcs.acmr, mco.acmr, mcs.atvr, mco.atvr, (endo - starto) * 1000);
+
 	float camera[3] = {100, 100, 100};
 
 	size_t rejected = 0;
@@ -910,6 +1077,27 @@ void meshlets(const Mesh& mesh, bool scan)
 	}
 	double endc = timestamp();
 
+	std::vector<meshopt_Bounds> bounds(meshlets.size());
+
+	double startb = timestamp();
+	meshopt_computeMeshletBoundsBatch(&bounds[0], &meshlets[0], meshlets.size(), &meshlet_vertices[0], &meshlet_triangles[0], &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex));
+	double endb = timestamp();
+
+	printf("BoundsBch: %d meshlets in %.2f msec\n", int(meshlets.size()), (endb - startb) * 1000);
+
+	std::vector<meshopt_MeshletBVHNode> bvh(meshlets.size() * 2);
+	std::vector<unsigned int> bvh_meshlets(meshlets.size());
+
+	double starth = timestamp();
+	size_t bvh_size = meshopt_buildMeshletBVH(&bvh[0], &bvh_meshlets[0], &bounds[0], bounds.size(), 4, 4, 0);
+	double endh = timestamp();
+
+	double startsah = timestamp();
+	size_t bvh_size_sah = meshopt_buildMeshletBVH(&bvh[0], &bvh_meshlets[0], &bounds[0], bounds.size(), 4, 4, meshopt_MeshletBVHSAH);
+	double endsah = timestamp();
+
+	printf("BVH      : %d nodes in %.2f msec (median); %d nodes in %.2f msec (SAH)\n", int(bvh_size), (endh - starth) * 1000, int(bvh_size_sah), (endsah - startsah) * 1000);
+
 	double radius_mean = 0;
 
 	for (size_t i = 0; i < meshlets.size(); ++i)
@@ -948,6 +1136,145 @@ void meshlets(const Mesh& mesh, bool scan)
 	    (endc - startc) * 1000);
 }
 
+void meshletsRegions(const Mesh& mesh, size_t region_triangles)
+{
+	const size_t max_vertices = 64;
+	const size_t max_triangles = 124;
+	const float cone_weight = 0.5f;
+
+	double start = timestamp();
+
+	std::vector<unsigned int> indices(mesh.indices.size());
+	std::vector<unsigned int> region_offsets((mesh.indices.size() / 3 + region_triangles - 1) / region_triangles + 1);
+	size_t region_count = meshopt_partitionMeshletRegions(&indices[0], &region_offsets[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), region_triangles);
+
+	double middle = timestamp();
+
+	// each region gets a separate output range, so the loop below can run in parallel
+	std::vector<size_t> region_meshlets(region_count + 1);
+
+	for (size_t i = 0; i < region_count; ++i)
+		region_meshlets[i + 1] = region_meshlets[i] + meshopt_buildMeshletsBound(region_offsets[i + 1] - region_offsets[i], max_vertices, max_triangles);
+
+	std::vector<meshopt_Meshlet> meshlets(region_meshlets[region_count]);
+	std::vector<unsigned int> meshlet_vertices(meshlets.size() * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(meshlets.size() * max_triangles * 3);
+	std::vector<size_t> region_results(region_count);
+
+	for (size_t i = 0; i < region_count; ++i)
+	{
+		size_t base = region_meshlets[i];
+
+		region_results[i] = meshopt_buildMeshlets(&meshlets[base], &meshlet_vertices[base * max_vertices], &meshlet_triangles[base * max_triangles * 3], &indices[region_offsets[i]], region_offsets[i + 1] - region_offsets[i], &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), max_vertices, max_triangles, cone_weight);
+
+		for (size_t j = 0; j < region_results[i]; ++j)
+		{
+			meshlets[base + j].vertex_offset += unsigned(base * max_vertices);
+			meshlets[base + j].triangle_offset += unsigned(base * max_triangles * 3);
+		}
+	}
+
+	double end = timestamp();
+
+	// compact the per-region results and merge undersized meshlets on region boundaries
+	size_t total = 0;
+
+	for (size_t i = 0; i < region_count; ++i)
+		for (size_t j = 0; j < region_results[i]; ++j)
+			meshlets[total++] = meshlets[region_meshlets[i] + j];
+
+	std::vector<meshopt_Meshlet> merged(total);
+	std::vector<unsigned int> merged_vertices(meshlet_vertices.size());
+	std::vector<unsigned char> merged_triangles(meshlet_triangles.size());
+	merged.resize(meshopt_mergeMeshlets(&merged[0], &merged_vertices[0], &merged_triangles[0], &meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], total, mesh.vertices.size(), max_vertices, max_triangles));
+
+	double endm = timestamp();
+
+	double avg_vertices = 0;
+	double avg_triangles = 0;
+	size_t not_full = 0;
+
+	for (size_t i = 0; i < merged.size(); ++i)
+	{
+		const meshopt_Meshlet& m = merged[i];
+
+		avg_vertices += m.vertex_count;
+		avg_triangles += m.triangle_count;
+		not_full += m.vertex_count < max_vertices;
+	}
+
+	avg_vertices /= double(merged.size());
+	avg_triangles /= double(merged.size());
+
+	printf("MeshletsR: %d meshlets (avg vertices %.1f, avg triangles %.1f, not full %d) from %d regions, %d before merge in %.2f msec (partition %.2f, build %.2f, merge %.2f)\n",
+	    int(merged.size()), avg_vertices, avg_triangles, int(not_full), int(region_count), int(total),
+	    (endm - start) * 1000, (middle - start) * 1000, (end - middle) * 1000, (endm - end) * 1000);
+}
+
+static double meshletBoxArea(const Mesh& mesh, const std::vector<meshopt_Meshlet>& meshlets, const std::vector<unsigned int>& meshlet_vertices)
+{
+	double result = 0;
+
+	for (size_t i = 0; i < meshlets.size(); ++i)
+	{
+		const meshopt_Meshlet& m = meshlets[i];
+
+		float minv[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		float maxv[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+		for (size_t j = 0; j < m.vertex_count; ++j)
+		{
+			const Vertex& v = mesh.vertices[meshlet_vertices[m.vertex_offset + j]];
+			const float p[3] = {v.px, v.py, v.pz};
+
+			for (int k = 0; k < 3; ++k)
+			{
+				minv[k] = p[k] < minv[k] ? p[k] : minv[k];
+				maxv[k] = p[k] > maxv[k] ? p[k] : maxv[k];
+			}
+		}
+
+		float sx = maxv[0] - minv[0], sy = maxv[1] - minv[1], sz = maxv[2] - minv[2];
+		result += 2 * (sx * sy + sy * sz + sz * sx);
+	}
+
+	return result;
+}
+
+void meshletsSpatial(const Mesh& mesh)
+{
+	const size_t max_vertices = 64;
+	const size_t max_triangles = 124;
+
+	size_t max_meshlets = meshopt_buildMeshletsBound(mesh.indices.size(), max_vertices, max_triangles);
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+
+	// baseline: regular meshlets without cone culling, as they would be used for ray tracing today
+	meshlets.resize(meshopt_buildMeshlets(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), max_vertices, max_triangles, 0.f));
+
+	double base_area = meshletBoxArea(mesh, meshlets, meshlet_vertices);
+
+	meshlets.resize(max_meshlets);
+
+	double start = timestamp();
+	meshlets.resize(meshopt_buildMeshletsSpatial(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), max_vertices, max_triangles));
+	double end = timestamp();
+
+	double avg_triangles = 0;
+
+	for (size_t i = 0; i < meshlets.size(); ++i)
+		avg_triangles += meshlets[i].triangle_count;
+
+	avg_triangles /= double(meshlets.size());
+
+	double area = meshletBoxArea(mesh, meshlets, meshlet_vertices);
+
+	printf("MeshletRT: %d meshlets (avg triangles %.1f, box area %.1f%% of regular meshlets) in %.2f msec\n",
+	    int(meshlets.size()), avg_triangles, area / base_area * 100, (end - start) * 1000);
+}
+
 void spatialSort(const Mesh& mesh)
 {
 	typedef PackedVertexOct PV;
@@ -1158,12 +1485,15 @@ void process(const char* path)
 	optimize(mesh, "Original", optNone);
 	optimize(mesh, "Random", optRandomShuffle);
 	optimize(mesh, "Cache", optCache);
+	optimize(mesh, "CacheChnk", optCacheChunked);
+	optimize(mesh, "CacheTbl", optCacheTable);
 	optimize(mesh, "CacheFifo", optCacheFifo);
 	optimize(mesh, "CacheStrp", optCacheStrip);
 	optimize(mesh, "Overdraw", optOverdraw);
 	optimize(mesh, "Fetch", optFetch);
 	optimize(mesh, "FetchMap", optFetchRemap);
 	optimize(mesh, "Complete", optComplete);
+	optimize(mesh, "OptMesh", optMesh);
 
 	Mesh copy = mesh;
 	meshopt_optimizeVertexCache(&copy.indices[0], &copy.indices[0], copy.indices.size(), copy.vertices.size());
@@ -1179,6 +1509,8 @@ void process(const char* path)
 
 	meshlets(copy, false);
 	meshlets(copy, true);
+	meshletsRegions(copy, 1024);
+	meshletsSpatial(copy);
 
 	shadow(copy);
 	tessellationAdjacency(copy);
@@ -1196,9 +1528,13 @@ void process(const char* path)
 	encodeVertex<PackedVertexOct>(copy, "O");
 
 	simplify(mesh);
+	simplifyAttr(mesh);
+	simplifyOrdered(mesh);
+	simplifyProgressive(mesh);
 	simplifySloppy(mesh);
 	simplifyComplete(mesh);
 	simplifyPoints(mesh);
+	simplifyPointHierarchy(mesh);
 
 	spatialSort(mesh);
 	spatialSortTriangles(mesh);
@@ -1214,6 +1550,12 @@ void processDev(const char* path)
 		return;
 
 	tessellationAdjacency(mesh);
+
+	// large meshes (100K-50M triangles) are best benchmarked here since the full pipeline above takes a while on them
+	Mesh copy = mesh;
+	meshopt_optimizeVertexCache(&copy.indices[0], &copy.indices[0], copy.indices.size(), copy.vertices.size());
+
+	meshlets(copy, false);
 }
 
 int main(int argc, char** argv)
@@ -1,6 +1,7 @@
 #include "../src/meshoptimizer.h"
 
 #include <assert.h>
+#include <float.h>
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -840,249 +841,2251 @@ static void customAllocator()
 	allocCount = freeCount = 0;
 }
 
+static void contextScratch()
+{
+	meshopt_setAllocator(customAlloc, customFree);
+
+	float vb[] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+	unsigned int ib[] = {0, 1, 2};
+
+	meshopt_Context context = {};
+
+	// first call doesn't fit into (empty) scratch memory, so it allocates from the heap and records the required size
+	meshopt_optimizeVertexFetchWithContext(&context, vb, ib, 3, vb, 3, 12);
+	assert(allocCount == 2 && freeCount == 2);
+	assert(context.scratch == NULL && context.scratch_size > 0);
+
+	// next call allocates scratch memory once and reuses it afterwards
+	meshopt_optimizeVertexFetchWithContext(&context, vb, ib, 3, vb, 3, 12);
+	assert(allocCount == 3 && freeCount == 2);
+	assert(context.scratch != NULL);
+
+	meshopt_optimizeVertexFetchWithContext(&context, vb, ib, 3, vb, 3, 12);
+	assert(allocCount == 3 && freeCount == 2);
+
+	meshopt_freeContext(&context);
+	assert(allocCount == 3 && freeCount == 3);
+	assert(context.scratch == NULL && context.scratch_size == 0);
+
+	meshopt_setAllocator(operator new, operator delete);
+
+	allocCount = freeCount = 0;
+
+	// results match calls without context, even when scratch memory is reused for meshes of different sizes
+	float gvb[8 * 8][3];
+
+	for (int y = 0; y < 8; ++y)
+		for (int x = 0; x < 8; ++x)
+		{
+			gvb[y * 8 + x][0] = float(x);
+			gvb[y * 8 + x][1] = float(y);
+			gvb[y * 8 + x][2] = float((x * y) % 3) * 0.1f;
+		}
+
+	unsigned int gib[7 * 7][6];
+
+	for (int y = 0; y < 7; ++y)
+		for (int x = 0; x < 7; ++x)
+		{
+			gib[y * 7 + x][0] = (y + 0) * 8 + (x + 0);
+			gib[y * 7 + x][1] = (y + 0) * 8 + (x + 1);
+			gib[y * 7 + x][2] = (y + 1) * 8 + (x + 0);
+			gib[y * 7 + x][3] = (y + 1) * 8 + (x + 0);
+			gib[y * 7 + x][4] = (y + 0) * 8 + (x + 1);
+			gib[y * 7 + x][5] = (y + 1) * 8 + (x + 1);
+		}
+
+	unsigned int expected[7 * 7 * 6], actual[7 * 7 * 6];
+
+	for (int pass = 0; pass < 3; ++pass)
+	{
+		size_t index_count = (pass == 1 ? 3 * 7 : 7 * 7) * 6;
+
+		size_t expected_count = meshopt_simplify(expected, gib[0], index_count, gvb[0], 8 * 8, 12, index_count / 4, 1e-1f);
+		size_t actual_count = meshopt_simplifyWithContext(&context, actual, gib[0], index_count, gvb[0], 8 * 8, 12, NULL, 0, NULL, 0, index_count / 4, 1e-1f);
+
+		assert(actual_count == expected_count);
+		assert(memcmp(actual, expected, expected_count * sizeof(unsigned int)) == 0);
+	}
+
+	meshopt_freeContext(&context);
+}
+
+struct NestedCall
+{
+	meshopt_Context* context;
+	const unsigned int* indices;
+	size_t index_count;
+	size_t vertex_count;
+	unsigned int* result;
+	int calls;
+};
+
+static int nestedProgress(void* userdata, float fraction, size_t count, float error)
+{
+	(void)fraction;
+	(void)count;
+	(void)error;
+
+	NestedCall* call = static_cast<NestedCall*>(userdata);
+	call->calls++;
+
+	// nested call with the same context while the outer call holds scratch memory
+	meshopt_optimizeVertexCacheWithContext(call->context, call->result, call->indices, call->index_count, call->vertex_count);
+
+	return 1;
+}
+
+static void contextNested()
+{
+	float vb[8 * 8][3];
+
+	for (int y = 0; y < 8; ++y)
+		for (int x = 0; x < 8; ++x)
+		{
+			vb[y * 8 + x][0] = float(x);
+			vb[y * 8 + x][1] = float(y);
+			vb[y * 8 + x][2] = float((x * y) % 3) * 0.1f;
+		}
+
+	unsigned int ib[7 * 7][6];
+
+	for (int y = 0; y < 7; ++y)
+		for (int x = 0; x < 7; ++x)
+		{
+			ib[y * 7 + x][0] = (y + 0) * 8 + (x + 0);
+			ib[y * 7 + x][1] = (y + 0) * 8 + (x + 1);
+			ib[y * 7 + x][2] = (y + 1) * 8 + (x + 0);
+			ib[y * 7 + x][3] = (y + 1) * 8 + (x + 0);
+			ib[y * 7 + x][4] = (y + 0) * 8 + (x + 1);
+			ib[y * 7 + x][5] = (y + 1) * 8 + (x + 1);
+		}
+
+	const size_t index_count = 7 * 7 * 6;
+	const size_t vertex_count = 8 * 8;
+
+	unsigned int expected[index_count], expected_cache[index_count];
+	size_t expected_count = meshopt_simplify(expected, ib[0], index_count, vb[0], vertex_count, 12, index_count / 4, 1e-1f);
+	meshopt_optimizeVertexCache(expected_cache, ib[0], index_count, vertex_count);
+
+	unsigned int actual[index_count], actual_cache[index_count];
+
+	meshopt_Context context = {};
+	NestedCall call = {&context, ib[0], index_count, vertex_count, actual_cache, 0};
+
+	context.progress = nestedProgress;
+	context.userdata = &call;
+
+	// first call allocates from the heap, later calls use scratch memory for both outer and nested calls
+	for (int pass = 0; pass < 3; ++pass)
+	{
+		call.calls = 0;
+
+		size_t actual_count = meshopt_simplifyWithContext(&context, actual, ib[0], index_count, vb[0], vertex_count, 12, NULL, 0, NULL, 0, index_count / 4, 1e-1f);
+
+		assert(call.calls > 0);
+		assert(actual_count == expected_count);
+		assert(memcmp(actual, expected, expected_count * sizeof(unsigned int)) == 0);
+		assert(memcmp(actual_cache, expected_cache, sizeof(expected_cache)) == 0);
+		assert(context.scratch_used == 0);
+	}
+
+	// scratch memory accounts for nested calls, which are placed after the memory of the outer call
+	assert(context.scratch && context.scratch_size > meshopt_simplifyScratchSize(index_count, vertex_count, 0, 0));
+
+	meshopt_freeContext(&context);
+}
+
+struct AllocStats
+{
+	size_t allocs;
+	size_t frees;
+	size_t bytes;
+};
+
+static void* contextAlloc(void* userdata, size_t size)
+{
+	AllocStats* stats = static_cast<AllocStats*>(userdata);
+	stats->allocs++;
+	stats->bytes += size;
+
+	return malloc(size);
+}
+
+static void contextFree(void* userdata, void* ptr)
+{
+	AllocStats* stats = static_cast<AllocStats*>(userdata);
+	stats->frees++;
+
+	free(ptr);
+}
+
+static void contextAllocator()
+{
+	// global allocator should not be used when context callbacks are set
+	meshopt_setAllocator(customAlloc, customFree);
+
+	float vb[] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+	unsigned int ib[] = {0, 1, 2};
+	unsigned short ibs[] = {0, 1, 2};
+
+	AllocStats stats1 = {}, stats2 = {};
+
+	meshopt_Context context1 = {};
+	context1.allocate = contextAlloc;
+	context1.deallocate = contextFree;
+	context1.userdata = &stats1;
+
+	meshopt_Context context2 = context1;
+	context2.userdata = &stats2;
+
+	meshopt_optimizeVertexFetchWithContext(&context1, vb, ib, 3, vb, 3, 12);
+	assert(stats1.allocs == 2 && stats1.frees == 2);
+
+	// IndexAdapter allocations are routed through the context as well; scratch memory is allocated once and outlives the call
+	meshopt_optimizeVertexFetchWithContext(&context2, vb, ibs, 3, vb, 3, 12);
+	assert(stats2.allocs == 3 && stats2.frees == 3);
+
+	meshopt_optimizeVertexFetchWithContext(&context2, vb, ibs, 3, vb, 3, 12);
+	assert(stats2.allocs == 5 && stats2.frees == 4);
+
+	meshopt_freeContext(&context1);
+	meshopt_freeContext(&context2);
+	assert(stats1.allocs == stats1.frees && stats2.allocs == stats2.frees);
+
+	assert(allocCount == 0 && freeCount == 0);
+
+	meshopt_setAllocator(operator new, operator delete);
+}
+
+static void contextStats()
+{
+	float vb[8 * 8][6];
+
+	for (int y = 0; y < 8; ++y)
+		for (int x = 0; x < 8; ++x)
+		{
+			float* v = vb[y * 8 + x];
+			v[0] = float(x), v[1] = float(y), v[2] = float((x * y) % 3) * 0.1f;
+			v[3] = 0.f, v[4] = 0.f, v[5] = 1.f;
+		}
+
+	unsigned int ib[7 * 7][6];
+
+	for (int y = 0; y < 7; ++y)
+		for (int x = 0; x < 7; ++x)
+		{
+			ib[y * 7 + x][0] = (y + 0) * 8 + (x + 0);
+			ib[y * 7 + x][1] = (y + 0) * 8 + (x + 1);
+			ib[y * 7 + x][2] = (y + 1) * 8 + (x + 0);
+			ib[y * 7 + x][3] = (y + 1) * 8 + (x + 0);
+			ib[y * 7 + x][4] = (y + 0) * 8 + (x + 1);
+			ib[y * 7 + x][5] = (y + 1) * 8 + (x + 1);
+		}
+
+	const size_t index_count = 7 * 7 * 6;
+	const size_t vertex_count = 8 * 8;
+
+	meshopt_Stats stats = {};
+	meshopt_Context context = {};
+	context.stats = &stats;
+
+	unsigned int lod[index_count];
+	const float attr_weights[3] = {1, 1, 1};
+
+	// first call allocates all memory from the heap; peak memory matches the scratch size query
+	meshopt_simplifyWithContext(&context, lod, ib[0], index_count, vb[0], vertex_count, sizeof(vb[0]), NULL, 0, NULL, 0, index_count / 4, 1e-1f);
+	assert(stats.peak_bytes == meshopt_simplifyScratchSize(index_count, vertex_count, 0, 0));
+	assert(stats.allocation_count > 0);
+	assert(stats.stage_count == 3);
+	assert(strcmp(stats.stage_names[0], "classify") == 0 && stats.stage_times[0] >= 0);
+
+	// second call allocates scratch memory once, third call doesn't allocate
+	meshopt_simplifyWithContext(&context, lod, ib[0], index_count, vb[0], vertex_count, sizeof(vb[0]), NULL, 0, NULL, 0, index_count / 4, 1e-1f);
+	assert(stats.allocation_count == 1);
+
+	meshopt_simplifyWithContext(&context, lod, ib[0], index_count, vb[0], vertex_count, sizeof(vb[0]), NULL, 0, NULL, 0, index_count / 4, 1e-1f);
+	assert(stats.allocation_count == 0);
+
+	meshopt_simplifyWithContext(&context, lod, ib[0], index_count, vb[0], vertex_count, sizeof(vb[0]), &vb[0][3], sizeof(vb[0]), attr_weights, 3, index_count / 4, 1e-1f);
+	assert(stats.peak_bytes == meshopt_simplifyScratchSize(index_count, vertex_count, 3, 0));
+
+	meshopt_Meshlet meshlets[32];
+	unsigned int meshlet_vertices[32 * 64];
+	unsigned char meshlet_triangles[32 * 64 * 3];
+
+	meshopt_buildMeshletsWithContext(&context, meshlets, meshlet_vertices, meshlet_triangles, ib[0], index_count, vb[0], vertex_count, sizeof(vb[0]), 64, 64, 0.f);
+	assert(stats.peak_bytes == meshopt_buildMeshletsScratchSize(index_count, vertex_count));
+	assert(stats.allocation_count == 1); // scratch memory is regrown after the simplification call with attributes
+
+	// sloppy simplification memory depends on the result; a context presized with the upper bound only allocates the scratch block
+	meshopt_Context sloppy_context = {};
+	sloppy_context.stats = &stats;
+	sloppy_context.scratch_size = meshopt_simplifySloppyScratchSize(index_count, vertex_count);
+
+	meshopt_simplifySloppyWithContext(&sloppy_context, lod, ib[0], index_count, vb[0], vertex_count, sizeof(vb[0]), index_count / 4, 1e-1f, NULL);
+	assert(stats.peak_bytes > 0 && stats.peak_bytes <= meshopt_simplifySloppyScratchSize(index_count, vertex_count));
+	assert(stats.allocation_count == 1);
+	assert(sloppy_context.scratch_size == meshopt_simplifySloppyScratchSize(index_count, vertex_count));
+
+	meshopt_freeContext(&sloppy_context);
+
+	unsigned int remap[vertex_count];
+
+	meshopt_generateVertexRemapWithContext(&context, remap, ib[0], index_count, vb, vertex_count, sizeof(vb[0]));
+	assert(stats.peak_bytes == meshopt_generateVertexRemapScratchSize(vertex_count));
+	assert(stats.allocation_count == 0);
+
+	meshopt_freeContext(&context);
+
+	// composite calls report statistics of all nested steps, which reuse the same scratch memory one after another
+	meshopt_Context mesh_context = {};
+	mesh_context.stats = &stats;
+
+	unsigned int mib[index_count];
+	float mvb[vertex_count][6];
+	void* streams[1] = {mvb};
+	size_t stream_sizes[1] = {sizeof(mvb[0])};
+
+	memcpy(mib, ib, sizeof(ib));
+	memcpy(mvb, vb, sizeof(vb));
+
+	meshopt_optimizeMeshWithContext(&mesh_context, mib, index_count, &mvb[0][0], vertex_count, sizeof(mvb[0]), streams, stream_sizes, 1, meshopt_OptimizeMeshOverdraw, 1.05f);
+	assert(stats.allocation_count > 1);
+	assert(stats.peak_bytes == mesh_context.scratch_size);
+	assert(mesh_context.scratch_used == 0 && mesh_context.call_depth == 0);
+
+	// the second call only allocates the scratch block, which all nested steps share
+	memcpy(mib, ib, sizeof(ib));
+	memcpy(mvb, vb, sizeof(vb));
+
+	size_t scratch_size = mesh_context.scratch_size;
+
+	meshopt_optimizeMeshWithContext(&mesh_context, mib, index_count, &mvb[0][0], vertex_count, sizeof(mvb[0]), streams, stream_sizes, 1, meshopt_OptimizeMeshOverdraw, 1.05f);
+	assert(stats.allocation_count == 1);
+	assert(stats.peak_bytes == scratch_size && mesh_context.scratch_size == scratch_size);
+
+	meshopt_freeContext(&mesh_context);
+}
+
+struct TraceState
+{
+	int depth;
+	int max_depth;
+	int zones;
+	const char* stack[8];
+	double passes;
+	bool seen_collapse;
+};
+
+static void traceBegin(void* userdata, const char* name)
+{
+	TraceState* state = static_cast<TraceState*>(userdata);
+	assert(state->depth < 8);
+
+	state->stack[state->depth++] = name;
+	state->max_depth = state->depth > state->max_depth ? state->depth : state->max_depth;
+	state->zones++;
+
+	state->seen_collapse |= strcmp(name, "collapse") == 0;
+}
+
+static void traceEnd(void* userdata, const char* name)
+{
+	TraceState* state = static_cast<TraceState*>(userdata);
+	assert(state->depth > 0);
+
+	// zones are properly nested
+	assert(state->stack[--state->depth] == name);
+}
+
+static void traceCounter(void* userdata, const char* name, double value)
+{
+	TraceState* state = static_cast<TraceState*>(userdata);
+
+	if (strcmp(name, "simplify.passes") == 0)
+		state->passes = value;
+}
+
+static void tracer()
+{
+	float vb[8 * 8][3];
+
+	for (int y = 0; y < 8; ++y)
+		for (int x = 0; x < 8; ++x)
+		{
+			vb[y * 8 + x][0] = float(x);
+			vb[y * 8 + x][1] = float(y);
+			vb[y * 8 + x][2] = float((x * y) % 3) * 0.1f;
+		}
+
+	unsigned int ib[7 * 7][6];
+
+	for (int y = 0; y < 7; ++y)
+		for (int x = 0; x < 7; ++x)
+		{
+			ib[y * 7 + x][0] = (y + 0) * 8 + (x + 0);
+			ib[y * 7 + x][1] = (y + 0) * 8 + (x + 1);
+			ib[y * 7 + x][2] = (y + 1) * 8 + (x + 0);
+			ib[y * 7 + x][3] = (y + 1) * 8 + (x + 0);
+			ib[y * 7 + x][4] = (y + 0) * 8 + (x + 1);
+			ib[y * 7 + x][5] = (y + 1) * 8 + (x + 1);
+		}
+
+	TraceState state = {};
+	meshopt_setTracer(traceBegin, traceEnd, traceCounter, &state);
+
+	unsigned int lod[7 * 7 * 6];
+	meshopt_simplify(lod, ib[0], 7 * 7 * 6, vb[0], 8 * 8, 12, 7 * 7 * 6 / 4, 1e-1f);
+
+	// simplification zone contains stage zones
+	assert(state.depth == 0);
+	assert(state.max_depth == 2);
+	assert(state.seen_collapse);
+	assert(state.passes > 0);
+
+	unsigned char buf[1024];
+	size_t size = meshopt_encodeIndexBuffer(buf, sizeof(buf), ib[0], 7 * 7 * 6);
+	assert(size > 0);
+
+	int zones = state.zones;
+	assert(meshopt_decodeIndexBuffer(lod, 7 * 7 * 6, 4, buf, size) == 0);
+	assert(state.zones == zones + 1 && state.depth == 0);
+
+	meshopt_setTracer(NULL, NULL, NULL, NULL);
+
+	// callbacks should not get called anymore
+	meshopt_decodeIndexBuffer(lod, 7 * 7 * 6, 4, buf, size);
+	assert(state.zones == zones + 1);
+}
+
+static void optimizeVertexCacheTable()
+{
+	// 4x4 grid
+	unsigned int ib[3 * 3 * 6];
+
+	for (unsigned int y = 0; y < 3; ++y)
+		for (unsigned int x = 0; x < 3; ++x)
+		{
+			unsigned int quad[6] = {y * 4 + x, y * 4 + x + 1, y * 4 + x + 4, y * 4 + x + 4, y * 4 + x + 1, y * 4 + x + 5};
+			memcpy(&ib[(y * 3 + x) * 6], quad, sizeof(quad));
+		}
+
+	// built-in table for meshopt_optimizeVertexCache
+	const meshopt_VertexScoreTable table = {
+	    {0.f, 0.779f, 0.791f, 0.789f, 0.981f, 0.843f, 0.726f, 0.847f, 0.882f, 0.867f, 0.799f, 0.642f, 0.613f, 0.600f, 0.568f, 0.372f, 0.234f},
+	    {0.f, 0.995f, 0.713f, 0.450f, 0.404f, 0.059f, 0.005f, 0.147f, 0.006f},
+	};
+
+	unsigned int expected[3 * 3 * 6];
+	meshopt_optimizeVertexCache(expected, ib, 3 * 3 * 6, 16);
+
+	unsigned int result[3 * 3 * 6];
+	meshopt_optimizeVertexCacheTable(result, ib, 3 * 3 * 6, 16, &table);
+
+	assert(memcmp(result, expected, sizeof(expected)) == 0);
+
+	// a table that only scores cache positions still needs to emit every triangle once
+	const meshopt_VertexScoreTable cacheonly = {
+	    {0.f, 1.f, 1.f, 1.f, 0.9f, 0.8f, 0.7f, 0.6f, 0.5f, 0.4f, 0.3f, 0.2f, 0.1f, 0.f, 0.f, 0.f, 0.f},
+	    {},
+	};
+
+	meshopt_optimizeVertexCacheTable(result, ib, 3 * 3 * 6, 16, &cacheonly);
+
+	// each triangle is uniquely identified by its first two vertices in this grid
+	unsigned char seen[16 * 16] = {};
+
+	for (size_t i = 0; i < 3 * 3 * 6; i += 3)
+		seen[ib[i] * 16 + ib[i + 1]] = 1;
+
+	for (size_t i = 0; i < 3 * 3 * 6; i += 3)
+	{
+		assert(seen[result[i] * 16 + result[i + 1]] == 1);
+		seen[result[i] * 16 + result[i + 1]] = 2;
+	}
+}
+
+static void optimizeVertexCacheChunked()
+{
+	float vb[32 * 32][3];
+
+	for (int y = 0; y < 32; ++y)
+		for (int x = 0; x < 32; ++x)
+		{
+			vb[y * 32 + x][0] = float(x);
+			vb[y * 32 + x][1] = float(y);
+			vb[y * 32 + x][2] = 0.f;
+		}
+
+	std::vector<unsigned int> ib;
+
+	for (int y = 0; y < 31; ++y)
+		for (int x = 0; x < 31; ++x)
+		{
+			unsigned int a = y * 32 + x, b = a + 1, c = a + 32, d = a + 33;
+			unsigned int quad[6] = {a, b, c, c, b, d};
+			ib.insert(ib.end(), quad, quad + 6);
+		}
+
+	std::vector<unsigned int> full(ib.size());
+	meshopt_optimizeVertexCache(&full[0], &ib[0], ib.size(), 32 * 32);
+
+	// a single chunk doesn't have any seams
+	std::vector<unsigned int> single(ib.size());
+	assert(meshopt_optimizeVertexCacheChunked(&single[0], &ib[0], ib.size(), vb[0], 32 * 32, sizeof(float) * 3, ib.size() / 3) == 0);
+
+	// in-place optimization with small chunks duplicates vertices on chunk boundaries
+	std::vector<unsigned int> chunked(ib);
+	size_t duplicates = meshopt_optimizeVertexCacheChunked(&chunked[0], &chunked[0], ib.size(), vb[0], 32 * 32, sizeof(float) * 3, 256);
+	assert(duplicates > 0 && duplicates < 32 * 32);
+
+	// each triangle must be emitted exactly once with its original winding; each triangle is uniquely identified by its first two vertices in this grid
+	std::vector<unsigned char> expected(32 * 32 * 32 * 32);
+
+	for (size_t i = 0; i < ib.size(); i += 3)
+		expected[ib[i + 0] * 32 * 32 + ib[i + 1]] = 1;
+
+	for (size_t i = 0; i < chunked.size(); i += 3)
+	{
+		unsigned int key = chunked[i + 0] * 32 * 32 + chunked[i + 1];
+
+		assert(expected[key] == 1);
+		expected[key] = 2;
+	}
+
+	// the penalty at chunk boundaries is bounded by the number of duplicated vertices
+	meshopt_VertexCacheStatistics fs = meshopt_analyzeVertexCache(&full[0], full.size(), 32 * 32, 16, 0, 0);
+	meshopt_VertexCacheStatistics cs = meshopt_analyzeVertexCache(&chunked[0], chunked.size(), 32 * 32, 16, 0, 0);
+
+	assert(cs.vertices_transformed <= fs.vertices_transformed + duplicates * 2);
+
+	// all chunks share one scratch block, so the number of allocations doesn't depend on the number of chunks
+	meshopt_setAllocator(customAlloc, customFree);
+
+	meshopt_optimizeVertexCacheChunked(&chunked[0], &ib[0], ib.size(), vb[0], 32 * 32, sizeof(float) * 3, 256);
+	size_t chunk_allocs = allocCount;
+
+	meshopt_optimizeVertexCacheChunked(&chunked[0], &ib[0], ib.size(), vb[0], 32 * 32, sizeof(float) * 3, 32);
+	assert(allocCount == chunk_allocs * 2);
+	assert(freeCount == allocCount);
+
+	meshopt_setAllocator(operator new, operator delete);
+
+	allocCount = freeCount = 0;
+}
+
+static void optimizeMesh()
+{
+	const size_t vertex_count = 10 * 10 + 1;
+
+	// 10x10 grid of positions with an unused vertex at the end, and a separate stream with 2 attributes per vertex
+	float vb[vertex_count][3];
+	unsigned short ab[vertex_count][2];
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		vb[i][0] = float(i % 10);
+		vb[i][1] = float(i / 10);
+		vb[i][2] = float((i * 7) % 3);
+
+		ab[i][0] = (unsigned short)(i);
+		ab[i][1] = (unsigned short)(i * 3);
+	}
+
+	std::vector<unsigned int> ib;
+
+	for (unsigned int y = 0; y < 9; ++y)
+		for (unsigned int x = 0; x < 9; ++x)
+		{
+			unsigned int a = y * 10 + x, b = a + 1, c = a + 10, d = a + 11;
+			unsigned int quad[6] = {a, b, c, c, b, d};
+			ib.insert(ib.end(), quad, quad + 6);
+		}
+
+	// reference pipeline
+	std::vector<unsigned int> expected(ib.size());
+	meshopt_optimizeVertexCache(&expected[0], &ib[0], ib.size(), vertex_count);
+	meshopt_optimizeOverdraw(&expected[0], &expected[0], ib.size(), vb[0], vertex_count, sizeof(float) * 3, 1.01f);
+
+	unsigned int remap[vertex_count];
+	size_t expected_vertices = meshopt_optimizeVertexFetchRemap(remap, &expected[0], expected.size(), vertex_count);
+	meshopt_remapIndexBuffer(&expected[0], &expected[0], expected.size(), remap);
+
+	float expected_vb[vertex_count][3];
+	unsigned short expected_ab[vertex_count][2];
+	meshopt_remapVertexBuffer(expected_vb, vb, vertex_count, sizeof(vb[0]), remap);
+	meshopt_remapVertexBuffer(expected_ab, ab, vertex_count, sizeof(ab[0]), remap);
+
+	// strip path runs on a copy of the input with a context that is reused across calls
+	std::vector<unsigned int> strip_expected(ib.size());
+	meshopt_optimizeVertexCacheStrip(&strip_expected[0], &ib[0], ib.size(), vertex_count);
+	meshopt_optimizeVertexFetchRemap(remap, &strip_expected[0], strip_expected.size(), vertex_count);
+	meshopt_remapIndexBuffer(&strip_expected[0], &strip_expected[0], strip_expected.size(), remap);
+
+	std::vector<unsigned int> strip = ib;
+	unsigned short sab[vertex_count][2];
+	memcpy(sab, ab, sizeof(ab));
+
+	void* strip_streams[] = {sab};
+	size_t strip_stream_sizes[] = {sizeof(sab[0])};
+
+	meshopt_Context context = {};
+
+	size_t strip_vertices = meshopt_optimizeMeshWithContext(&context, &strip[0], strip.size(), NULL, vertex_count, 0, strip_streams, strip_stream_sizes, 1, meshopt_OptimizeMeshStrip, 0.f);
+
+	assert(strip_vertices == vertex_count - 1);
+	assert(strip == strip_expected);
+
+	// all steps are nested in one call, so the first call only records the scratch size that the next call allocates
+	assert(!context.scratch && context.scratch_size);
+
+	// positions are read from the first stream, which is remapped in place
+	void* streams[] = {vb, ab};
+	size_t stream_sizes[] = {sizeof(vb[0]), sizeof(ab[0])};
+
+	size_t vertices = meshopt_optimizeMeshWithContext(&context, &ib[0], ib.size(), vb[0], vertex_count, sizeof(float) * 3, streams, stream_sizes, 2, meshopt_OptimizeMeshOverdraw, 1.01f);
+
+	assert(vertices == vertex_count - 1);
+	assert(vertices == expected_vertices);
+	assert(ib == expected);
+	assert(memcmp(vb, expected_vb, vertices * sizeof(vb[0])) == 0);
+	assert(memcmp(ab, expected_ab, vertices * sizeof(ab[0])) == 0);
+
+	meshopt_freeContext(&context);
+}
+
+static void analyzeVertexCacheMulti()
+{
+	// 16x16 grid with triangles in a scrambled order and a degenerate triangle at the end
+	std::vector<unsigned int> ib;
+
+	for (unsigned int i = 0; i < 15 * 15; ++i)
+	{
+		unsigned int q = (i * 37) % (15 * 15);
+		unsigned int a = (q / 15) * 16 + q % 15, b = a + 1, c = a + 16, d = a + 17;
+		unsigned int quad[6] = {a, b, c, c, b, d};
+		ib.insert(ib.end(), quad, quad + 6);
+	}
+
+	unsigned int degenerate[3] = {5, 5, 5};
+	ib.insert(ib.end(), degenerate, degenerate + 3);
+
+	const unsigned int cache_sizes[] = {16, 32, 128, 14, 3};
+	const unsigned int warp_sizes[] = {0, 32, 64, 64, 3};
+	const unsigned int primgroup_sizes[] = {0, 0, 128, 128, 1};
+	const size_t config_count = sizeof(cache_sizes) / sizeof(cache_sizes[0]);
+
+	meshopt_VertexCacheStatistics results[config_count];
+	meshopt_analyzeVertexCacheMulti(results, &ib[0], ib.size(), 16 * 16 + 1, cache_sizes, warp_sizes, primgroup_sizes, config_count);
+
+	for (size_t k = 0; k < config_count; ++k)
+	{
+		meshopt_VertexCacheStatistics expected = meshopt_analyzeVertexCache(&ib[0], ib.size(), 16 * 16 + 1, cache_sizes[k], warp_sizes[k], primgroup_sizes[k]);
+
+		assert(results[k].vertices_transformed == expected.vertices_transformed);
+		assert(results[k].warps_executed == expected.warps_executed);
+		assert(results[k].acmr == expected.acmr);
+		assert(results[k].atvr == expected.atvr);
+	}
+
+	// one triangle per primitive group resets the cache for every triangle, so only the degenerate triangle reuses vertices
+	assert(results[config_count - 1].vertices_transformed == ib.size() - 2);
+}
+
+static void analyzeOverdrawMulti()
+{
+	// two overlapping unit quads in XY plane at different depths
+	float vb[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1};
+	unsigned int ib[] = {0, 1, 2, 2, 1, 3, 4, 5, 6, 6, 5, 7};
+
+	const float views[] = {0, 0, 1, 0, 0, -2, 1, 0, 0};
+	meshopt_OverdrawStatistics results[3];
+
+	meshopt_analyzeOverdrawMulti(results, ib, 12, vb, 8, 12, views, 3, 32);
+
+	// both quads cover the entire viewport when viewed along Z, and are rasterized as edge-on triangles when viewed along X
+	assert(results[0].pixels_covered == 32 * 32);
+	assert(results[0].pixels_shaded >= 32 * 32 && results[0].pixels_shaded <= 2 * 32 * 32);
+	assert(results[1].pixels_covered == 32 * 32);
+	assert(results[2].pixels_covered == 0);
+	assert(results[2].overdraw == 0.f);
+
+	// summing statistics for axis views at 256x256 matches the default analyzer
+	const float axes[] = {-1, 0, 0, 0, -1, 0, 0, 0, -1};
+	meshopt_OverdrawStatistics axis_results[3];
+
+	meshopt_analyzeOverdrawMulti(axis_results, ib, 12, vb, 8, 12, axes, 3, 256);
+
+	meshopt_OverdrawStatistics expected = meshopt_analyzeOverdraw(ib, 12, vb, 8, 12);
+
+	assert(axis_results[0].pixels_covered + axis_results[1].pixels_covered + axis_results[2].pixels_covered == expected.pixels_covered);
+	assert(axis_results[0].pixels_shaded + axis_results[1].pixels_shaded + axis_results[2].pixels_shaded == expected.pixels_shaded);
+
+	// large triangles need more than 32 bits of precision for edge equations
+	meshopt_OverdrawStatistics large;
+	meshopt_analyzeOverdrawMulti(&large, ib, 6, vb, 4, 12, views, 1, 3072);
+
+	assert(large.pixels_covered == 3072 * 3072);
+	assert(large.pixels_shaded == 3072 * 3072);
+
+	// context variant matches, and reuses scratch memory across calls with the same viewport
+	meshopt_Context context = {};
+	meshopt_OverdrawStatistics context_results[3];
+
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		meshopt_analyzeOverdrawMultiWithContext(&context, context_results, ib, 12, vb, 8, 12, views, 3, 32);
+
+		for (int i = 0; i < 3; ++i)
+		{
+			assert(context_results[i].pixels_covered == results[i].pixels_covered);
+			assert(context_results[i].pixels_shaded == results[i].pixels_shaded);
+		}
+	}
+
+	assert(context.scratch && context.scratch_size >= 32 * 32 * 2 * 8);
+
+	meshopt_freeContext(&context);
+}
+
+static void optimizeOverdrawMulti()
+{
+	// two unit quads in XY plane that face away from each other and don't share vertices, so they end up in different clusters
+	float vb[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1};
+	unsigned int ib[] = {0, 2, 1, 2, 3, 1, 4, 5, 6, 6, 5, 7};
+
+	const float views[] = {0, 0, 1, 0, 0, -1};
+	unsigned int orderings[2][12];
+
+	meshopt_optimizeOverdrawMulti(orderings[0], ib, 12, vb, 8, 12, views, 2, 1.f);
+
+	// front-facing quad comes first: the quad at Z=0 faces -Z, and the quad at Z=1 faces +Z
+	assert(orderings[0][0] < 4 && orderings[0][11] >= 4);
+	assert(orderings[1][0] >= 4 && orderings[1][11] < 4);
+
+	// both orderings are permutations of the same triangles
+	for (int k = 0; k < 2; ++k)
+		for (int i = 0; i < 12; i += 3)
+		{
+			int found = 0;
+
+			for (int j = 0; j < 12; j += 3)
+				found += memcmp(&orderings[k][i], &ib[j], sizeof(unsigned int) * 3) == 0;
+
+			assert(found == 1);
+		}
+}
+
+static void analyzeVertexFetchMulti()
+{
+	const size_t vertex_count = 1000;
+
+	std::vector<unsigned int> ib;
+
+	for (unsigned int i = 0; i + 2 < vertex_count; ++i)
+	{
+		// stride through the vertex buffer to get some cache misses
+		unsigned int a = (i * 37) % vertex_count, b = (a + 1) % vertex_count, c = (a + 2) % vertex_count;
+
+		ib.push_back(a);
+		ib.push_back(b);
+		ib.push_back(c);
+	}
+
+	size_t vertex_sizes[] = {12, 20, 4};
+	size_t cache_line_sizes[] = {64, 64, 128};
+	meshopt_VertexFetchStatistics results[3];
+
+	meshopt_analyzeVertexFetchMulti(results, &ib[0], ib.size(), vertex_count, vertex_sizes, NULL, 1);
+
+	meshopt_VertexFetchStatistics expected = meshopt_analyzeVertexFetch(&ib[0], ib.size(), vertex_count, 12);
+
+	assert(results[0].bytes_fetched == expected.bytes_fetched);
+	assert(results[0].overfetch == expected.overfetch);
+
+	meshopt_analyzeVertexFetchMulti(results, &ib[0], ib.size(), vertex_count, vertex_sizes, cache_line_sizes, 3);
+
+	for (int k = 0; k < 3; ++k)
+	{
+		// each byte of each stream is fetched at least once, and each fetch is a multiple of the cache line size
+		assert(results[k].bytes_fetched >= vertex_count * vertex_sizes[k]);
+		assert(results[k].bytes_fetched % cache_line_sizes[k] == 0);
+		assert(results[k].overfetch >= 1.f);
+	}
+}
+
+static void optimizeVertexFetchRemapShadow()
+{
+	// 2 rows of 300 vertices with a strip of triangles in between; each vertex in the top row has a duplicate position (e.g. uv seam)
+	const size_t row = 300;
+	const size_t vertex_count = row * 3;
+
+	std::vector<unsigned int> ib, sib;
+
+	for (unsigned int i = 0; i + 1 < row; ++i)
+	{
+		// top row alternates between original vertices and their duplicates that are stored at the end of the vertex buffer
+		unsigned int t0 = (i % 2) ? unsigned(row * 2) + i : i, t1 = ((i + 1) % 2) ? unsigned(row * 2) + i + 1 : i + 1;
+		unsigned int b0 = unsigned(row) + i, b1 = unsigned(row) + i + 1;
+
+		unsigned int tris[6] = {t0, b0, t1, t1, b0, b1};
+		ib.insert(ib.end(), tris, tris + 6);
+	}
+
+	// shadow indices map duplicates to original vertices
+	for (size_t i = 0; i < ib.size(); ++i)
+		sib.push_back(ib[i] >= row * 2 ? ib[i] - unsigned(row * 2) : ib[i]);
+
+	std::vector<unsigned int> remap(vertex_count);
+	size_t unique = meshopt_optimizeVertexFetchRemapShadow(&remap[0], &ib[0], &sib[0], ib.size(), vertex_count);
+
+	// odd top row vertices are only referenced through their duplicates, but are still used by the shadow pass
+	assert(unique == row * 2 + row / 2);
+
+	std::vector<unsigned int> rib(ib.size()), rsib(sib.size());
+	meshopt_remapIndexBuffer(&rib[0], &ib[0], ib.size(), &remap[0]);
+	meshopt_remapIndexBuffer(&rsib[0], &sib[0], sib.size(), &remap[0]);
+
+	// vertices referenced by the shadow pass are grouped in windows of 256 vertices, so the first window is only used by the shadow pass
+	std::vector<unsigned char> shadow_used(vertex_count);
+
+	for (size_t i = 0; i < rsib.size(); ++i)
+		shadow_used[rsib[i]] = 1;
+
+	for (size_t i = 0; i < 256; ++i)
+		assert(shadow_used[i]);
+
+	// remapped full pass indices are a valid permutation of the original ones
+	for (size_t i = 0; i < ib.size(); ++i)
+		assert(rib[i] < unique && remap[ib[i]] == rib[i]);
+}
+
 static void emptyMesh()
 {
-	meshopt_optimizeVertexCache(0, 0, 0, 0);
-	meshopt_optimizeVertexCacheFifo(0, 0, 0, 0, 16);
-	meshopt_optimizeOverdraw(0, 0, 0, 0, 0, 12, 1.f);
+	meshopt_optimizeVertexCache(0, 0, 0, 0);
+	meshopt_optimizeVertexCacheFifo(0, 0, 0, 0, 16);
+	meshopt_optimizeVertexCacheChunked(0, 0, 0, 0, 0, 12, 64);
+	meshopt_optimizeOverdraw(0, 0, 0, 0, 0, 12, 1.f);
+}
+
+static void simplifyStuck()
+{
+	// tetrahedron can't be simplified due to collapse error restrictions
+	float vb1[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1};
+	unsigned int ib1[] = {0, 1, 2, 0, 2, 3, 0, 3, 1, 2, 1, 3};
+
+	assert(meshopt_simplify(ib1, ib1, 12, vb1, 4, 12, 6, 1e-3f) == 12);
+
+	// 5-vertex strip can't be simplified due to topology restriction since middle triangle has flipped winding
+	float vb2[] = {0, 0, 0, 1, 0, 0, 2, 0, 0, 0.5f, 1, 0, 1.5f, 1, 0};
+	unsigned int ib2[] = {0, 1, 3, 3, 1, 4, 1, 2, 4}; // ok
+	unsigned int ib3[] = {0, 1, 3, 1, 3, 4, 1, 2, 4}; // flipped
+
+	assert(meshopt_simplify(ib2, ib2, 9, vb2, 5, 12, 6, 1e-3f) == 6);
+	assert(meshopt_simplify(ib3, ib3, 9, vb2, 5, 12, 6, 1e-3f) == 9);
+
+	// 4-vertex quad with a locked corner can't be simplified due to border error-induced restriction
+	float vb4[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0};
+	unsigned int ib4[] = {0, 1, 3, 0, 3, 2};
+
+	assert(meshopt_simplify(ib4, ib4, 6, vb4, 4, 12, 3, 1e-3f) == 6);
+
+	// 4-vertex quad with a locked corner can't be simplified due to border error-induced restriction
+	float vb5[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 1, 1, 0};
+	unsigned int ib5[] = {0, 1, 4, 0, 3, 2};
+
+	assert(meshopt_simplify(ib5, ib5, 6, vb5, 5, 12, 3, 1e-3f) == 6);
+}
+
+static void simplifySloppyStuck()
+{
+	const float vb[] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+	const unsigned int ib[] = {0, 1, 2, 0, 1, 2};
+
+	unsigned int* target = NULL;
+
+	// simplifying down to 0 triangles results in 0 immediately
+	assert(meshopt_simplifySloppy(target, ib, 3, vb, 3, 12, 0, 0.f) == 0);
+
+	// simplifying down to 2 triangles given that all triangles are degenerate results in 0 as well
+	assert(meshopt_simplifySloppy(target, ib, 6, vb, 3, 12, 6, 0.f) == 0);
+}
+
+static void simplifySloppyGrid()
+{
+	float vb[48 * 48][3];
+
+	for (int y = 0; y < 48; ++y)
+		for (int x = 0; x < 48; ++x)
+		{
+			vb[y * 48 + x][0] = float(x);
+			vb[y * 48 + x][1] = float(y);
+			vb[y * 48 + x][2] = sinf(float(x) * 0.3f) * cosf(float(y) * 0.2f) * 4.f;
+		}
+
+	unsigned int ib[47 * 47][6];
+
+	for (int y = 0; y < 47; ++y)
+		for (int x = 0; x < 47; ++x)
+		{
+			unsigned int a = y * 48 + x, b = a + 1, c = a + 48, d = c + 1;
+			unsigned int quad[6] = {a, b, c, c, b, d};
+			memcpy(ib[y * 47 + x], quad, sizeof(quad));
+		}
+
+	// the grid search should settle on the same grid sizes as the reference search, which results in these triangle counts
+	const size_t targets[] = {3000, 1000, 300, 100, 30};
+	const size_t expected[] = {2964, 921, 270, 68, 18};
+
+	unsigned int lod[47 * 47 * 6];
+
+	for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); ++i)
+		assert(meshopt_simplifySloppy(lod, ib[0], 47 * 47 * 6, vb[0], 48 * 48, sizeof(float) * 3, targets[i] * 3, 1.f) == expected[i] * 3);
+
+	// error-limited search starts from the smallest grid that satisfies the error bound
+	assert(meshopt_simplifySloppy(lod, ib[0], 47 * 47 * 6, vb[0], 48 * 48, sizeof(float) * 3, 0, 2e-2f) == 4418 * 3);
+}
+
+static void simplifyPointsStuck()
+{
+	const float vb[] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+	// simplifying down to 0 points results in 0 immediately
+	assert(meshopt_simplifyPoints(0, vb, 3, 12, NULL, 0, 0.f, 0) == 0);
+}
+
+static void simplifyPointsCenter()
+{
+	// the mean of these points is 2.25, so the point closest to the mean is 2; point error must be a squared distance for it to be selected
+	const float vb[] = {0, 0, 0, 1, 0, 0, 2, 0, 0, 6, 0, 0};
+
+	unsigned int point = ~0u;
+	assert(meshopt_simplifyPoints(&point, vb, 4, 12, NULL, 0, 0.f, 1) == 1);
+	assert(point == 2);
+}
+
+static void simplifyPointsColor()
+{
+	// four clusters of three points; the middle point of each cluster is the closest to the cluster center, but has an outlier color
+	float vb[4 * 3][3];
+	float cb[4 * 3][3];
+
+	for (int c = 0; c < 4; ++c)
+		for (int i = 0; i < 3; ++i)
+		{
+			vb[c * 3 + i][0] = float(c & 1) + float(i - 1) * 0.01f;
+			vb[c * 3 + i][1] = float(c >> 1);
+			vb[c * 3 + i][2] = 0.f;
+
+			cb[c * 3 + i][0] = i == 1 ? 0.f : 1.f;
+			cb[c * 3 + i][1] = 0.f;
+			cb[c * 3 + i][2] = i == 1 ? 1.f : 0.f;
+		}
+
+	unsigned int points[4];
+
+	// without colors, the center point of each cluster is selected
+	assert(meshopt_simplifyPoints(points, vb[0], 4 * 3, sizeof(float) * 3, NULL, 0, 0.f, 4) == 4);
+
+	for (int i = 0; i < 4; ++i)
+		assert(points[i] % 3 == 1);
+
+	// with colors, selected points have the dominant color of each cluster
+	assert(meshopt_simplifyPoints(points, vb[0], 4 * 3, sizeof(float) * 3, cb[0], sizeof(float) * 3, 1.f, 4) == 4);
+
+	for (int i = 0; i < 4; ++i)
+		assert(points[i] % 3 != 1);
+}
+
+static void simplifyPointHierarchy()
+{
+	const size_t point_count = 5000;
+	const size_t max_node_points = 64;
+
+	std::vector<float> vb(point_count * 3);
+
+	// deterministic pseudo-random points on a sphere-like surface
+	unsigned int seed = 42;
+
+	for (size_t i = 0; i < point_count; ++i)
+	{
+		float p[3];
+
+		for (int k = 0; k < 3; ++k)
+		{
+			seed = seed * 1103515245 + 12345;
+			p[k] = float((seed >> 8) & 0xffff) / 65535.f * 2.f - 1.f;
+		}
+
+		float len = sqrtf(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+		float inv = len > 0.f ? 1.f / len : 0.f;
+
+		vb[i * 3 + 0] = p[0] * inv;
+		vb[i * 3 + 1] = p[1] * inv;
+		vb[i * 3 + 2] = p[2] * inv;
+	}
+
+	std::vector<meshopt_PointNode> nodes(point_count);
+	std::vector<unsigned int> points(point_count);
+
+	size_t node_count = meshopt_buildPointHierarchy(&nodes[0], &points[0], &vb[0], point_count, sizeof(float) * 3, max_node_points, NULL);
+	assert(node_count > 1 && node_count <= point_count);
+
+	// every point belongs to exactly one node, and every point is within the bounds of its node
+	std::vector<unsigned char> seen(point_count);
+	size_t total = 0;
+
+	for (size_t i = 0; i < node_count; ++i)
+	{
+		const meshopt_PointNode& node = nodes[i];
+
+		assert(node.point_count > 0);
+		assert(node.child_count == 0 || node.point_count <= max_node_points);
+		assert(node.child_count == 0 || node.child_offset > i);
+		assert(node.child_offset + node.child_count <= node_count);
+
+		for (size_t j = 0; j < node.point_count; ++j)
+		{
+			unsigned int v = points[node.point_offset + j];
+
+			assert(!seen[v]);
+			seen[v] = 1;
+
+			for (int k = 0; k < 3; ++k)
+				assert(fabsf(vb[v * 3 + k] - node.center[k]) <= node.extent * 1.001f);
+		}
+
+		total += node.point_count;
+	}
+
+	assert(total == point_count);
+
+	// building a subtree separately with its bounds selects the same points as the full hierarchy
+	const meshopt_PointNode& child = nodes[nodes[0].child_offset];
+	size_t child_end = nodes[0].child_count > 1 ? nodes[nodes[0].child_offset + 1].point_offset : point_count;
+
+	std::vector<unsigned char> in_subtree(point_count);
+	for (size_t i = child.point_offset; i < child_end; ++i)
+		in_subtree[points[i]] = 1;
+
+	std::vector<unsigned int> sub_map;
+	std::vector<float> sub_vb;
+
+	for (size_t i = 0; i < point_count; ++i)
+		if (in_subtree[i])
+		{
+			sub_map.push_back(unsigned(i));
+			sub_vb.insert(sub_vb.end(), &vb[i * 3], &vb[i * 3] + 3);
+		}
+
+	float bounds[4] = {child.center[0], child.center[1], child.center[2], child.extent};
+
+	std::vector<meshopt_PointNode> sub_nodes(sub_map.size());
+	std::vector<unsigned int> sub_points(sub_map.size());
+	meshopt_buildPointHierarchy(&sub_nodes[0], &sub_points[0], &sub_vb[0], sub_map.size(), sizeof(float) * 3, max_node_points, bounds);
+
+	assert(sub_nodes[0].point_count == child.point_count);
+
+	std::vector<unsigned char> in_child(point_count);
+	for (size_t i = 0; i < child.point_count; ++i)
+		in_child[points[child.point_offset + i]] = 1;
+
+	for (size_t i = 0; i < sub_nodes[0].point_count; ++i)
+		assert(in_child[sub_map[sub_points[i]]]);
+}
+
+static void simplifyFlip()
+{
+	// this mesh has been constructed by taking a tessellated irregular grid with a square cutout
+	// and progressively collapsing edges until the only ones left violate border or flip constraints.
+	// there is only one valid non-flip collapse, so we validate that we take it; when flips are allowed,
+	// the wrong collapse is picked instead.
+	float vb[] = {
+	    1.000000f, 1.000000f, -1.000000f,
+	    1.000000f, 1.000000f, 1.000000f,
+	    1.000000f, -1.000000f, 1.000000f,
+	    1.000000f, -0.200000f, -0.200000f,
+	    1.000000f, 0.200000f, -0.200000f,
+	    1.000000f, -0.200000f, 0.200000f,
+	    1.000000f, 0.200000f, 0.200000f,
+	    1.000000f, 0.500000f, -0.500000f,
+	    1.000000f, -1.000000f, 0.000000f, // clang-format :-/
+	};
+
+	// the collapse we expect is 7 -> 0
+	unsigned int ib[] = {
+	    7, 4, 3,
+	    1, 2, 5,
+	    7, 1, 6,
+	    7, 8, 0, // gets removed
+	    7, 6, 4,
+	    8, 5, 2,
+	    8, 7, 3,
+	    8, 3, 5,
+	    5, 6, 1,
+	    7, 0, 1, // gets removed
+	};
+
+	unsigned int expected[] = {
+	    0, 4, 3,
+	    1, 2, 5,
+	    0, 1, 6,
+	    0, 6, 4,
+	    8, 5, 2,
+	    8, 0, 3,
+	    8, 3, 5,
+	    5, 6, 1, // clang-format :-/
+	};
+
+	assert(meshopt_simplify(ib, ib, 30, vb, 9, 12, 3, 1e-3f) == 24);
+	assert(memcmp(ib, expected, sizeof(expected)) == 0);
+}
+
+static void simplifyScale()
+{
+	const float vb[] = {0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 3};
+
+	assert(meshopt_simplifyScale(vb, 4, 12) == 3.f);
+}
+
+static void simplifyDegenerate()
+{
+	float vb[] = {
+	    0.000000f, 0.000000f, 0.000000f,
+	    0.000000f, 1.000000f, 0.000000f,
+	    0.000000f, 2.000000f, 0.000000f,
+	    1.000000f, 0.000000f, 0.000000f,
+	    2.000000f, 0.000000f, 0.000000f,
+	    1.000000f, 1.000000f, 0.000000f, // clang-format :-/
+	};
+
+	// 0 1 2
+	// 3 5
+	// 4
+
+	unsigned int ib[] = {
+	    0, 1, 3,
+	    3, 1, 5,
+	    1, 2, 5,
+	    3, 5, 4,
+	    1, 0, 1, // these two degenerate triangles create a fake reverse edge
+	    0, 3, 0, // which breaks border classification
+	};
+
+	unsigned int expected[] = {
+	    0, 1, 4,
+	    4, 1, 2, // clang-format :-/
+	};
+
+	assert(meshopt_simplify(ib, ib, 18, vb, 6, 12, 3, 1e-3f) == 6);
+	assert(memcmp(ib, expected, sizeof(expected)) == 0);
+}
+
+static void simplifyLockBorder()
+{
+	float vb[] = {
+	    0.000000f, 0.000000f, 0.000000f,
+	    0.000000f, 1.000000f, 0.000000f,
+	    0.000000f, 2.000000f, 0.000000f,
+	    1.000000f, 0.000000f, 0.000000f,
+	    1.000000f, 1.000000f, 0.000000f,
+	    1.000000f, 2.000000f, 0.000000f,
+	    2.000000f, 0.000000f, 0.000000f,
+	    2.000000f, 1.000000f, 0.000000f,
+	    2.000000f, 2.000000f, 0.000000f, // clang-format :-/
+	};
+
+	// 0 1 2
+	// 3 4 5
+	// 6 7 8
+
+	unsigned int ib[] = {
+	    0, 1, 3,
+	    3, 1, 4,
+	    1, 2, 4,
+	    4, 2, 5,
+	    3, 4, 6,
+	    6, 4, 7,
+	    4, 5, 7,
+	    7, 5, 8, // clang-format :-/
+	};
+
+	unsigned int expected[] = {
+	    0, 1, 3,
+	    1, 2, 3,
+	    3, 2, 5,
+	    6, 3, 7,
+	    3, 5, 7,
+	    7, 5, 8, // clang-format :-/
+	};
+
+	assert(meshopt_simplify(ib, ib, 24, vb, 9, 12, 3, 1e-3f, meshopt_SimplifyLockBorder) == 18);
+	assert(memcmp(ib, expected, sizeof(expected)) == 0);
+}
+
+static void simplifyAttr()
+{
+	float vb[8 * 3][6];
+
+	for (int y = 0; y < 8; ++y)
+	{
+		// first four rows are a blue gradient, next four rows are a yellow gradient
+		float r = (y < 4) ? 0.8f + y * 0.05f : 0.f;
+		float g = (y < 4) ? 0.8f + y * 0.05f : 0.f;
+		float b = (y < 4) ? 0.f : 0.8f + (7 - y) * 0.05f;
+
+		for (int x = 0; x < 3; ++x)
+		{
+			vb[y * 3 + x][0] = float(x);
+			vb[y * 3 + x][1] = float(y);
+			vb[y * 3 + x][2] = 0.03f * x;
+			vb[y * 3 + x][3] = r;
+			vb[y * 3 + x][4] = g;
+			vb[y * 3 + x][5] = b;
+		}
+	}
+
+	unsigned int ib[7 * 2][6];
+
+	for (int y = 0; y < 7; ++y)
+	{
+		for (int x = 0; x < 2; ++x)
+		{
+			ib[y * 2 + x][0] = (y + 0) * 3 + (x + 0);
+			ib[y * 2 + x][1] = (y + 0) * 3 + (x + 1);
+			ib[y * 2 + x][2] = (y + 1) * 3 + (x + 0);
+			ib[y * 2 + x][3] = (y + 1) * 3 + (x + 0);
+			ib[y * 2 + x][4] = (y + 0) * 3 + (x + 1);
+			ib[y * 2 + x][5] = (y + 1) * 3 + (x + 1);
+		}
+	}
+
+	float attr_weights[3] = {0.01f, 0.01f, 0.01f};
+
+	// the color discontinuity between rows 3 and 4 and the gradient ends need to be preserved
+	unsigned int expected[3][6] = {
+	    {0, 2, 9, 9, 2, 11},
+	    {9, 11, 12, 12, 11, 14},
+	    {12, 14, 21, 21, 14, 23},
+	};
+
+	assert(meshopt_simplifyWithAttributes(ib[0], ib[0], 7 * 2 * 6, vb[0], 8 * 3, 6 * sizeof(float), vb[0] + 3, 6 * sizeof(float), attr_weights, 3, 6 * 3, 1e-2f) == 18);
+	assert(memcmp(ib, expected, sizeof(expected)) == 0);
+}
+
+static void adjacency()
+{
+	// 0 1/4
+	// 2/5 3
+	const float vb[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 0, 1, 0};
+	const unsigned int ib[] = {0, 1, 2, 5, 4, 3};
+
+	unsigned int adjib[12];
+	meshopt_generateAdjacencyIndexBuffer(adjib, ib, 6, vb, 6, 12);
+
+	unsigned int expected[] = {
+	    // patch 0
+	    0, 0,
+	    1, 3,
+	    2, 2,
+
+	    // patch 1
+	    5, 0,
+	    4, 4,
+	    3, 3,
+
+	    // clang-format :-/
+	};
+
+	assert(memcmp(adjib, expected, sizeof(expected)) == 0);
+}
+
+static void tessellation()
+{
+	// 0 1/4
+	// 2/5 3
+	const float vb[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 0, 1, 0};
+	const unsigned int ib[] = {0, 1, 2, 5, 4, 3};
+
+	unsigned int tessib[24];
+	meshopt_generateTessellationIndexBuffer(tessib, ib, 6, vb, 6, 12);
+
+	unsigned int expected[] = {
+	    // patch 0
+	    0, 1, 2,
+	    0, 1,
+	    4, 5,
+	    2, 0,
+	    0, 1, 2,
+
+	    // patch 1
+	    5, 4, 3,
+	    2, 1,
+	    4, 3,
+	    3, 5,
+	    2, 1, 3,
+
+	    // clang-format :-/
+	};
+
+	assert(memcmp(tessib, expected, sizeof(expected)) == 0);
+}
+
+static void simplifyErrors()
+{
+	float vb[16 * 16][3];
+
+	// left half of the grid is flat, right half is bumpy
+	for (int y = 0; y < 16; ++y)
+		for (int x = 0; x < 16; ++x)
+		{
+			vb[y * 16 + x][0] = float(x);
+			vb[y * 16 + x][1] = float(y);
+			vb[y * 16 + x][2] = x < 8 ? 0.f : ((x + y) % 2) * 0.1f;
+		}
+
+	unsigned int ib[15 * 15][6];
+
+	for (int y = 0; y < 15; ++y)
+		for (int x = 0; x < 15; ++x)
+		{
+			ib[y * 15 + x][0] = (y + 0) * 16 + (x + 0);
+			ib[y * 15 + x][1] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][2] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][3] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][4] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][5] = (y + 1) * 16 + (x + 1);
+		}
+
+	unsigned int lod[15 * 15 * 6];
+	float vertex_errors[16 * 16];
+	float result_error = 0;
+
+	size_t lod_count = meshopt_simplifyWithErrors(lod, vertex_errors, ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, 60, 1.f, 0, &result_error);
+	assert(lod_count < 15 * 15 * 6);
+	assert(result_error > 0.f);
+
+	// the worst vertex error matches the overall error; vertices that only absorbed flat geometry have no error
+	float max_error = 0.f;
+	size_t flat_vertices = 0;
+
+	for (size_t i = 0; i < lod_count; ++i)
+	{
+		unsigned int v = lod[i];
+
+		assert(vertex_errors[v] <= result_error);
+		max_error = max_error < vertex_errors[v] ? vertex_errors[v] : max_error;
+
+		flat_vertices += vertex_errors[v] == 0.f;
+	}
+
+	assert(max_error == result_error);
+	assert(flat_vertices > 0);
+}
+
+static int cancelProgress(void* userdata, float fraction, size_t count, float error)
+{
+	(void)count;
+	(void)error;
+
+	assert(fraction >= 0.f && fraction <= 1.f);
+
+	int* calls = static_cast<int*>(userdata);
+	return ++*calls < 2;
+}
+
+static void simplifyExactOrder()
+{
+	float vb[16 * 16][3];
+
+	// wavy grid with a gradually increasing amplitude so that collapse errors vary across the mesh
+	for (int y = 0; y < 16; ++y)
+		for (int x = 0; x < 16; ++x)
+		{
+			vb[y * 16 + x][0] = float(x);
+			vb[y * 16 + x][1] = float(y);
+			vb[y * 16 + x][2] = sinf(float(x) * 0.7f) * cosf(float(y) * 0.5f) * float(x + y) * 0.02f;
+		}
+
+	unsigned int ib[15 * 15][6];
+
+	for (int y = 0; y < 15; ++y)
+		for (int x = 0; x < 15; ++x)
+		{
+			ib[y * 15 + x][0] = (y + 0) * 16 + (x + 0);
+			ib[y * 15 + x][1] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][2] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][3] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][4] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][5] = (y + 1) * 16 + (x + 1);
+		}
+
+	unsigned int lod[15 * 15 * 6];
+	float error = 0.f, error_ordered = 0.f;
+
+	size_t count = meshopt_simplify(lod, ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, 150, 1.f, 0, &error);
+	size_t count_ordered = meshopt_simplify(lod, ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, 150, 1.f, meshopt_SimplifyExactOrder, &error_ordered);
+
+	// both modes reach the target, but exact order mode always picks the cheapest collapse first
+	assert(count <= 150 && count_ordered <= 150);
+	assert(error_ordered <= error);
+
+	for (size_t i = 0; i < count_ordered; ++i)
+		assert(lod[i] < 16 * 16);
+
+	// the scratch size query covers the collapse heap, so a cold context grows exactly to the reported size
+	meshopt_Context context = {};
+	unsigned int lod_context[15 * 15 * 6];
+	float error_context = 0.f;
+
+	size_t count_context = meshopt_simplifyWithContext(&context, lod_context, ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, NULL, 0, NULL, 0, 150, 1.f, meshopt_SimplifyExactOrder, &error_context);
+
+	assert(count_context == count_ordered && error_context == error_ordered);
+	assert(memcmp(lod_context, lod, count_ordered * sizeof(unsigned int)) == 0);
+	assert(context.scratch_size == meshopt_simplifyScratchSize(15 * 15 * 6, 16 * 16, 0, meshopt_SimplifyExactOrder));
+
+	meshopt_freeContext(&context);
+
+	// progressive simplification records the same collapse sequence, so its base mesh matches the regular result
+	unsigned int pib[15 * 15 * 6];
+	unsigned int remap[16 * 16];
+	meshopt_VertexSplit splits[16 * 16];
+
+	size_t vertex_count = meshopt_simplifyProgressive(pib, remap, splits, ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, 150, 1.f, meshopt_SimplifyExactOrder);
+	assert(vertex_count == 16 * 16);
+
+	size_t base_vertex_count = 0;
+	while (base_vertex_count < vertex_count && splits[base_vertex_count].parent == base_vertex_count)
+		base_vertex_count++;
+
+	assert(splits[base_vertex_count - 1].triangle_count * 3 == count_ordered);
+	assert(splits[vertex_count - 1].triangle_count * 3 == 15 * 15 * 6);
+
+	for (size_t n = base_vertex_count + 1; n <= vertex_count; ++n)
+		assert(splits[n - 1].parent < n - 1 && splits[n - 1].error <= splits[n - 2].error);
+
+	// attribute quadrics are merged on every collapse, including the attribute gradients of the target vertex
+	float attribute_weights[1] = {0.5f};
+	float error_attributes = 0.f;
+
+	size_t count_attributes = meshopt_simplifyWithAttributes(lod, ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, &vb[0][2], sizeof(float) * 3, attribute_weights, 1, 150, 1.f, meshopt_SimplifyExactOrder, &error_attributes);
+
+	assert(count_attributes <= 150);
+
+	for (size_t i = 0; i < count_attributes; ++i)
+		assert(lod[i] < 16 * 16);
+
+	// cancellation stops between collapses and leaves a valid partially simplified mesh
+	int calls = 0;
+
+	meshopt_Context cancel = {};
+	cancel.progress = cancelProgress;
+	cancel.userdata = &calls;
+
+	unsigned int partial[15 * 15 * 6];
+	size_t partial_count = meshopt_simplifyWithContext(&cancel, partial, ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, NULL, 0, NULL, 0, 150, 1.f, meshopt_SimplifyExactOrder, NULL);
+
+	assert(calls == 2);
+	assert(partial_count < 15 * 15 * 6 && partial_count > count_ordered);
+	assert(partial_count % 3 == 0);
+
+	for (size_t i = 0; i < partial_count; i += 3)
+	{
+		assert(partial[i + 0] < 16 * 16 && partial[i + 1] < 16 * 16 && partial[i + 2] < 16 * 16);
+		assert(partial[i + 0] != partial[i + 1] && partial[i + 0] != partial[i + 2] && partial[i + 1] != partial[i + 2]);
+	}
+
+	// on a flat grid with a tight error limit, both modes collapse the same set of zero-error edges
+	for (int i = 0; i < 16 * 16; ++i)
+		vb[i][2] = 0.f;
+
+	count = meshopt_simplify(lod, ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, 0, 1e-3f, 0);
+	count_ordered = meshopt_simplify(lod, ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, 0, 1e-3f, meshopt_SimplifyExactOrder);
+
+	assert(count == 6);
+	assert(count_ordered == 6);
+}
+
+static void simplifyProgressive()
+{
+	float vb[16 * 16][3];
+
+	for (int y = 0; y < 16; ++y)
+		for (int x = 0; x < 16; ++x)
+		{
+			vb[y * 16 + x][0] = float(x);
+			vb[y * 16 + x][1] = float(y);
+			vb[y * 16 + x][2] = sinf(float(x) * 0.5f) * cosf(float(y) * 0.3f);
+		}
+
+	unsigned int ib[15 * 15][6];
+
+	for (int y = 0; y < 15; ++y)
+		for (int x = 0; x < 15; ++x)
+		{
+			ib[y * 15 + x][0] = (y + 0) * 16 + (x + 0);
+			ib[y * 15 + x][1] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][2] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][3] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][4] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][5] = (y + 1) * 16 + (x + 1);
+		}
+
+	const size_t index_count = 15 * 15 * 6;
+
+	unsigned int lod[index_count];
+	size_t lod_count = meshopt_simplify(lod, ib[0], index_count, vb[0], 16 * 16, sizeof(float) * 3, 60, 1.f);
+	assert(lod_count < index_count);
+
+	unsigned int pib[index_count];
+	unsigned int remap[16 * 16];
+	meshopt_VertexSplit splits[16 * 16];
+
+	size_t vertex_count = meshopt_simplifyProgressive(pib, remap, splits, ib[0], index_count, vb[0], 16 * 16, sizeof(float) * 3, 60, 1.f);
+	assert(vertex_count == 16 * 16);
+
+	size_t base_vertex_count = 0;
+	while (base_vertex_count < vertex_count && splits[base_vertex_count].parent == base_vertex_count)
+		base_vertex_count++;
+
+	// the base mesh matches the regular simplification result, and the full mesh matches the source mesh
+	assert(splits[base_vertex_count - 1].triangle_count * 3 == lod_count);
+	assert(splits[vertex_count - 1].triangle_count * 3 == index_count);
+	assert(splits[vertex_count - 1].error == 0.f);
+
+	unsigned int inc[index_count];
+	unsigned int full[index_count];
+	unsigned int coarse[index_count];
+
+	size_t inc_count = meshopt_refineProgressive(inc, pib, splits, 0, base_vertex_count);
+	memcpy(coarse, pib, sizeof(pib));
+
+	for (size_t n = base_vertex_count; n <= vertex_count; ++n)
+	{
+		if (n > base_vertex_count)
+		{
+			assert(splits[n - 1].parent < n - 1);
+			assert(splits[n - 1].error <= splits[n - 2].error);
+
+			inc_count = meshopt_refineProgressive(inc, pib, splits, n - 1, n);
+		}
+
+		// refining incrementally, building from scratch and coarsening from the full mesh should produce the same result
+		size_t full_count = meshopt_refineProgressive(full, pib, splits, 0, n);
+		size_t coarse_count = meshopt_refineProgressive(coarse, pib, splits, vertex_count, n);
+
+		assert(inc_count == full_count && coarse_count == full_count);
+		assert(memcmp(inc, full, full_count * sizeof(unsigned int)) == 0);
+		assert(memcmp(coarse, full, full_count * sizeof(unsigned int)) == 0);
+
+		for (size_t i = 0; i < full_count; i += 3)
+		{
+			assert(full[i + 0] < n && full[i + 1] < n && full[i + 2] < n);
+			assert(full[i + 0] != full[i + 1] && full[i + 0] != full[i + 2] && full[i + 1] != full[i + 2]);
+		}
+
+		memcpy(coarse, pib, sizeof(pib));
+	}
+
+	// 16-bit indices go through the template adapters and should match 32-bit results when refining and coarsening
+	unsigned short pib16[index_count];
+	unsigned short lod16[index_count];
+
+	for (size_t i = 0; i < index_count; ++i)
+		pib16[i] = (unsigned short)pib[i];
+
+	size_t full_count = meshopt_refineProgressive(full, pib, splits, 0, vertex_count);
+	size_t lod16_count = meshopt_refineProgressive(lod16, pib16, splits, 0, vertex_count);
+	assert(lod16_count == full_count);
+
+	for (size_t i = 0; i < full_count; ++i)
+		assert(lod16[i] == full[i]);
+
+	full_count = meshopt_refineProgressive(full, pib, splits, 0, base_vertex_count);
+	lod16_count = meshopt_refineProgressive(lod16, pib16, splits, vertex_count, base_vertex_count);
+	assert(lod16_count == full_count);
+
+	for (size_t i = 0; i < full_count; ++i)
+		assert(lod16[i] == full[i]);
+
+	// empty meshes have no vertices at all
+	assert(meshopt_refineProgressive(lod16, pib16, splits, 0, 0) == 0);
+	assert(meshopt_refineProgressive(full, pib, splits, 0, 0) == 0);
+}
+
+static void simplifyProgressiveSeams()
+{
+	// 16x16 grid with a vertical seam along x=8; the right half uses a separate copy of the seam vertices
+	float vb[16 * 16 + 16][3];
+
+	for (int y = 0; y < 16; ++y)
+		for (int x = 0; x < 16; ++x)
+		{
+			vb[y * 16 + x][0] = float(x);
+			vb[y * 16 + x][1] = float(y);
+			vb[y * 16 + x][2] = sinf(float(x) * 0.5f) * cosf(float(y) * 0.3f);
+		}
+
+	for (int y = 0; y < 16; ++y)
+		memcpy(vb[16 * 16 + y], vb[y * 16 + 8], sizeof(vb[0]));
+
+	unsigned int ib[15 * 15][6];
+
+	for (int y = 0; y < 15; ++y)
+		for (int x = 0; x < 15; ++x)
+		{
+			unsigned int a = (y + 0) * 16 + (x + 0), b = (y + 0) * 16 + (x + 1), c = (y + 1) * 16 + (x + 0), d = (y + 1) * 16 + (x + 1);
+
+			if (x == 8)
+				a = 16 * 16 + y, c = 16 * 16 + y + 1;
+
+			unsigned int quad[6] = {a, b, c, c, b, d};
+			memcpy(ib[y * 15 + x], quad, sizeof(quad));
+		}
+
+	const size_t index_count = 15 * 15 * 6;
+	const size_t source_vertex_count = 16 * 16 + 16;
+
+	unsigned int pib[index_count];
+	unsigned int remap[source_vertex_count];
+	meshopt_VertexSplit splits[source_vertex_count];
+
+	size_t vertex_count = meshopt_simplifyProgressive(pib, remap, splits, ib[0], index_count, vb[0], source_vertex_count, sizeof(float) * 3, 60, 1.f);
+	assert(vertex_count == source_vertex_count);
+
+	size_t base_vertex_count = 0;
+	while (base_vertex_count < vertex_count && splits[base_vertex_count].parent == base_vertex_count)
+		base_vertex_count++;
+
+	float pvb[source_vertex_count][3];
+	meshopt_remapVertexBuffer(pvb, vb, source_vertex_count, sizeof(vb[0]), remap);
+
+	size_t groups = 0, seam_splits = 0;
+
+	for (size_t n = base_vertex_count; n <= vertex_count; ++n)
+	{
+		assert(splits[n - 1].group_end >= n && splits[n - 1].group_end <= vertex_count);
+
+		// group ends are shared by all vertices of the group
+		assert(n == vertex_count || splits[n - 1].group_end == n || splits[n].group_end == splits[n - 1].group_end);
+
+		if (splits[n - 1].group_end != n)
+			continue;
+
+		groups++;
+
+		// every prefix that ends a group must keep both sides of the seam at the same position
+		for (int y = 0; y < 16; ++y)
+		{
+			unsigned int l = remap[y * 16 + 8], r = remap[16 * 16 + y];
+
+			while (l >= n)
+				l = splits[l].parent;
+			while (r >= n)
+				r = splits[r].parent;
+
+			assert(memcmp(pvb[l], pvb[r], sizeof(pvb[0])) == 0);
+
+			seam_splits += (l >= base_vertex_count && l != r);
+		}
+	}
+
+	// seam vertices are split in pairs, so there are fewer groups than vertices
+	assert(groups < vertex_count - base_vertex_count + 1);
+	assert(seam_splits > 0);
+}
+
+static void simplifyCancel()
+{
+	float vb[16 * 16][3];
+
+	for (int y = 0; y < 16; ++y)
+		for (int x = 0; x < 16; ++x)
+		{
+			vb[y * 16 + x][0] = float(x);
+			vb[y * 16 + x][1] = float(y);
+			vb[y * 16 + x][2] = 0.f;
+		}
+
+	unsigned int ib[15 * 15][6];
+
+	for (int y = 0; y < 15; ++y)
+		for (int x = 0; x < 15; ++x)
+		{
+			ib[y * 15 + x][0] = (y + 0) * 16 + (x + 0);
+			ib[y * 15 + x][1] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][2] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][3] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][4] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][5] = (y + 1) * 16 + (x + 1);
+		}
+
+	unsigned int full[15 * 15 * 6];
+	size_t full_count = meshopt_simplify(full, ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, 6, 1e-2f);
+
+	int calls = 0;
+
+	meshopt_Context context = {};
+	context.progress = cancelProgress;
+	context.userdata = &calls;
+
+	// cancellation after the second pass returns a partially simplified mesh that is still valid
+	unsigned int partial[15 * 15 * 6];
+	size_t partial_count = meshopt_simplifyWithContext(&context, partial, ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, NULL, 0, NULL, 0, 6, 1e-2f);
+
+	assert(calls == 2);
+	assert(partial_count < 15 * 15 * 6 && partial_count > full_count);
+	assert(partial_count % 3 == 0);
+
+	for (size_t i = 0; i < partial_count; ++i)
+		assert(partial[i] < 16 * 16);
+}
+
+static void meshletsCancel()
+{
+	const size_t max_vertices = 64;
+	const size_t max_triangles = 16;
+
+	float vb[16 * 16][3];
+
+	for (int y = 0; y < 16; ++y)
+		for (int x = 0; x < 16; ++x)
+		{
+			vb[y * 16 + x][0] = float(x);
+			vb[y * 16 + x][1] = float(y);
+			vb[y * 16 + x][2] = 0.f;
+		}
+
+	unsigned int ib[15 * 15][6];
+
+	for (int y = 0; y < 15; ++y)
+		for (int x = 0; x < 15; ++x)
+		{
+			ib[y * 15 + x][0] = (y + 0) * 16 + (x + 0);
+			ib[y * 15 + x][1] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][2] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][3] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][4] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][5] = (y + 1) * 16 + (x + 1);
+		}
+
+	size_t max_meshlets = meshopt_buildMeshletsBound(15 * 15 * 6, max_vertices, max_triangles);
+
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+
+	int calls = 0;
+
+	meshopt_Context context = {};
+	context.progress = cancelProgress;
+	context.userdata = &calls;
+
+	size_t meshlet_count = meshopt_buildMeshletsWithContext(&context, &meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], ib[0], 15 * 15 * 6, vb[0], 16 * 16, sizeof(float) * 3, max_vertices, max_triangles, 0.f);
+
+	assert(calls == 2);
+	assert(meshlet_count <= max_meshlets);
+
+	// remaining triangles must still be emitted after cancellation
+	size_t triangle_count = 0;
+
+	for (size_t i = 0; i < meshlet_count; ++i)
+	{
+		assert(meshlets[i].vertex_count <= max_vertices);
+		assert(meshlets[i].triangle_count <= max_triangles);
+
+		triangle_count += meshlets[i].triangle_count;
+	}
+
+	assert(triangle_count == 15 * 15 * 2);
+}
+
+static float meshletBoxArea(const meshopt_Meshlet* meshlets, size_t meshlet_count, const unsigned int* meshlet_vertices, const float* vertex_positions)
+{
+	float result = 0;
+
+	for (size_t i = 0; i < meshlet_count; ++i)
+	{
+		float minv[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		float maxv[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+		for (size_t j = 0; j < meshlets[i].vertex_count; ++j)
+		{
+			const float* p = vertex_positions + meshlet_vertices[meshlets[i].vertex_offset + j] * 3;
+
+			for (int k = 0; k < 3; ++k)
+			{
+				minv[k] = p[k] < minv[k] ? p[k] : minv[k];
+				maxv[k] = p[k] > maxv[k] ? p[k] : maxv[k];
+			}
+		}
+
+		float sx = maxv[0] - minv[0], sy = maxv[1] - minv[1], sz = maxv[2] - minv[2];
+		result += sx * sy + sy * sz + sz * sx;
+	}
+
+	return result;
+}
+
+static void meshletsSpatial()
+{
+	const size_t max_vertices = 64;
+	const size_t max_triangles = 64;
+
+	// curved grid so that meshlet boxes have volume
+	float vb[32 * 32][3];
+
+	for (int y = 0; y < 32; ++y)
+		for (int x = 0; x < 32; ++x)
+		{
+			vb[y * 32 + x][0] = float(x);
+			vb[y * 32 + x][1] = float(y);
+			vb[y * 32 + x][2] = float((x - 16) * (x - 16) + (y - 16) * (y - 16)) * 0.05f;
+		}
+
+	std::vector<unsigned int> ib;
+
+	for (int y = 0; y < 31; ++y)
+		for (int x = 0; x < 31; ++x)
+		{
+			unsigned int a = y * 32 + x, b = a + 1, c = a + 32, d = a + 33;
+			unsigned int quad[6] = {a, b, c, c, b, d};
+			ib.insert(ib.end(), quad, quad + 6);
+		}
+
+	size_t max_meshlets = meshopt_buildMeshletsBound(ib.size(), max_vertices, max_triangles);
+
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+
+	size_t regular = meshopt_buildMeshlets(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &ib[0], ib.size(), vb[0], 32 * 32, sizeof(float) * 3, max_vertices, max_triangles, 0.f);
+	float regular_area = meshletBoxArea(&meshlets[0], regular, &meshlet_vertices[0], vb[0]);
+
+	size_t spatial = meshopt_buildMeshletsSpatial(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &ib[0], ib.size(), vb[0], 32 * 32, sizeof(float) * 3, max_vertices, max_triangles);
+	float spatial_area = meshletBoxArea(&meshlets[0], spatial, &meshlet_vertices[0], vb[0]);
+
+	// spatial meshlets should be at least as compact as regular meshlets without the cone term
+	assert(spatial <= regular);
+	assert(spatial_area <= regular_area);
+
+	// every triangle must be emitted exactly once; each triangle is uniquely identified by its two smallest vertices in this grid
+	std::vector<unsigned char> seen(32 * 32 * 32 * 32);
+	size_t triangles = 0;
+
+	for (size_t i = 0; i < spatial; ++i)
+	{
+		const meshopt_Meshlet& m = meshlets[i];
+		assert(m.vertex_count <= max_vertices && m.triangle_count <= max_triangles);
+
+		for (size_t j = 0; j < m.triangle_count; ++j)
+		{
+			unsigned int a = meshlet_vertices[m.vertex_offset + meshlet_triangles[m.triangle_offset + j * 3 + 0]];
+			unsigned int b = meshlet_vertices[m.vertex_offset + meshlet_triangles[m.triangle_offset + j * 3 + 1]];
+			unsigned int c = meshlet_vertices[m.vertex_offset + meshlet_triangles[m.triangle_offset + j * 3 + 2]];
+
+			unsigned int min01 = a < b ? a : b, max01 = a < b ? b : a;
+			unsigned int v0 = min01 < c ? min01 : c;
+			unsigned int v1 = c < min01 ? min01 : (c < max01 ? c : max01);
+
+			assert(!seen[v0 * 32 * 32 + v1]);
+			seen[v0 * 32 * 32 + v1] = 1;
+			triangles++;
+		}
+	}
+
+	assert(triangles == ib.size() / 3);
 }
 
-static void simplifyStuck()
-{
-	// tetrahedron can't be simplified due to collapse error restrictions
-	float vb1[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1};
-	unsigned int ib1[] = {0, 1, 2, 0, 2, 3, 0, 3, 1, 2, 1, 3};
+static void meshletsRegions()
+{
+	const size_t max_vertices = 64;
+	const size_t max_triangles = 64;
+
+	float vb[16 * 16][3];
+
+	for (int y = 0; y < 16; ++y)
+		for (int x = 0; x < 16; ++x)
+		{
+			vb[y * 16 + x][0] = float(x);
+			vb[y * 16 + x][1] = float(y);
+			vb[y * 16 + x][2] = 0.f;
+		}
+
+	unsigned int ib[15 * 15][6];
+
+	for (int y = 0; y < 15; ++y)
+		for (int x = 0; x < 15; ++x)
+		{
+			ib[y * 15 + x][0] = (y + 0) * 16 + (x + 0);
+			ib[y * 15 + x][1] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][2] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][3] = (y + 1) * 16 + (x + 0);
+			ib[y * 15 + x][4] = (y + 0) * 16 + (x + 1);
+			ib[y * 15 + x][5] = (y + 1) * 16 + (x + 1);
+		}
+
+	const size_t index_count = 15 * 15 * 6;
+	const size_t region_triangles = 80;
+
+	unsigned int indices[index_count];
+	unsigned int region_offsets[(index_count / 3 + region_triangles - 1) / region_triangles + 1];
+
+	size_t region_count = meshopt_partitionMeshletRegions(indices, region_offsets, ib[0], index_count, vb[0], 16 * 16, sizeof(float) * 3, region_triangles);
 
-	assert(meshopt_simplify(ib1, ib1, 12, vb1, 4, 12, 6, 1e-3f) == 12);
+	// all regions except the last one are full
+	assert(region_count == 6);
+	assert(region_offsets[0] == 0);
+	assert(region_offsets[region_count] == index_count);
 
-	// 5-vertex strip can't be simplified due to topology restriction since middle triangle has flipped winding
-	float vb2[] = {0, 0, 0, 1, 0, 0, 2, 0, 0, 0.5f, 1, 0, 1.5f, 1, 0};
-	unsigned int ib2[] = {0, 1, 3, 3, 1, 4, 1, 2, 4}; // ok
-	unsigned int ib3[] = {0, 1, 3, 1, 3, 4, 1, 2, 4}; // flipped
+	for (size_t i = 0; i + 1 < region_count; ++i)
+		assert(region_offsets[i + 1] - region_offsets[i] == region_triangles * 3);
 
-	assert(meshopt_simplify(ib2, ib2, 9, vb2, 5, 12, 6, 1e-3f) == 6);
-	assert(meshopt_simplify(ib3, ib3, 9, vb2, 5, 12, 6, 1e-3f) == 9);
+	// each triangle is uniquely identified by its first two vertices in this grid
+	std::vector<unsigned char> seen(256 * 256);
 
-	// 4-vertex quad with a locked corner can't be simplified due to border error-induced restriction
-	float vb4[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0};
-	unsigned int ib4[] = {0, 1, 3, 0, 3, 2};
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		assert(seen[indices[i + 0] * 256 + indices[i + 1]] == 0);
+		seen[indices[i + 0] * 256 + indices[i + 1]] = 1;
+	}
 
-	assert(meshopt_simplify(ib4, ib4, 6, vb4, 4, 12, 3, 1e-3f) == 6);
+	// build meshlets for each region separately and rebase the offsets into shared arrays
+	size_t max_meshlets = 0;
 
-	// 4-vertex quad with a locked corner can't be simplified due to border error-induced restriction
-	float vb5[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 1, 1, 0};
-	unsigned int ib5[] = {0, 1, 4, 0, 3, 2};
+	for (size_t i = 0; i < region_count; ++i)
+		max_meshlets += meshopt_buildMeshletsBound(region_offsets[i + 1] - region_offsets[i], max_vertices, max_triangles);
 
-	assert(meshopt_simplify(ib5, ib5, 6, vb5, 5, 12, 3, 1e-3f) == 6);
-}
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
 
-static void simplifySloppyStuck()
-{
-	const float vb[] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
-	const unsigned int ib[] = {0, 1, 2, 0, 1, 2};
+	size_t meshlet_count = 0;
+	size_t vertex_offset = 0, triangle_offset = 0;
 
-	unsigned int* target = NULL;
+	for (size_t i = 0; i < region_count; ++i)
+	{
+		size_t count = meshopt_buildMeshlets(&meshlets[meshlet_count], &meshlet_vertices[vertex_offset], &meshlet_triangles[triangle_offset], &indices[region_offsets[i]], region_offsets[i + 1] - region_offsets[i], vb[0], 16 * 16, sizeof(float) * 3, max_vertices, max_triangles, 0.f);
 
-	// simplifying down to 0 triangles results in 0 immediately
-	assert(meshopt_simplifySloppy(target, ib, 3, vb, 3, 12, 0, 0.f) == 0);
+		for (size_t j = 0; j < count; ++j)
+		{
+			meshlets[meshlet_count + j].vertex_offset += unsigned(vertex_offset);
+			meshlets[meshlet_count + j].triangle_offset += unsigned(triangle_offset);
+		}
 
-	// simplifying down to 2 triangles given that all triangles are degenerate results in 0 as well
-	assert(meshopt_simplifySloppy(target, ib, 6, vb, 3, 12, 6, 0.f) == 0);
-}
+		const meshopt_Meshlet& last = meshlets[meshlet_count + count - 1];
 
-static void simplifyPointsStuck()
-{
-	const float vb[] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+		vertex_offset = last.vertex_offset + last.vertex_count;
+		triangle_offset = last.triangle_offset + ((last.triangle_count * 3 + 3) & ~3);
+		meshlet_count += count;
+	}
 
-	// simplifying down to 0 points results in 0 immediately
-	assert(meshopt_simplifyPoints(0, vb, 3, 12, 0) == 0);
-}
+	std::vector<meshopt_Meshlet> merged(meshlet_count);
+	std::vector<unsigned int> merged_vertices(vertex_offset);
+	std::vector<unsigned char> merged_triangles(triangle_offset);
 
-static void simplifyFlip()
-{
-	// this mesh has been constructed by taking a tessellated irregular grid with a square cutout
-	// and progressively collapsing edges until the only ones left violate border or flip constraints.
-	// there is only one valid non-flip collapse, so we validate that we take it; when flips are allowed,
-	// the wrong collapse is picked instead.
-	float vb[] = {
-	    1.000000f, 1.000000f, -1.000000f,
-	    1.000000f, 1.000000f, 1.000000f,
-	    1.000000f, -1.000000f, 1.000000f,
-	    1.000000f, -0.200000f, -0.200000f,
-	    1.000000f, 0.200000f, -0.200000f,
-	    1.000000f, -0.200000f, 0.200000f,
-	    1.000000f, 0.200000f, 0.200000f,
-	    1.000000f, 0.500000f, -0.500000f,
-	    1.000000f, -1.000000f, 0.000000f, // clang-format :-/
-	};
+	size_t merged_count = meshopt_mergeMeshlets(&merged[0], &merged_vertices[0], &merged_triangles[0], &meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], meshlet_count, 16 * 16, max_vertices, max_triangles);
 
-	// the collapse we expect is 7 -> 0
-	unsigned int ib[] = {
-	    7, 4, 3,
-	    1, 2, 5,
-	    7, 1, 6,
-	    7, 8, 0, // gets removed
-	    7, 6, 4,
-	    8, 5, 2,
-	    8, 7, 3,
-	    8, 3, 5,
-	    5, 6, 1,
-	    7, 0, 1, // gets removed
-	};
+	assert(merged_count < meshlet_count);
 
-	unsigned int expected[] = {
-	    0, 4, 3,
-	    1, 2, 5,
-	    0, 1, 6,
-	    0, 6, 4,
-	    8, 5, 2,
-	    8, 0, 3,
-	    8, 3, 5,
-	    5, 6, 1, // clang-format :-/
-	};
+	// merged meshlets must respect the limits and cover every triangle exactly once
+	for (size_t i = 0; i < merged_count; ++i)
+	{
+		const meshopt_Meshlet& m = merged[i];
 
-	assert(meshopt_simplify(ib, ib, 30, vb, 9, 12, 3, 1e-3f) == 24);
-	assert(memcmp(ib, expected, sizeof(expected)) == 0);
-}
+		assert(m.vertex_count <= max_vertices);
+		assert(m.triangle_count <= max_triangles);
+		assert(m.vertex_offset + m.vertex_count <= vertex_offset);
+		assert(m.triangle_offset + m.triangle_count * 3 <= triangle_offset);
 
-static void simplifyScale()
-{
-	const float vb[] = {0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 3};
+		for (size_t j = 0; j < m.triangle_count * 3; j += 3)
+		{
+			unsigned int a = merged_vertices[m.vertex_offset + merged_triangles[m.triangle_offset + j + 0]];
+			unsigned int b = merged_vertices[m.vertex_offset + merged_triangles[m.triangle_offset + j + 1]];
 
-	assert(meshopt_simplifyScale(vb, 4, 12) == 3.f);
+			assert(seen[a * 256 + b] == 1);
+			seen[a * 256 + b] = 2;
+		}
+	}
+
+	for (size_t i = 0; i < index_count; i += 3)
+		assert(seen[indices[i + 0] * 256 + indices[i + 1]] == 2);
 }
 
-static void simplifyDegenerate()
+static void meshletsMerge()
 {
-	float vb[] = {
-	    0.000000f, 0.000000f, 0.000000f,
-	    0.000000f, 1.000000f, 0.000000f,
-	    0.000000f, 2.000000f, 0.000000f,
-	    1.000000f, 0.000000f, 0.000000f,
-	    2.000000f, 0.000000f, 0.000000f,
-	    1.000000f, 1.000000f, 0.000000f, // clang-format :-/
-	};
+	// two meshlets with one triangle each, sharing an edge
+	const meshopt_Meshlet meshlets[2] = {{0, 0, 3, 1}, {3, 4, 3, 1}};
+	const unsigned int meshlet_vertices[6] = {0, 1, 2, 2, 1, 3};
+	const unsigned char meshlet_triangles[8] = {0, 1, 2, 0, 0, 1, 2, 0};
 
-	// 0 1 2
-	// 3 5
-	// 4
+	meshopt_Meshlet merged[2];
+	unsigned int merged_vertices[6];
+	unsigned char merged_triangles[8];
 
-	unsigned int ib[] = {
-	    0, 1, 3,
-	    3, 1, 5,
-	    1, 2, 5,
-	    3, 5, 4,
-	    1, 0, 1, // these two degenerate triangles create a fake reverse edge
-	    0, 3, 0, // which breaks border classification
-	};
+	assert(meshopt_mergeMeshlets(merged, merged_vertices, merged_triangles, meshlets, meshlet_vertices, meshlet_triangles, 2, 4, 64, 64) == 1);
 
-	unsigned int expected[] = {
-	    0, 1, 4,
-	    4, 1, 2, // clang-format :-/
-	};
+	assert(merged[0].vertex_offset == 0 && merged[0].vertex_count == 4);
+	assert(merged[0].triangle_offset == 0 && merged[0].triangle_count == 2);
 
-	assert(meshopt_simplify(ib, ib, 18, vb, 6, 12, 3, 1e-3f) == 6);
-	assert(memcmp(ib, expected, sizeof(expected)) == 0);
+	const unsigned int expected_vertices[4] = {0, 1, 2, 3};
+	const unsigned char expected_triangles[8] = {0, 1, 2, 2, 1, 3, 0, 0};
+
+	assert(memcmp(merged_vertices, expected_vertices, sizeof(expected_vertices)) == 0);
+	assert(memcmp(merged_triangles, expected_triangles, sizeof(expected_triangles)) == 0);
+
+	// meshlets that do not fit together are copied as is
+	assert(meshopt_mergeMeshlets(merged, merged_vertices, merged_triangles, meshlets, meshlet_vertices, meshlet_triangles, 2, 4, 3, 4) == 2);
+	assert(merged[1].vertex_offset == 3 && merged[1].vertex_count == 3);
+	assert(merged[1].triangle_offset == 4 && merged[1].triangle_count == 1);
 }
 
-static void simplifyLockBorder()
+static void meshletsOptimize()
 {
-	float vb[] = {
-	    0.000000f, 0.000000f, 0.000000f,
-	    0.000000f, 1.000000f, 0.000000f,
-	    0.000000f, 2.000000f, 0.000000f,
-	    1.000000f, 0.000000f, 0.000000f,
-	    1.000000f, 1.000000f, 0.000000f,
-	    1.000000f, 2.000000f, 0.000000f,
-	    2.000000f, 0.000000f, 0.000000f,
-	    2.000000f, 1.000000f, 0.000000f,
-	    2.000000f, 2.000000f, 0.000000f, // clang-format :-/
-	};
+	// 6x6 grid of vertices; triangles are emitted in a strided order that is bad for vertex reuse
+	unsigned int meshlet_vertices[36];
+	unsigned char meshlet_triangles[5 * 5 * 6];
 
-	// 0 1 2
-	// 3 4 5
-	// 6 7 8
+	for (int i = 0; i < 36; ++i)
+		meshlet_vertices[i] = 100 + ((i * 7) % 36);
 
-	unsigned int ib[] = {
-	    0, 1, 3,
-	    3, 1, 4,
-	    1, 2, 4,
-	    4, 2, 5,
-	    3, 4, 6,
-	    6, 4, 7,
-	    4, 5, 7,
-	    7, 5, 8, // clang-format :-/
-	};
+	size_t triangle_count = 0;
 
-	unsigned int expected[] = {
-	    0, 1, 3,
-	    1, 2, 3,
-	    3, 2, 5,
-	    6, 3, 7,
-	    3, 5, 7,
-	    7, 5, 8, // clang-format :-/
-	};
+	for (int s = 0; s < 3; ++s)
+		for (int q = s; q < 25; q += 3)
+		{
+			int x = q % 5, y = q / 5;
 
-	assert(meshopt_simplify(ib, ib, 24, vb, 9, 12, 3, 1e-3f, meshopt_SimplifyLockBorder) == 18);
-	assert(memcmp(ib, expected, sizeof(expected)) == 0);
+			unsigned char a = (unsigned char)(y * 6 + x), b = (unsigned char)(a + 1), c = (unsigned char)(a + 6), d = (unsigned char)(a + 7);
+			unsigned char tri[6] = {a, b, c, c, b, d};
+
+			memcpy(&meshlet_triangles[triangle_count * 3], tri, 6);
+			triangle_count += 2;
+		}
+
+	assert(triangle_count == 50);
+
+	// remember triangles in terms of global vertex indices
+	std::vector<unsigned int> expected;
+
+	for (size_t i = 0; i < triangle_count * 3; ++i)
+		expected.push_back(meshlet_vertices[meshlet_triangles[i]]);
+
+	meshopt_Meshlet meshlet = {0, 0, 36, 50};
+
+	meshopt_VertexCacheStatistics before = meshopt_analyzeMeshletCache(&meshlet, 1, meshlet_triangles, 16);
+
+	meshopt_optimizeMeshlet(meshlet_vertices, meshlet_triangles, triangle_count, 36);
+
+	meshopt_VertexCacheStatistics after = meshopt_analyzeMeshletCache(&meshlet, 1, meshlet_triangles, 16);
+
+	assert(after.vertices_transformed < before.vertices_transformed);
+	assert(after.warps_executed == 1);
+
+	// vertices must be renumbered in the order of first use
+	unsigned int next = 0;
+
+	for (size_t i = 0; i < triangle_count * 3; ++i)
+	{
+		assert(meshlet_triangles[i] <= next);
+		next += meshlet_triangles[i] == next;
+	}
+
+	assert(next == 36);
+
+	// every triangle must still be present, with the same winding
+	for (size_t i = 0; i < triangle_count; ++i)
+	{
+		unsigned int a = meshlet_vertices[meshlet_triangles[i * 3 + 0]], b = meshlet_vertices[meshlet_triangles[i * 3 + 1]], c = meshlet_vertices[meshlet_triangles[i * 3 + 2]];
+
+		bool found = false;
+
+		for (size_t j = 0; j < expected.size(); j += 3)
+			if ((expected[j] == a && expected[j + 1] == b && expected[j + 2] == c) ||
+			    (expected[j] == b && expected[j + 1] == c && expected[j + 2] == a) ||
+			    (expected[j] == c && expected[j + 1] == a && expected[j + 2] == b))
+			{
+				expected[j] = expected[j + 1] = expected[j + 2] = ~0u;
+				found = true;
+				break;
+			}
+
+		assert(found);
+	}
 }
 
-static void adjacency()
+static void meshletsBoundsBatch()
 {
-	// 0 1/4
-	// 2/5 3
-	const float vb[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 0, 1, 0};
-	const unsigned int ib[] = {0, 1, 2, 5, 4, 3};
+	const size_t max_vertices = 64;
+	const size_t max_triangles = 64;
 
-	unsigned int adjib[12];
-	meshopt_generateAdjacencyIndexBuffer(adjib, ib, 6, vb, 6, 12);
+	float vb[16 * 16][3];
 
-	unsigned int expected[] = {
-	    // patch 0
-	    0, 0,
-	    1, 3,
-	    2, 2,
+	for (int y = 0; y < 16; ++y)
+		for (int x = 0; x < 16; ++x)
+		{
+			vb[y * 16 + x][0] = float(x);
+			vb[y * 16 + x][1] = float(y);
+			vb[y * 16 + x][2] = float((x * 3 + y * 5) % 4) * 0.25f;
+		}
 
-	    // patch 1
-	    5, 0,
-	    4, 4,
-	    3, 3,
+	// every 7th quad has an extra degenerate triangle that must be ignored
+	std::vector<unsigned int> ib;
 
-	    // clang-format :-/
-	};
+	for (int y = 0; y < 15; ++y)
+		for (int x = 0; x < 15; ++x)
+		{
+			unsigned int a = y * 16 + x, b = a + 1, c = a + 16, d = a + 17;
+			unsigned int quad[6] = {a, b, c, c, b, d};
+			ib.insert(ib.end(), quad, quad + 6);
+
+			if ((y * 15 + x) % 7 == 0)
+			{
+				unsigned int degenerate[3] = {a, a, b};
+				ib.insert(ib.end(), degenerate, degenerate + 3);
+			}
+		}
 
-	assert(memcmp(adjib, expected, sizeof(expected)) == 0);
+	size_t max_meshlets = meshopt_buildMeshletsBound(ib.size(), max_vertices, max_triangles);
+
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+
+	meshlets.resize(meshopt_buildMeshlets(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &ib[0], ib.size(), vb[0], 16 * 16, sizeof(float) * 3, max_vertices, max_triangles, 0.f));
+
+	std::vector<meshopt_Bounds> bounds(meshlets.size());
+	meshopt_computeMeshletBoundsBatch(&bounds[0], &meshlets[0], meshlets.size(), &meshlet_vertices[0], &meshlet_triangles[0], vb[0], 16 * 16, sizeof(float) * 3);
+
+	for (size_t i = 0; i < meshlets.size(); ++i)
+	{
+		const meshopt_Meshlet& m = meshlets[i];
+		meshopt_Bounds expected = meshopt_computeMeshletBounds(&meshlet_vertices[m.vertex_offset], &meshlet_triangles[m.triangle_offset], m.triangle_count, vb[0], 16 * 16, sizeof(float) * 3);
+
+		// the normal cone doesn't depend on the sphere so it must match exactly, apart from the apex
+		assert(memcmp(bounds[i].cone_axis, expected.cone_axis, sizeof(expected.cone_axis)) == 0);
+		assert(bounds[i].cone_cutoff == expected.cone_cutoff);
+		assert(memcmp(bounds[i].cone_axis_s8, expected.cone_axis_s8, sizeof(expected.cone_axis_s8)) == 0);
+		assert(bounds[i].cone_cutoff_s8 == expected.cone_cutoff_s8);
+
+		// the sphere may differ slightly but must contain all meshlet vertices
+		assert(fabsf(bounds[i].radius - expected.radius) < 1e-1f);
+
+		for (size_t j = 0; j < m.vertex_count; ++j)
+		{
+			const float* p = vb[meshlet_vertices[m.vertex_offset + j]];
+			float d2 = (p[0] - bounds[i].center[0]) * (p[0] - bounds[i].center[0]) + (p[1] - bounds[i].center[1]) * (p[1] - bounds[i].center[1]) + (p[2] - bounds[i].center[2]) * (p[2] - bounds[i].center[2]);
+
+			assert(sqrtf(d2) <= bounds[i].radius * 1.0001f);
+		}
+	}
 }
 
-static void tessellation()
+static void collectBVHMeshlets(std::vector<unsigned int>& result, const meshopt_MeshletBVHNode* nodes, unsigned int node, const unsigned int* meshlet_indices)
 {
-	// 0 1/4
-	// 2/5 3
-	const float vb[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 0, 1, 0};
-	const unsigned int ib[] = {0, 1, 2, 5, 4, 3};
+	if (nodes[node].leaf)
+		result.insert(result.end(), meshlet_indices + nodes[node].offset, meshlet_indices + nodes[node].offset + nodes[node].count);
+	else
+		for (unsigned int i = 0; i < nodes[node].count; ++i)
+			collectBVHMeshlets(result, nodes, nodes[node].offset + i, meshlet_indices);
+}
 
-	unsigned int tessib[24];
-	meshopt_generateTessellationIndexBuffer(tessib, ib, 6, vb, 6, 12);
+static void meshletsBVH()
+{
+	const size_t meshlet_count = 100;
 
-	unsigned int expected[] = {
-	    // patch 0
-	    0, 1, 2,
-	    0, 1,
-	    4, 5,
-	    2, 0,
-	    0, 1, 2,
+	std::vector<meshopt_Bounds> bounds(meshlet_count);
 
-	    // patch 1
-	    5, 4, 3,
-	    2, 1,
-	    4, 3,
-	    3, 5,
-	    2, 1, 3,
+	for (size_t i = 0; i < meshlet_count; ++i)
+	{
+		meshopt_Bounds& b = bounds[i];
+		memset(&b, 0, sizeof(b));
+
+		// every 17th meshlet is degenerate and has zero bounds
+		if (i % 17 == 16)
+			continue;
+
+		b.center[0] = float(i % 10) * 2.f;
+		b.center[1] = float(i / 10) * 2.f;
+		b.center[2] = float((i * 7) % 5) * 0.5f;
+		b.radius = 1.f + float(i % 3) * 0.5f;
+
+		// cones point mostly towards +z with varying tilt and spread
+		float ax = float(int(i % 5) - 2) * 0.1f, ay = float(int(i % 3) - 1) * 0.1f;
+		float al = sqrtf(ax * ax + ay * ay + 1.f);
+
+		b.cone_axis[0] = ax / al;
+		b.cone_axis[1] = ay / al;
+		b.cone_axis[2] = 1.f / al;
+		b.cone_cutoff = (i % 11 == 0) ? 1.f : 0.2f + float(i % 4) * 0.1f;
+	}
 
-	    // clang-format :-/
-	};
+	for (int sah = 0; sah < 2; ++sah)
+		for (size_t node_width = 2; node_width <= 8; node_width *= 2)
+			for (size_t leaf_size = 1; leaf_size <= 4; leaf_size += 3)
+			{
+				std::vector<meshopt_MeshletBVHNode> nodes(meshlet_count * 2 - 1);
+				std::vector<unsigned int> meshlet_indices(meshlet_count);
 
-	assert(memcmp(tessib, expected, sizeof(expected)) == 0);
+				size_t node_count = meshopt_buildMeshletBVH(&nodes[0], &meshlet_indices[0], &bounds[0], meshlet_count, node_width, leaf_size, sah ? meshopt_MeshletBVHSAH : 0);
+				assert(node_count > 1 && node_count <= nodes.size());
+
+				// leaves must reference every meshlet exactly once
+				std::vector<unsigned int> all;
+				collectBVHMeshlets(all, &nodes[0], 0, &meshlet_indices[0]);
+				assert(all.size() == meshlet_count);
+
+				std::vector<unsigned char> seen(meshlet_count);
+				for (size_t i = 0; i < all.size(); ++i)
+				{
+					assert(all[i] < meshlet_count && !seen[all[i]]);
+					seen[all[i]] = 1;
+				}
+
+				for (size_t n = 0; n < node_count; ++n)
+				{
+					const meshopt_MeshletBVHNode& node = nodes[n];
+
+					assert(node.leaf ? node.count <= leaf_size : (node.count >= 2 && node.count <= node_width && node.offset + node.count <= node_count));
+
+					std::vector<unsigned int> subtree;
+					collectBVHMeshlets(subtree, &nodes[0], unsigned(n), &meshlet_indices[0]);
+
+					for (size_t i = 0; i < subtree.size(); ++i)
+					{
+						const meshopt_Bounds& b = bounds[subtree[i]];
+
+						if (b.radius == 0)
+							continue;
+
+						// node sphere must contain all meshlet spheres
+						float d = sqrtf((b.center[0] - node.center[0]) * (b.center[0] - node.center[0]) + (b.center[1] - node.center[1]) * (b.center[1] - node.center[1]) + (b.center[2] - node.center[2]) * (b.center[2] - node.center[2]));
+						assert(d + b.radius <= node.radius * 1.0001f);
+
+						// if the node cone rejects a view direction, all meshlet cones must reject it as well
+						for (int v = 0; v < 64; ++v)
+						{
+							float vx = float(v % 4) * 0.2f - 0.3f, vy = float((v / 4) % 4) * 0.2f - 0.3f, vz = float(v / 16) * 0.5f - 0.5f;
+							float vl = sqrtf(vx * vx + vy * vy + vz * vz);
+
+							bool node_reject = vx * (node.cone_axis_s8[0] / 127.f) + vy * (node.cone_axis_s8[1] / 127.f) + vz * (node.cone_axis_s8[2] / 127.f) >= (node.cone_cutoff_s8 / 127.f) * vl;
+							bool meshlet_reject = vx * b.cone_axis[0] + vy * b.cone_axis[1] + vz * b.cone_axis[2] >= b.cone_cutoff * vl;
+
+							assert(!node_reject || meshlet_reject);
+						}
+					}
+				}
+
+				// root can't be backface culled since some meshlets have no cone, but subtrees without such meshlets can
+				assert(nodes[0].cone_cutoff_s8 == 127);
+
+				size_t culled = 0;
+				for (size_t n = 0; n < node_count; ++n)
+					culled += nodes[n].cone_cutoff_s8 < 127;
+
+				assert(culled > 0);
+			}
 }
 
 void runTests()
@@ -1129,18 +3132,48 @@ void runTests()
 	encodeFilterExp();
 
 	clusterBoundsDegenerate();
+	meshletsCancel();
+	meshletsRegions();
+	meshletsSpatial();
+	meshletsMerge();
+	meshletsOptimize();
+	meshletsBoundsBatch();
+	meshletsBVH();
 
 	customAllocator();
-
+	contextScratch();
+	contextNested();
+	contextAllocator();
+	contextStats();
+	tracer();
+
+	optimizeVertexCacheTable();
+	optimizeVertexCacheChunked();
+	optimizeMesh();
+	analyzeVertexCacheMulti();
+	analyzeOverdrawMulti();
+	optimizeOverdrawMulti();
+	analyzeVertexFetchMulti();
+	optimizeVertexFetchRemapShadow();
 	emptyMesh();
 
 	simplifyStuck();
 	simplifySloppyStuck();
+	simplifySloppyGrid();
 	simplifyPointsStuck();
+	simplifyPointsCenter();
+	simplifyPointsColor();
+	simplifyPointHierarchy();
 	simplifyFlip();
 	simplifyScale();
 	simplifyDegenerate();
 	simplifyLockBorder();
+	simplifyAttr();
+	simplifyCancel();
+	simplifyProgressive();
+	simplifyProgressiveSeams();
+	simplifyErrors();
+	simplifyExactOrder();
 
 	adjacency();
 	tessellation();
@@ -573,24 +573,21 @@ static void optimizeMesh(Mesh& mesh, bool compressmore)
 
 	size_t vertex_count = mesh.streams[0].data.size();
 
-	if (compressmore)
-		meshopt_optimizeVertexCacheStrip(&mesh.indices[0], &mesh.indices[0], mesh.indices.size(), vertex_count);
-	else
-		meshopt_optimizeVertexCache(&mesh.indices[0], &mesh.indices[0], mesh.indices.size(), vertex_count);
-
-	std::vector<unsigned int> remap(vertex_count);
-	size_t unique_vertices = meshopt_optimizeVertexFetchRemap(&remap[0], &mesh.indices[0], mesh.indices.size(), vertex_count);
-	assert(unique_vertices <= vertex_count);
-
-	meshopt_remapIndexBuffer(&mesh.indices[0], &mesh.indices[0], mesh.indices.size(), &remap[0]);
+	std::vector<void*> streams(mesh.streams.size());
+	std::vector<size_t> stream_sizes(mesh.streams.size(), sizeof(Attr));
 
 	for (size_t i = 0; i < mesh.streams.size(); ++i)
 	{
 		assert(mesh.streams[i].data.size() == vertex_count);
 
-		meshopt_remapVertexBuffer(&mesh.streams[i].data[0], &mesh.streams[i].data[0], vertex_count, sizeof(Attr), &remap[0]);
-		mesh.streams[i].data.resize(unique_vertices);
+		streams[i] = &mesh.streams[i].data[0];
 	}
+
+	size_t unique_vertices = meshopt_optimizeMesh(&mesh.indices[0], mesh.indices.size(), NULL, vertex_count, 0, &streams[0], &stream_sizes[0], streams.size(), compressmore ? meshopt_OptimizeMeshStrip : 0, 1.05f);
+	assert(unique_vertices <= vertex_count);
+
+	for (size_t i = 0; i < mesh.streams.size(); ++i)
+		mesh.streams[i].data.resize(unique_vertices);
 }
 
 struct BoneInfluence
@@ -707,8 +704,13 @@ static void simplifyPointMesh(Mesh& mesh, float threshold)
 	if (target_vertex_count < 1)
 		return;
 
+	const Stream* colors = getStream(mesh, cgltf_attribute_type_color);
+
+	// positions are measured in units of point cloud extent, so a small weight keeps color as a secondary criterion within each cell
+	const float color_weight = 1e-2f;
+
 	std::vector<unsigned int> indices(target_vertex_count);
-	indices.resize(meshopt_simplifyPoints(&indices[0], positions->data[0].f, vertex_count, sizeof(Attr), target_vertex_count));
+	indices.resize(meshopt_simplifyPoints(&indices[0], positions->data[0].f, vertex_count, sizeof(Attr), colors ? colors->data[0].f : NULL, sizeof(Attr), color_weight, target_vertex_count));
 
 	std::vector<Attr> scratch(indices.size());
 
@@ -1,8 +1,68 @@
 // This file is part of meshoptimizer library; see meshoptimizer.h for version/license details
 #include "meshoptimizer.h"
 
+#include <time.h>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
 void meshopt_setAllocator(void* (MESHOPTIMIZER_ALLOC_CALLCONV *allocate)(size_t), void (MESHOPTIMIZER_ALLOC_CALLCONV *deallocate)(void*))
 {
 	meshopt_Allocator::Storage::allocate = allocate;
 	meshopt_Allocator::Storage::deallocate = deallocate;
 }
+
+void meshopt_setTracer(void (*begin)(void*, const char*), void (*end)(void*, const char*), void (*counter)(void*, const char*, double), void* userdata)
+{
+	meshopt_Tracer::Storage::begin = begin;
+	meshopt_Tracer::Storage::end = end;
+	meshopt_Tracer::Storage::counter = counter;
+	meshopt_Tracer::Storage::userdata = userdata;
+}
+
+void meshopt_freeContext(meshopt_Context* context)
+{
+	if (context->scratch)
+		meshopt_Allocator::deallocateRaw(context, context->scratch);
+
+	context->scratch = 0;
+	context->scratch_size = 0;
+	context->scratch_used = 0;
+	context->scratch_peak = 0;
+	context->call_depth = 0;
+}
+
+#if defined(_WIN32)
+double meshopt_Allocator::timestamp()
+{
+	// counter frequency is fixed at boot, so we query it once; racing first calls store the same value
+	static double period = 0;
+
+	if (period == 0)
+	{
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency(&freq);
+		period = 1.0 / double(freq.QuadPart);
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return double(counter.QuadPart) * period;
+}
+#elif defined(__unix__) || defined(__APPLE__)
+double meshopt_Allocator::timestamp()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return double(ts.tv_sec) + 1e-9 * double(ts.tv_nsec);
+}
+#else
+double meshopt_Allocator::timestamp()
+{
+	return double(clock()) / double(CLOCKS_PER_SEC);
+}
+#endif
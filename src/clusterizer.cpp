@@ -6,10 +6,30 @@
 #include <math.h>
 #include <string.h>
 
+// The block below auto-detects SIMD ISA that can be used on the target platform
+#ifndef MESHOPTIMIZER_NO_SIMD
+
+// The SIMD implementation requires SSE2, which can be enabled unconditionally through compiler settings
+#if defined(__SSE2__)
+#define SIMD_SSE
+#endif
+
+// MSVC supports compiling SSE2 code regardless of compile options; we assume all 32-bit CPUs support SSE2
+#if !defined(SIMD_SSE) && defined(_MSC_VER) && !defined(__clang__) && (defined(_M_IX86) || defined(_M_X64))
+#define SIMD_SSE
+#endif
+
+#endif // !MESHOPTIMIZER_NO_SIMD
+
+#ifdef SIMD_SSE
+#include <emmintrin.h>
+#endif
+
 // This work is based on:
 // Graham Wihlidal. Optimizing the Graphics Pipeline with Compute. 2016
 // Matthaeus Chajdas. GeometryFX 1.2 - Cluster Culling. 2016
 // Jack Ritter. An Efficient Bounding Sphere. 1990
+// Ingo Wald. On fast Construction of SAH-based Bounding Volume Hierarchies. 2007
 namespace meshopt
 {
 
@@ -19,6 +39,20 @@ const size_t kMeshletMaxVertices = 255;
 // A reasonable limit is around 2*max_vertices or less
 const size_t kMeshletMaxTriangles = 512;
 
+// Size of the FIFO vertex cache that meshopt_optimizeMeshlet optimizes for; see meshopt_analyzeMeshletCache
+const unsigned int kMeshletCacheSize = 16;
+
+// Meshlet BVH nodes have at most this many children
+const size_t kMeshletBVHMaxWidth = 8;
+
+// Number of bins per axis used to evaluate SAH splits, and the depth after which we fall back to median splits
+const size_t kMeshletBVHBins = 16;
+const unsigned int kMeshletBVHMaxSAHDepth = 32;
+
+// Weight of squared distance to the meshlet center relative to meshlet box area when building spatial meshlets; both are squared lengths
+// Ranking by area alone, with distance only breaking exact ties, results in larger boxes overall on typical meshes
+const float kMeshletSpatialDistanceWeight = 0.5f;
+
 struct TriangleAdjacency2
 {
 	unsigned int* counts;
@@ -75,7 +109,42 @@ static void buildTriangleAdjacency(TriangleAdjacency2& adjacency, const unsigned
 	}
 }
 
-static void computeBoundingSphere(float result[4], const float points[][3], size_t count)
+#ifdef SIMD_SSE
+static float hminSSE(__m128 v)
+{
+	v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+	v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+	return _mm_cvtss_f32(v);
+}
+
+static float hmaxSSE(__m128 v)
+{
+	v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+	v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+	return _mm_cvtss_f32(v);
+}
+#endif
+
+static void growBoundingSphere(float center[3], float& radius, float x, float y, float z)
+{
+	float d2 = (x - center[0]) * (x - center[0]) + (y - center[1]) * (y - center[1]) + (z - center[2]) * (z - center[2]);
+
+	if (d2 > radius * radius)
+	{
+		float d = sqrtf(d2);
+		assert(d > 0);
+
+		float k = 0.5f + (radius / d) / 2;
+
+		center[0] = center[0] * k + x * (1 - k);
+		center[1] = center[1] * k + y * (1 - k);
+		center[2] = center[2] * k + z * (1 - k);
+		radius = (radius + d) / 2;
+	}
+}
+
+// points are stored in SoA layout: points[axis][index]
+static void computeBoundingSphere(float result[4], const float* const points[3], size_t count)
 {
 	assert(count > 0);
 
@@ -83,15 +152,44 @@ static void computeBoundingSphere(float result[4], const float points[][3], size
 	size_t pmin[3] = {0, 0, 0};
 	size_t pmax[3] = {0, 0, 0};
 
-	for (size_t i = 0; i < count; ++i)
+	for (int axis = 0; axis < 3; ++axis)
 	{
-		const float* p = points[i];
+		const float* v = points[axis];
+
+		float vmin = v[0], vmax = v[0];
+		size_t i = 0;
+
+#ifdef SIMD_SSE
+		if (count >= 4)
+		{
+			__m128 smin = _mm_loadu_ps(v);
+			__m128 smax = smin;
+
+			for (i = 4; i + 4 <= count; i += 4)
+			{
+				__m128 sv = _mm_loadu_ps(v + i);
+
+				smin = _mm_min_ps(smin, sv);
+				smax = _mm_max_ps(smax, sv);
+			}
 
-		for (int axis = 0; axis < 3; ++axis)
+			vmin = hminSSE(smin);
+			vmax = hmaxSSE(smax);
+		}
+#endif
+
+		for (; i < count; ++i)
 		{
-			pmin[axis] = (p[axis] < points[pmin[axis]][axis]) ? i : pmin[axis];
-			pmax[axis] = (p[axis] > points[pmax[axis]][axis]) ? i : pmax[axis];
+			vmin = (v[i] < vmin) ? v[i] : vmin;
+			vmax = (v[i] > vmax) ? v[i] : vmax;
 		}
+
+		// the first point with the extremum value is the one a sequential search would pick
+		while (v[pmin[axis]] != vmin)
+			pmin[axis]++;
+
+		while (v[pmax[axis]] != vmax)
+			pmax[axis]++;
 	}
 
 	// find the pair of points with largest distance
@@ -100,10 +198,10 @@ static void computeBoundingSphere(float result[4], const float points[][3], size
 
 	for (int axis = 0; axis < 3; ++axis)
 	{
-		const float* p1 = points[pmin[axis]];
-		const float* p2 = points[pmax[axis]];
+		size_t p1 = pmin[axis], p2 = pmax[axis];
 
-		float d2 = (p2[0] - p1[0]) * (p2[0] - p1[0]) + (p2[1] - p1[1]) * (p2[1] - p1[1]) + (p2[2] - p1[2]) * (p2[2] - p1[2]);
+		float dx = points[0][p2] - points[0][p1], dy = points[1][p2] - points[1][p1], dz = points[2][p2] - points[2][p1];
+		float d2 = dx * dx + dy * dy + dz * dz;
 
 		if (d2 > paxisd2)
 		{
@@ -113,31 +211,33 @@ static void computeBoundingSphere(float result[4], const float points[][3], size
 	}
 
 	// use the longest segment as the initial sphere diameter
-	const float* p1 = points[pmin[paxis]];
-	const float* p2 = points[pmax[paxis]];
+	size_t p1 = pmin[paxis], p2 = pmax[paxis];
 
-	float center[3] = {(p1[0] + p2[0]) / 2, (p1[1] + p2[1]) / 2, (p1[2] + p2[2]) / 2};
+	float center[3] = {(points[0][p1] + points[0][p2]) / 2, (points[1][p1] + points[1][p2]) / 2, (points[2][p1] + points[2][p2]) / 2};
 	float radius = sqrtf(paxisd2) / 2;
 
 	// iteratively adjust the sphere up until all points fit
-	for (size_t i = 0; i < count; ++i)
-	{
-		const float* p = points[i];
-		float d2 = (p[0] - center[0]) * (p[0] - center[0]) + (p[1] - center[1]) * (p[1] - center[1]) + (p[2] - center[2]) * (p[2] - center[2]);
+	size_t i = 0;
 
-		if (d2 > radius * radius)
-		{
-			float d = sqrtf(d2);
-			assert(d > 0);
+#ifdef SIMD_SSE
+	// most points are inside the sphere, so we only need to process groups of 4 sequentially if at least one point is outside
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(points[0] + i), _mm_set1_ps(center[0]));
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(points[1] + i), _mm_set1_ps(center[1]));
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(points[2] + i), _mm_set1_ps(center[2]));
+		__m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
 
-			float k = 0.5f + (radius / d) / 2;
+		if (_mm_movemask_ps(_mm_cmpgt_ps(d2, _mm_set1_ps(radius * radius))) == 0)
+			continue;
 
-			center[0] = center[0] * k + p[0] * (1 - k);
-			center[1] = center[1] * k + p[1] * (1 - k);
-			center[2] = center[2] * k + p[2] * (1 - k);
-			radius = (radius + d) / 2;
-		}
+		for (size_t j = i; j < i + 4; ++j)
+			growBoundingSphere(center, radius, points[0][j], points[1][j], points[2][j]);
 	}
+#endif
+
+	for (; i < count; ++i)
+		growBoundingSphere(center, radius, points[0][i], points[1][i], points[2][i]);
 
 	result[0] = center[0];
 	result[1] = center[1];
@@ -145,6 +245,140 @@ static void computeBoundingSphere(float result[4], const float points[][3], size
 	result[3] = radius;
 }
 
+static void quantizeCone(signed char axis_s8[3], signed char& cutoff_s8, const float axis[3], float cutoff)
+{
+	// quantize axis & cutoff to 8-bit SNORM format
+	axis_s8[0] = (signed char)(meshopt_quantizeSnorm(axis[0], 8));
+	axis_s8[1] = (signed char)(meshopt_quantizeSnorm(axis[1], 8));
+	axis_s8[2] = (signed char)(meshopt_quantizeSnorm(axis[2], 8));
+
+	// for the 8-bit test to be conservative, we need to adjust the cutoff by measuring the max. error
+	float axis_s8_e0 = fabsf(axis_s8[0] / 127.f - axis[0]);
+	float axis_s8_e1 = fabsf(axis_s8[1] / 127.f - axis[1]);
+	float axis_s8_e2 = fabsf(axis_s8[2] / 127.f - axis[2]);
+
+	// note that we need to round this up instead of rounding to nearest, hence +1
+	int cutoff_i8 = int(127 * (cutoff + axis_s8_e0 + axis_s8_e1 + axis_s8_e2) + 1);
+
+	cutoff_s8 = (cutoff_i8 > 127) ? 127 : (signed char)(cutoff_i8);
+}
+
+// normals and origins (corner 0 of each triangle, used to compute plane equations) are stored in SoA layout
+static void computeClusterCone(meshopt_Bounds& bounds, const float psphere[4], const float* const normals[3], const float* const origins[3], size_t triangles)
+{
+	float center[3] = {psphere[0], psphere[1], psphere[2]};
+
+	// treating triangle normals as points, find the bounding sphere - the sphere center determines the optimal cone axis
+	float nsphere[4] = {};
+	computeBoundingSphere(nsphere, normals, triangles);
+
+	float axis[3] = {nsphere[0], nsphere[1], nsphere[2]};
+	float axislength = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	float invaxislength = axislength == 0.f ? 0.f : 1.f / axislength;
+
+	axis[0] *= invaxislength;
+	axis[1] *= invaxislength;
+	axis[2] *= invaxislength;
+
+	// compute a tight cone around all normals, mindp = cos(angle/2)
+	float mindp = 1.f;
+	size_t i = 0;
+
+#ifdef SIMD_SSE
+	__m128 smindp = _mm_set1_ps(1.f);
+
+	for (; i + 4 <= triangles; i += 4)
+	{
+		__m128 dp = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(normals[0] + i), _mm_set1_ps(axis[0])), _mm_mul_ps(_mm_loadu_ps(normals[1] + i), _mm_set1_ps(axis[1]))), _mm_mul_ps(_mm_loadu_ps(normals[2] + i), _mm_set1_ps(axis[2])));
+
+		smindp = _mm_min_ps(smindp, dp);
+	}
+
+	mindp = hminSSE(smindp);
+#endif
+
+	for (; i < triangles; ++i)
+	{
+		float dp = normals[0][i] * axis[0] + normals[1][i] * axis[1] + normals[2][i] * axis[2];
+
+		mindp = (dp < mindp) ? dp : mindp;
+	}
+
+	// fill bounding sphere info; note that below we can return bounds without cone information for degenerate cones
+	bounds.center[0] = center[0];
+	bounds.center[1] = center[1];
+	bounds.center[2] = center[2];
+	bounds.radius = psphere[3];
+
+	// degenerate cluster, normal cone is larger than a hemisphere => trivial accept
+	// note that if mindp is positive but close to 0, the triangle intersection code below gets less stable
+	// we arbitrarily decide that if a normal cone is ~168 degrees wide or more, the cone isn't useful
+	if (mindp <= 0.1f)
+	{
+		bounds.cone_cutoff = 1;
+		bounds.cone_cutoff_s8 = 127;
+		return;
+	}
+
+	float maxt = 0;
+	i = 0;
+
+	// we need to find the point on center-t*axis ray that lies in negative half-space of all triangles
+	// dot(center-t*axis-corner, trinormal) = 0
+	// dot(center-corner, trinormal) - t * dot(axis, trinormal) = 0
+#ifdef SIMD_SSE
+	__m128 smaxt = _mm_setzero_ps();
+
+	for (; i + 4 <= triangles; i += 4)
+	{
+		__m128 nx = _mm_loadu_ps(normals[0] + i), ny = _mm_loadu_ps(normals[1] + i), nz = _mm_loadu_ps(normals[2] + i);
+
+		__m128 cx = _mm_sub_ps(_mm_set1_ps(center[0]), _mm_loadu_ps(origins[0] + i));
+		__m128 cy = _mm_sub_ps(_mm_set1_ps(center[1]), _mm_loadu_ps(origins[1] + i));
+		__m128 cz = _mm_sub_ps(_mm_set1_ps(center[2]), _mm_loadu_ps(origins[2] + i));
+
+		__m128 dc = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, nx), _mm_mul_ps(cy, ny)), _mm_mul_ps(cz, nz));
+		__m128 dn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(axis[0]), nx), _mm_mul_ps(_mm_set1_ps(axis[1]), ny)), _mm_mul_ps(_mm_set1_ps(axis[2]), nz));
+
+		smaxt = _mm_max_ps(smaxt, _mm_div_ps(dc, dn));
+	}
+
+	maxt = hmaxSSE(smaxt);
+#endif
+
+	for (; i < triangles; ++i)
+	{
+		float cx = center[0] - origins[0][i];
+		float cy = center[1] - origins[1][i];
+		float cz = center[2] - origins[2][i];
+
+		float dc = cx * normals[0][i] + cy * normals[1][i] + cz * normals[2][i];
+		float dn = axis[0] * normals[0][i] + axis[1] * normals[1][i] + axis[2] * normals[2][i];
+
+		// dn should be larger than mindp cutoff above
+		assert(dn > 0.f);
+		float t = dc / dn;
+
+		maxt = (t > maxt) ? t : maxt;
+	}
+
+	// cone apex should be in the negative half-space of all cluster triangles by construction
+	bounds.cone_apex[0] = center[0] - axis[0] * maxt;
+	bounds.cone_apex[1] = center[1] - axis[1] * maxt;
+	bounds.cone_apex[2] = center[2] - axis[2] * maxt;
+
+	// note: this axis is the axis of the normal cone, but our test for perspective camera effectively negates the axis
+	bounds.cone_axis[0] = axis[0];
+	bounds.cone_axis[1] = axis[1];
+	bounds.cone_axis[2] = axis[2];
+
+	// cos(a) for normal cone is mindp; we need to add 90 degrees on both sides and invert the cone
+	// which gives us -cos(a+90) = -(-sin(a)) = sin(a) = sqrt(1 - cos^2(a))
+	bounds.cone_cutoff = sqrtf(1 - mindp * mindp);
+
+	quantizeCone(bounds.cone_axis_s8, bounds.cone_cutoff_s8, bounds.cone_axis, bounds.cone_cutoff);
+}
+
 struct Cone
 {
 	float px, py, pz;
@@ -179,6 +413,31 @@ static Cone getMeshletCone(const Cone& acc, unsigned int triangle_count)
 	return result;
 }
 
+static void getTriangleBox(float tmin[3], float tmax[3], const float* vertex_positions, size_t vertex_stride_float, unsigned int a, unsigned int b, unsigned int c)
+{
+	const float* p0 = vertex_positions + vertex_stride_float * a;
+	const float* p1 = vertex_positions + vertex_stride_float * b;
+	const float* p2 = vertex_positions + vertex_stride_float * c;
+
+	for (int k = 0; k < 3; ++k)
+	{
+		float min01 = p0[k] < p1[k] ? p0[k] : p1[k];
+		float max01 = p0[k] > p1[k] ? p0[k] : p1[k];
+
+		tmin[k] = min01 < p2[k] ? min01 : p2[k];
+		tmax[k] = max01 > p2[k] ? max01 : p2[k];
+	}
+}
+
+static float getMeshletBoxScore(const float bmin[3], const float bmax[3], const float tmin[3], const float tmax[3])
+{
+	float sx = (bmax[0] > tmax[0] ? bmax[0] : tmax[0]) - (bmin[0] < tmin[0] ? bmin[0] : tmin[0]);
+	float sy = (bmax[1] > tmax[1] ? bmax[1] : tmax[1]) - (bmin[1] < tmin[1] ? bmin[1] : tmin[1]);
+	float sz = (bmax[2] > tmax[2] ? bmax[2] : tmax[2]) - (bmin[2] < tmin[2] ? bmin[2] : tmin[2]);
+
+	return sx * sy + sy * sz + sz * sx;
+}
+
 static float computeTriangleCones(Cone* triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
 {
 	(void)vertex_count;
@@ -391,19 +650,29 @@ static size_t kdtreeBuild(size_t offset, KDNode* nodes, size_t node_count, const
 	return kdtreeBuild(next_offset, nodes, node_count, points, stride, indices + middle, count - middle, leaf_size);
 }
 
-static void kdtreeNearest(KDNode* nodes, unsigned int root, const float* points, size_t stride, const unsigned char* emitted_flags, const float* position, unsigned int& result, float& limit)
+static bool kdtreeNearest(KDNode* nodes, unsigned int root, const float* points, size_t stride, const unsigned char* emitted_flags, const float* position, unsigned int& result, float& limit)
 {
-	const KDNode& node = nodes[root];
+	KDNode& node = nodes[root];
 
 	if (node.axis == 3)
 	{
-		// leaf
-		for (unsigned int i = 0; i <= node.children; ++i)
+		// leaf; ~0u marks leaves (and collapsed branches) without remaining points
+		if (node.index == ~0u)
+			return false;
+
+		unsigned int count = node.children + 1;
+
+		for (unsigned int i = 0; i < count;)
 		{
 			unsigned int index = nodes[root + i].index;
 
+			// remove emitted points from the leaf so that subsequent searches don't need to skip them again
 			if (emitted_flags[index])
+			{
+				nodes[root + i].index = nodes[root + count - 1].index;
+				count--;
 				continue;
+			}
 
 			const float* point = points + index * stride;
 
@@ -418,7 +687,19 @@ static void kdtreeNearest(KDNode* nodes, unsigned int root, const float* points,
 				result = index;
 				limit = distance;
 			}
+
+			i++;
+		}
+
+		if (count == 0)
+		{
+			node.index = ~0u;
+			node.children = 0;
+			return false;
 		}
+
+		node.children = count - 1;
+		return true;
 	}
 	else
 	{
@@ -427,110 +708,567 @@ static void kdtreeNearest(KDNode* nodes, unsigned int root, const float* points,
 		unsigned int first = (delta <= 0) ? 0 : node.children;
 		unsigned int second = first ^ node.children;
 
-		kdtreeNearest(nodes, root + 1 + first, points, stride, emitted_flags, position, result, limit);
+		bool live = kdtreeNearest(nodes, root + 1 + first, points, stride, emitted_flags, position, result, limit);
 
 		// only process the other node if it can have a match based on closest distance so far
+		// when it's skipped, we conservatively assume it still has points left
 		if (fabsf(delta) <= limit)
-			kdtreeNearest(nodes, root + 1 + second, points, stride, emitted_flags, position, result, limit);
+			live |= kdtreeNearest(nodes, root + 1 + second, points, stride, emitted_flags, position, result, limit);
+		else
+			live = true;
+
+		// once both subtrees are empty, collapse the branch into an empty leaf so that it's never traversed again
+		if (!live)
+		{
+			node.index = ~0u;
+			node.axis = 3;
+			node.children = 0;
+		}
+
+		return live;
 	}
 }
 
-} // namespace meshopt
-
-size_t meshopt_buildMeshletsBound(size_t index_count, size_t max_vertices, size_t max_triangles)
+static void kdtreeSelect(unsigned int* indices, size_t count, const float* points, size_t stride, unsigned int axis, size_t k)
 {
-	using namespace meshopt;
+	assert(k < count);
 
-	assert(index_count % 3 == 0);
-	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
-	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
-	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
+	ptrdiff_t l = 0, r = ptrdiff_t(count) - 1;
 
-	(void)kMeshletMaxVertices;
-	(void)kMeshletMaxTriangles;
+	// quickselect with Hoare partitioning; after this, elements in [0, k) are <= element k and elements in (k, count) are >= element k
+	while (l < r)
+	{
+		float pivot = points[indices[(l + r) / 2] * stride + axis];
 
-	// meshlet construction is limited by max vertices and max triangles per meshlet
-	// the worst case is that the input is an unindexed stream since this equally stresses both limits
-	// note that we assume that in the worst case, we leave 2 vertices unpacked in each meshlet - if we have space for 3 we can pack any triangle
-	size_t max_vertices_conservative = max_vertices - 2;
-	size_t meshlet_limit_vertices = (index_count + max_vertices_conservative - 1) / max_vertices_conservative;
-	size_t meshlet_limit_triangles = (index_count / 3 + max_triangles - 1) / max_triangles;
+		ptrdiff_t i = l, j = r;
 
-	return meshlet_limit_vertices > meshlet_limit_triangles ? meshlet_limit_vertices : meshlet_limit_triangles;
-}
+		while (i <= j)
+		{
+			while (points[indices[i] * stride + axis] < pivot)
+				i++;
+			while (points[indices[j] * stride + axis] > pivot)
+				j--;
 
-size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight)
-{
-	using namespace meshopt;
+			if (i <= j)
+			{
+				unsigned int t = indices[i];
+				indices[i] = indices[j];
+				indices[j] = t;
 
-	assert(index_count % 3 == 0);
-	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
-	assert(vertex_positions_stride % sizeof(float) == 0);
+				i++;
+				j--;
+			}
+		}
 
-	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
-	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
-	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
+		if (ptrdiff_t(k) <= j)
+			r = j;
+		else if (ptrdiff_t(k) >= i)
+			l = i;
+		else
+			break;
+	}
+}
 
-	meshopt_Allocator allocator;
+static void partitionRegions(unsigned int* region_offsets, size_t& region_count, unsigned int* order, size_t offset, size_t count, const float* points, size_t stride, size_t region_triangles)
+{
+	if (count <= region_triangles)
+	{
+		region_offsets[region_count++] = unsigned(offset * 3);
+		return;
+	}
 
-	TriangleAdjacency2 adjacency = {};
-	buildTriangleAdjacency(adjacency, indices, index_count, vertex_count, allocator);
+	float minv[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+	float maxv[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
 
-	unsigned int* live_triangles = allocator.allocate<unsigned int>(vertex_count);
-	memcpy(live_triangles, adjacency.counts, vertex_count * sizeof(unsigned int));
+	for (size_t i = 0; i < count; ++i)
+	{
+		const float* point = points + order[offset + i] * stride;
 
-	size_t face_count = index_count / 3;
+		for (int k = 0; k < 3; ++k)
+		{
+			minv[k] = point[k] < minv[k] ? point[k] : minv[k];
+			maxv[k] = point[k] > maxv[k] ? point[k] : maxv[k];
+		}
+	}
 
-	unsigned char* emitted_flags = allocator.allocate<unsigned char>(face_count);
-	memset(emitted_flags, 0, face_count);
+	float extent[3] = {maxv[0] - minv[0], maxv[1] - minv[1], maxv[2] - minv[2]};
+	unsigned int axis = extent[0] >= extent[1] && extent[0] >= extent[2] ? 0 : extent[1] >= extent[2] ? 1 : 2;
 
-	// for each triangle, precompute centroid & normal to use for scoring
-	Cone* triangles = allocator.allocate<Cone>(face_count);
-	float mesh_area = computeTriangleCones(triangles, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride);
+	// split so that the left side gets a whole number of regions; this keeps all regions except the last one full
+	size_t regions = (count + region_triangles - 1) / region_triangles;
+	size_t middle = regions / 2 * region_triangles;
 
-	// assuming each meshlet is a square patch, expected radius is sqrt(expected area)
-	float triangle_area_avg = face_count == 0 ? 0.f : mesh_area / float(face_count) * 0.5f;
-	float meshlet_expected_radius = sqrtf(triangle_area_avg * max_triangles) * 0.5f;
+	kdtreeSelect(order + offset, count, points, stride, axis, middle);
 
-	// build a kd-tree for nearest neighbor lookup
-	unsigned int* kdindices = allocator.allocate<unsigned int>(face_count);
-	for (size_t i = 0; i < face_count; ++i)
-		kdindices[i] = unsigned(i);
+	partitionRegions(region_offsets, region_count, order, offset, middle, points, stride, region_triangles);
+	partitionRegions(region_offsets, region_count, order, offset + middle, count - middle, points, stride, region_triangles);
+}
 
-	KDNode* nodes = allocator.allocate<KDNode>(face_count * 2);
-	kdtreeBuild(0, nodes, face_count * 2, &triangles[0].px, sizeof(Cone) / sizeof(float), kdindices, face_count, /* leaf_size= */ 8);
+static bool isMeshletUndersized(size_t vertex_count, size_t triangle_count, size_t max_vertices, size_t max_triangles)
+{
+	return vertex_count * 2 < max_vertices || triangle_count * 2 < max_triangles;
+}
 
-	// index of the vertex in the meshlet, 0xff if the vertex isn't used
-	unsigned char* used = allocator.allocate<unsigned char>(vertex_count);
-	memset(used, -1, vertex_count);
+static bool isBoundsEmpty(const meshopt_Bounds& bounds)
+{
+	// computeClusterBounds returns zero-initialized bounds for clusters without non-degenerate triangles
+	return bounds.radius == 0 && bounds.center[0] == 0 && bounds.center[1] == 0 && bounds.center[2] == 0;
+}
 
-	meshopt_Meshlet meshlet = {};
-	size_t meshlet_offset = 0;
+static void computeNodeBounds(meshopt_MeshletBVHNode& node, const meshopt_Bounds* bounds, const unsigned int* order, size_t count)
+{
+	float minv[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+	float maxv[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+	float axis[3] = {0, 0, 0};
 
-	Cone meshlet_cone_acc = {};
+	size_t first = ~size_t(0);
 
-	for (;;)
+	for (size_t i = 0; i < count; ++i)
 	{
-		unsigned int best_triangle = ~0u;
-		unsigned int best_extra = 5;
-		float best_score = FLT_MAX;
+		const meshopt_Bounds& b = bounds[order[i]];
 
-		Cone meshlet_cone = getMeshletCone(meshlet_cone_acc, meshlet.triangle_count);
+		if (isBoundsEmpty(b))
+			continue;
 
-		for (size_t i = 0; i < meshlet.vertex_count; ++i)
+		first = first == ~size_t(0) ? i : first;
+
+		for (int k = 0; k < 3; ++k)
 		{
-			unsigned int index = meshlet_vertices[meshlet.vertex_offset + i];
+			minv[k] = b.center[k] - b.radius < minv[k] ? b.center[k] - b.radius : minv[k];
+			maxv[k] = b.center[k] + b.radius > maxv[k] ? b.center[k] + b.radius : maxv[k];
+		}
 
-			unsigned int* neighbours = &adjacency.data[0] + adjacency.offsets[index];
-			size_t neighbours_size = adjacency.counts[index];
+		axis[0] += b.cone_axis[0];
+		axis[1] += b.cone_axis[1];
+		axis[2] += b.cone_axis[2];
+	}
 
-			for (size_t j = 0; j < neighbours_size; ++j)
-			{
-				unsigned int triangle = neighbours[j];
-				assert(!emitted_flags[triangle]);
+	memset(&node, 0, sizeof(node));
 
-				unsigned int a = indices[triangle * 3 + 0], b = indices[triangle * 3 + 1], c = indices[triangle * 3 + 2];
-				assert(a < vertex_count && b < vertex_count && c < vertex_count);
+	if (first == ~size_t(0))
+	{
+		node.cone_cutoff_s8 = 127;
+		return;
+	}
+
+	// sphere centered at the box center, expanded to contain all child spheres
+	float bcenter[3] = {(minv[0] + maxv[0]) * 0.5f, (minv[1] + maxv[1]) * 0.5f, (minv[2] + maxv[2]) * 0.5f};
+	float bradius = 0;
+
+	// sphere grown incrementally starting from the first child sphere; this is tighter when children are clustered unevenly
+	float gcenter[3] = {bounds[order[first]].center[0], bounds[order[first]].center[1], bounds[order[first]].center[2]};
+	float gradius = bounds[order[first]].radius;
+
+	for (size_t i = first; i < count; ++i)
+	{
+		const meshopt_Bounds& b = bounds[order[i]];
+
+		if (isBoundsEmpty(b))
+			continue;
+
+		float bd = sqrtf((b.center[0] - bcenter[0]) * (b.center[0] - bcenter[0]) + (b.center[1] - bcenter[1]) * (b.center[1] - bcenter[1]) + (b.center[2] - bcenter[2]) * (b.center[2] - bcenter[2]));
+		bradius = bd + b.radius > bradius ? bd + b.radius : bradius;
+
+		float gd = sqrtf((b.center[0] - gcenter[0]) * (b.center[0] - gcenter[0]) + (b.center[1] - gcenter[1]) * (b.center[1] - gcenter[1]) + (b.center[2] - gcenter[2]) * (b.center[2] - gcenter[2]));
+
+		if (gd + b.radius > gradius)
+		{
+			if (gd + gradius <= b.radius)
+			{
+				// child sphere contains the current sphere
+				gcenter[0] = b.center[0];
+				gcenter[1] = b.center[1];
+				gcenter[2] = b.center[2];
+				gradius = b.radius;
+			}
+			else
+			{
+				float newradius = (gradius + gd + b.radius) * 0.5f;
+				float k = (newradius - gradius) / gd;
+
+				gcenter[0] += (b.center[0] - gcenter[0]) * k;
+				gcenter[1] += (b.center[1] - gcenter[1]) * k;
+				gcenter[2] += (b.center[2] - gcenter[2]) * k;
+				gradius = newradius;
+			}
+		}
+	}
+
+	// both spheres are conservative up to floating point error, so we pad the radius slightly
+	const float* center = gradius < bradius ? gcenter : bcenter;
+	float radius = gradius < bradius ? gradius : bradius;
+
+	node.center[0] = center[0];
+	node.center[1] = center[1];
+	node.center[2] = center[2];
+	node.radius = radius * (1 + 1e-5f);
+
+	// merged cone uses the average axis; its spread must cover the spread of each child cone around the new axis
+	float axislength = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	float spread = 0;
+
+	if (axislength > 0)
+	{
+		axis[0] /= axislength;
+		axis[1] /= axislength;
+		axis[2] /= axislength;
+
+		for (size_t i = first; i < count; ++i)
+		{
+			const meshopt_Bounds& b = bounds[order[i]];
+
+			if (isBoundsEmpty(b))
+				continue;
+
+			float dp = axis[0] * b.cone_axis[0] + axis[1] * b.cone_axis[1] + axis[2] * b.cone_axis[2];
+			float angle = acosf(dp < -1 ? -1 : dp > 1 ? 1 : dp) + asinf(b.cone_cutoff < 1 ? b.cone_cutoff : 1);
+
+			spread = angle > spread ? angle : spread;
+		}
+	}
+
+	// same threshold as computeClusterCone: cones that are too wide are not useful for culling
+	if (axislength == 0 || spread >= acosf(0.1f))
+	{
+		node.cone_cutoff_s8 = 127;
+		return;
+	}
+
+	quantizeCone(node.cone_axis_s8, node.cone_cutoff_s8, axis, sinf(spread));
+}
+
+static size_t bvhSplitMedian(unsigned int* order, size_t count, const meshopt_Bounds* bounds, size_t leaf_size)
+{
+	const float* points = bounds[0].center;
+	const size_t stride = sizeof(meshopt_Bounds) / sizeof(float);
+
+	float minv[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+	float maxv[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const float* point = points + order[i] * stride;
+
+		for (int k = 0; k < 3; ++k)
+		{
+			minv[k] = point[k] < minv[k] ? point[k] : minv[k];
+			maxv[k] = point[k] > maxv[k] ? point[k] : maxv[k];
+		}
+	}
+
+	float extent[3] = {maxv[0] - minv[0], maxv[1] - minv[1], maxv[2] - minv[2]};
+	unsigned int axis = extent[0] >= extent[1] && extent[0] >= extent[2] ? 0 : extent[1] >= extent[2] ? 1 : 2;
+
+	// split so that the left side gets a whole number of leaves; this keeps all leaves except the last one full
+	size_t leaves = (count + leaf_size - 1) / leaf_size;
+	size_t middle = leaves > 1 ? leaves / 2 * leaf_size : count / 2;
+
+	kdtreeSelect(order, count, points, stride, axis, middle);
+
+	return middle;
+}
+
+static float getBoxArea(const float minv[3], const float maxv[3])
+{
+	float sx = maxv[0] - minv[0], sy = maxv[1] - minv[1], sz = maxv[2] - minv[2];
+
+	return sx * sy + sy * sz + sz * sx;
+}
+
+static size_t bvhSplitSAH(unsigned int* order, size_t count, const meshopt_Bounds* bounds, size_t leaf_size)
+{
+	const float* points = bounds[0].center;
+	const size_t stride = sizeof(meshopt_Bounds) / sizeof(float);
+
+	float cmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+	float cmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const float* point = points + order[i] * stride;
+
+		for (int k = 0; k < 3; ++k)
+		{
+			cmin[k] = point[k] < cmin[k] ? point[k] : cmin[k];
+			cmax[k] = point[k] > cmax[k] ? point[k] : cmax[k];
+		}
+	}
+
+	float bestcost = FLT_MAX;
+	unsigned int bestaxis = 0;
+	float bestpivot = 0;
+
+	for (unsigned int axis = 0; axis < 3; ++axis)
+	{
+		float extent = cmax[axis] - cmin[axis];
+
+		if (extent <= 0)
+			continue;
+
+		float binmin[kMeshletBVHBins][3], binmax[kMeshletBVHBins][3];
+		size_t bincount[kMeshletBVHBins] = {};
+
+		for (size_t b = 0; b < kMeshletBVHBins; ++b)
+			for (int k = 0; k < 3; ++k)
+			{
+				binmin[b][k] = FLT_MAX;
+				binmax[b][k] = -FLT_MAX;
+			}
+
+		float scale = float(kMeshletBVHBins) / extent;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const meshopt_Bounds& b = bounds[order[i]];
+
+			int bin = int((b.center[axis] - cmin[axis]) * scale);
+			bin = bin < 0 ? 0 : bin >= int(kMeshletBVHBins) ? int(kMeshletBVHBins) - 1 : bin;
+
+			for (int k = 0; k < 3; ++k)
+			{
+				binmin[bin][k] = b.center[k] - b.radius < binmin[bin][k] ? b.center[k] - b.radius : binmin[bin][k];
+				binmax[bin][k] = b.center[k] + b.radius > binmax[bin][k] ? b.center[k] + b.radius : binmax[bin][k];
+			}
+
+			bincount[bin]++;
+		}
+
+		// sweep from the right to compute the cost of the right side of each split
+		float rightcost[kMeshletBVHBins];
+		float rmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		float rmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+		size_t rcount = 0;
+
+		for (size_t b = kMeshletBVHBins - 1; b > 0; --b)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				rmin[k] = binmin[b][k] < rmin[k] ? binmin[b][k] : rmin[k];
+				rmax[k] = binmax[b][k] > rmax[k] ? binmax[b][k] : rmax[k];
+			}
+
+			rcount += bincount[b];
+
+			// cost is measured in leaves to favor splits that produce full leaves
+			rightcost[b] = rcount ? getBoxArea(rmin, rmax) * float((rcount + leaf_size - 1) / leaf_size) : 0;
+		}
+
+		float lmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		float lmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+		size_t lcount = 0;
+
+		for (size_t b = 0; b < kMeshletBVHBins - 1; ++b)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				lmin[k] = binmin[b][k] < lmin[k] ? binmin[b][k] : lmin[k];
+				lmax[k] = binmax[b][k] > lmax[k] ? binmax[b][k] : lmax[k];
+			}
+
+			lcount += bincount[b];
+
+			if (lcount == 0 || lcount == count)
+				continue;
+
+			float cost = getBoxArea(lmin, lmax) * float((lcount + leaf_size - 1) / leaf_size) + rightcost[b + 1];
+
+			if (cost < bestcost)
+			{
+				bestcost = cost;
+				bestaxis = axis;
+				bestpivot = cmin[axis] + float(b + 1) / scale;
+			}
+		}
+	}
+
+	if (bestcost == FLT_MAX)
+		return bvhSplitMedian(order, count, bounds, leaf_size);
+
+	size_t middle = kdtreePartition(order, count, points, stride, bestaxis, bestpivot);
+
+	// bin assignment and partitioning may disagree due to rounding; fall back to median split if the partition is empty
+	if (middle == 0 || middle == count)
+		return bvhSplitMedian(order, count, bounds, leaf_size);
+
+	return middle;
+}
+
+static void bvhBuild(meshopt_MeshletBVHNode* nodes, size_t& node_count, size_t node_index, unsigned int* order, size_t offset, size_t count, const meshopt_Bounds* bounds, size_t node_width, size_t leaf_size, unsigned int options, unsigned int depth)
+{
+	meshopt_MeshletBVHNode& node = nodes[node_index];
+
+	computeNodeBounds(node, bounds, order + offset, count);
+
+	if (count <= leaf_size)
+	{
+		node.offset = unsigned(offset);
+		node.count = unsigned(count);
+		node.leaf = 1;
+		return;
+	}
+
+	// SAH splits may be unbalanced; past a certain depth we switch to median splits to bound the recursion depth
+	bool sah = (options & meshopt_MeshletBVHSAH) != 0 && depth < kMeshletBVHMaxSAHDepth;
+
+	size_t range_offset[kMeshletBVHMaxWidth];
+	size_t range_count[kMeshletBVHMaxWidth];
+	size_t ranges = 1;
+
+	range_offset[0] = offset;
+	range_count[0] = count;
+
+	// split the largest range until we reach the target width or run out of ranges that need splitting
+	while (ranges < node_width)
+	{
+		size_t largest = 0;
+
+		for (size_t i = 1; i < ranges; ++i)
+			largest = range_count[i] > range_count[largest] ? i : largest;
+
+		if (range_count[largest] <= leaf_size)
+			break;
+
+		unsigned int* range_order = order + range_offset[largest];
+		size_t middle = sah ? bvhSplitSAH(range_order, range_count[largest], bounds, leaf_size) : bvhSplitMedian(range_order, range_count[largest], bounds, leaf_size);
+		assert(middle > 0 && middle < range_count[largest]);
+
+		// keep ranges sorted by offset so that children are laid out in meshlet order
+		for (size_t i = ranges; i > largest + 1; --i)
+		{
+			range_offset[i] = range_offset[i - 1];
+			range_count[i] = range_count[i - 1];
+		}
+
+		range_offset[largest + 1] = range_offset[largest] + middle;
+		range_count[largest + 1] = range_count[largest] - middle;
+		range_count[largest] = middle;
+		ranges++;
+	}
+
+	// children are allocated consecutively so that they can be fetched together
+	size_t children = node_count;
+	node_count += ranges;
+
+	node.offset = unsigned(children);
+	node.count = unsigned(ranges);
+	node.leaf = 0;
+
+	for (size_t i = 0; i < ranges; ++i)
+		bvhBuild(nodes, node_count, children + i, order, range_offset[i], range_count[i], bounds, node_width, leaf_size, options, depth + 1);
+}
+
+} // namespace meshopt
+
+size_t meshopt_buildMeshletsBound(size_t index_count, size_t max_vertices, size_t max_triangles)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
+	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
+	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
+
+	(void)kMeshletMaxVertices;
+	(void)kMeshletMaxTriangles;
+
+	// meshlet construction is limited by max vertices and max triangles per meshlet
+	// the worst case is that the input is an unindexed stream since this equally stresses both limits
+	// note that we assume that in the worst case, we leave 2 vertices unpacked in each meshlet - if we have space for 3 we can pack any triangle
+	size_t max_vertices_conservative = max_vertices - 2;
+	size_t meshlet_limit_vertices = (index_count + max_vertices_conservative - 1) / max_vertices_conservative;
+	size_t meshlet_limit_triangles = (index_count / 3 + max_triangles - 1) / max_triangles;
+
+	return meshlet_limit_vertices > meshlet_limit_triangles ? meshlet_limit_vertices : meshlet_limit_triangles;
+}
+
+static size_t buildMeshlets(meshopt_Context* context, meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight, bool spatial)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+
+	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
+	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
+	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
+
+	meshopt_Tracer zone("meshopt_buildMeshlets");
+	meshopt_Allocator allocator(context);
+
+	allocator.stage("adjacency");
+
+	TriangleAdjacency2 adjacency = {};
+	buildTriangleAdjacency(adjacency, indices, index_count, vertex_count, allocator);
+
+	unsigned int* live_triangles = allocator.allocate<unsigned int>(vertex_count);
+	memcpy(live_triangles, adjacency.counts, vertex_count * sizeof(unsigned int));
+
+	size_t face_count = index_count / 3;
+
+	unsigned char* emitted_flags = allocator.allocate<unsigned char>(face_count);
+	memset(emitted_flags, 0, face_count);
+
+	// for each triangle, precompute centroid & normal to use for scoring
+	Cone* triangles = allocator.allocate<Cone>(face_count);
+	float mesh_area = computeTriangleCones(triangles, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride);
+
+	// assuming each meshlet is a square patch, expected radius is sqrt(expected area)
+	float triangle_area_avg = face_count == 0 ? 0.f : mesh_area / float(face_count) * 0.5f;
+	float meshlet_expected_radius = sqrtf(triangle_area_avg * max_triangles) * 0.5f;
+
+	allocator.stage("kdtree");
+
+	// build a kd-tree for nearest neighbor lookup
+	unsigned int* kdindices = allocator.allocate<unsigned int>(face_count);
+	for (size_t i = 0; i < face_count; ++i)
+		kdindices[i] = unsigned(i);
+
+	KDNode* nodes = allocator.allocate<KDNode>(face_count * 2);
+	kdtreeBuild(0, nodes, face_count * 2, &triangles[0].px, sizeof(Cone) / sizeof(float), kdindices, face_count, /* leaf_size= */ 8);
+
+	allocator.stage("build");
+
+	// index of the vertex in the meshlet, 0xff if the vertex isn't used
+	unsigned char* used = allocator.allocate<unsigned char>(vertex_count);
+	memset(used, -1, vertex_count);
+
+	meshopt_Meshlet meshlet = {};
+	size_t meshlet_offset = 0;
+
+	Cone meshlet_cone_acc = {};
+
+	// spatial mode also tracks the meshlet bounding box to score triangles by area growth
+	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+
+	float meshlet_min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+	float meshlet_max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+	size_t emitted_count = 0;
+	bool cancelled = false;
+
+	for (;;)
+	{
+		unsigned int best_triangle = ~0u;
+		unsigned int best_extra = 5;
+		float best_score = FLT_MAX;
+
+		Cone meshlet_cone = getMeshletCone(meshlet_cone_acc, meshlet.triangle_count);
+
+		for (size_t i = 0; i < meshlet.vertex_count; ++i)
+		{
+			unsigned int index = meshlet_vertices[meshlet.vertex_offset + i];
+
+			unsigned int* neighbours = &adjacency.data[0] + adjacency.offsets[index];
+			size_t neighbours_size = adjacency.counts[index];
+
+			for (size_t j = 0; j < neighbours_size; ++j)
+			{
+				unsigned int triangle = neighbours[j];
+				assert(!emitted_flags[triangle]);
+
+				unsigned int a = indices[triangle * 3 + 0], b = indices[triangle * 3 + 1], c = indices[triangle * 3 + 2];
+				assert(a < vertex_count && b < vertex_count && c < vertex_count);
 
 				unsigned int extra = (used[a] == 0xff) + (used[b] == 0xff) + (used[c] == 0xff);
 
@@ -544,102 +1282,625 @@ size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_ve
 					extra++;
 				}
 
-				// since topology-based priority is always more important than the score, we can skip scoring in some cases
-				if (extra > best_extra)
-					continue;
+				// since topology-based priority is always more important than the score, we can skip scoring in some cases
+				if (extra > best_extra)
+					continue;
+
+				const Cone& tri_cone = triangles[triangle];
+
+				float distance2 =
+				    (tri_cone.px - meshlet_cone.px) * (tri_cone.px - meshlet_cone.px) +
+				    (tri_cone.py - meshlet_cone.py) * (tri_cone.py - meshlet_cone.py) +
+				    (tri_cone.pz - meshlet_cone.pz) * (tri_cone.pz - meshlet_cone.pz);
+
+				float score = 0;
+
+				if (spatial)
+				{
+					float tmin[3], tmax[3];
+					getTriangleBox(tmin, tmax, vertex_positions, vertex_stride_float, a, b, c);
+
+					// rank candidates by meshlet box area after adding the triangle, plus a small distance term that favors compact growth
+					score = getMeshletBoxScore(meshlet_min, meshlet_max, tmin, tmax) + distance2 * kMeshletSpatialDistanceWeight;
+				}
+				else
+				{
+					float spread = tri_cone.nx * meshlet_cone.nx + tri_cone.ny * meshlet_cone.ny + tri_cone.nz * meshlet_cone.nz;
+
+					score = getMeshletScore(distance2, spread, cone_weight, meshlet_expected_radius);
+				}
+
+				// note that topology-based priority is always more important than the score
+				// this helps maintain reasonable effectiveness of meshlet data and reduces scoring cost
+				if (extra < best_extra || score < best_score)
+				{
+					best_triangle = triangle;
+					best_extra = extra;
+					best_score = score;
+				}
+			}
+		}
+
+		if (best_triangle == ~0u)
+		{
+			float position[3] = {meshlet_cone.px, meshlet_cone.py, meshlet_cone.pz};
+			unsigned int index = ~0u;
+			float limit = FLT_MAX;
+
+			kdtreeNearest(nodes, 0, &triangles[0].px, sizeof(Cone) / sizeof(float), emitted_flags, position, index, limit);
+
+			best_triangle = index;
+		}
+
+		if (best_triangle == ~0u)
+			break;
+
+		unsigned int a = indices[best_triangle * 3 + 0], b = indices[best_triangle * 3 + 1], c = indices[best_triangle * 3 + 2];
+		assert(a < vertex_count && b < vertex_count && c < vertex_count);
+
+		// add meshlet to the output; when the current meshlet is full we reset the accumulated bounds
+		if (appendMeshlet(meshlet, a, b, c, used, meshlets, meshlet_vertices, meshlet_triangles, meshlet_offset, max_vertices, max_triangles))
+		{
+			meshlet_offset++;
+			memset(&meshlet_cone_acc, 0, sizeof(meshlet_cone_acc));
+
+			for (int k = 0; k < 3; ++k)
+			{
+				meshlet_min[k] = FLT_MAX;
+				meshlet_max[k] = -FLT_MAX;
+			}
+
+			if (context && context->progress && !context->progress(context->userdata, float(emitted_count) / float(face_count), meshlet_offset, 0.f))
+				cancelled = true;
+		}
+
+		live_triangles[a]--;
+		live_triangles[b]--;
+		live_triangles[c]--;
+
+		// remove emitted triangle from adjacency data
+		// this makes sure that we spend less time traversing these lists on subsequent iterations
+		for (size_t k = 0; k < 3; ++k)
+		{
+			unsigned int index = indices[best_triangle * 3 + k];
+
+			unsigned int* neighbours = &adjacency.data[0] + adjacency.offsets[index];
+			size_t neighbours_size = adjacency.counts[index];
+
+			for (size_t i = 0; i < neighbours_size; ++i)
+			{
+				unsigned int tri = neighbours[i];
+
+				if (tri == best_triangle)
+				{
+					neighbours[i] = neighbours[neighbours_size - 1];
+					adjacency.counts[index]--;
+					break;
+				}
+			}
+		}
+
+		// update aggregated meshlet cone data for scoring subsequent triangles
+		meshlet_cone_acc.px += triangles[best_triangle].px;
+		meshlet_cone_acc.py += triangles[best_triangle].py;
+		meshlet_cone_acc.pz += triangles[best_triangle].pz;
+		meshlet_cone_acc.nx += triangles[best_triangle].nx;
+		meshlet_cone_acc.ny += triangles[best_triangle].ny;
+		meshlet_cone_acc.nz += triangles[best_triangle].nz;
+
+		if (spatial)
+		{
+			float tmin[3], tmax[3];
+			getTriangleBox(tmin, tmax, vertex_positions, vertex_stride_float, a, b, c);
+
+			for (int k = 0; k < 3; ++k)
+			{
+				meshlet_min[k] = tmin[k] < meshlet_min[k] ? tmin[k] : meshlet_min[k];
+				meshlet_max[k] = tmax[k] > meshlet_max[k] ? tmax[k] : meshlet_max[k];
+			}
+		}
+
+		emitted_flags[best_triangle] = 1;
+		emitted_count++;
+
+		if (cancelled)
+			break;
+	}
+
+	// when the build is cancelled, remaining triangles are packed in index order to keep the output complete
+	if (cancelled)
+	{
+		for (size_t i = 0; i < face_count; ++i)
+		{
+			if (emitted_flags[i])
+				continue;
+
+			unsigned int a = indices[i * 3 + 0], b = indices[i * 3 + 1], c = indices[i * 3 + 2];
+			assert(a < vertex_count && b < vertex_count && c < vertex_count);
+
+			meshlet_offset += appendMeshlet(meshlet, a, b, c, used, meshlets, meshlet_vertices, meshlet_triangles, meshlet_offset, max_vertices, max_triangles);
+		}
+	}
+
+	if (meshlet.triangle_count)
+	{
+		finishMeshlet(meshlet, meshlet_triangles);
+
+		meshlets[meshlet_offset++] = meshlet;
+	}
+
+	assert(meshlet_offset <= meshopt_buildMeshletsBound(index_count, max_vertices, max_triangles));
+
+	meshopt_Tracer::counter("buildMeshlets.meshlets", double(meshlet_offset));
+	meshopt_Tracer::counter("buildMeshlets.cancelled", cancelled ? 1.0 : 0.0);
+
+	return meshlet_offset;
+}
+
+size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight)
+{
+	return buildMeshlets(NULL, meshlets, meshlet_vertices, meshlet_triangles, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, max_vertices, max_triangles, cone_weight, /* spatial= */ false);
+}
+
+size_t meshopt_buildMeshletsWithContext(meshopt_Context* context, meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight)
+{
+	return buildMeshlets(context, meshlets, meshlet_vertices, meshlet_triangles, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, max_vertices, max_triangles, cone_weight, /* spatial= */ false);
+}
+
+size_t meshopt_buildMeshletsSpatial(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles)
+{
+	return buildMeshlets(NULL, meshlets, meshlet_vertices, meshlet_triangles, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, max_vertices, max_triangles, 0.f, /* spatial= */ true);
+}
+
+size_t meshopt_buildMeshletsScratchSize(size_t index_count, size_t vertex_count)
+{
+	using namespace meshopt;
+
+	size_t face_count = index_count / 3;
+
+	// this needs to match the allocation sequence in meshopt_buildMeshletsWithContext
+	size_t size = 0;
+
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // adjacency.counts
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // adjacency.offsets
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, index_count); // adjacency.data
+
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // live_triangles
+	size = meshopt_Allocator::scratchSize<unsigned char>(size, face_count); // emitted_flags
+	size = meshopt_Allocator::scratchSize<Cone>(size, face_count); // triangles
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, face_count); // kdindices
+	size = meshopt_Allocator::scratchSize<KDNode>(size, face_count * 2); // nodes
+	size = meshopt_Allocator::scratchSize<unsigned char>(size, vertex_count); // used
+
+	return size;
+}
+
+size_t meshopt_partitionMeshletRegions(unsigned int* destination, unsigned int* region_offsets, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t region_triangles)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+	assert(region_triangles > 0);
+
+	(void)vertex_count;
+
+	meshopt_Tracer zone("meshopt_partitionMeshletRegions");
+	meshopt_Allocator allocator;
+
+	size_t face_count = index_count / 3;
+	size_t region_count = 0;
+
+	if (face_count)
+	{
+		// partitioning only needs triangle centroids, so we don't compute full cone data here
+		size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+
+		float* centroids = allocator.allocate<float>(face_count * 3);
+
+		for (size_t i = 0; i < face_count; ++i)
+		{
+			unsigned int a = indices[i * 3 + 0], b = indices[i * 3 + 1], c = indices[i * 3 + 2];
+			assert(a < vertex_count && b < vertex_count && c < vertex_count);
+
+			const float* p0 = vertex_positions + vertex_stride_float * a;
+			const float* p1 = vertex_positions + vertex_stride_float * b;
+			const float* p2 = vertex_positions + vertex_stride_float * c;
+
+			centroids[i * 3 + 0] = (p0[0] + p1[0] + p2[0]) / 3.f;
+			centroids[i * 3 + 1] = (p0[1] + p1[1] + p2[1]) / 3.f;
+			centroids[i * 3 + 2] = (p0[2] + p1[2] + p2[2]) / 3.f;
+		}
+
+		unsigned int* order = allocator.allocate<unsigned int>(face_count);
+		for (size_t i = 0; i < face_count; ++i)
+			order[i] = unsigned(i);
+
+		partitionRegions(region_offsets, region_count, order, 0, face_count, centroids, 3, region_triangles);
+
+		// triangles are placed into their regions in source order; this preserves vertex cache locality of the input within each region
+		unsigned int* targets = allocator.allocate<unsigned int>(face_count);
+		unsigned int* cursors = allocator.allocate<unsigned int>(region_count);
+
+		for (size_t r = 0; r < region_count; ++r)
+		{
+			size_t begin = region_offsets[r] / 3;
+			size_t end = r + 1 < region_count ? region_offsets[r + 1] / 3 : face_count;
+
+			for (size_t i = begin; i < end; ++i)
+				targets[order[i]] = unsigned(r);
+
+			cursors[r] = unsigned(begin);
+		}
+
+		for (size_t i = 0; i < face_count; ++i)
+			targets[i] = cursors[targets[i]]++;
+
+		// centroids are no longer needed, so in-place partitioning keeps a copy of the source triangles in their place; memcpy keeps the type punning well-defined
+		const void* source = indices;
+
+		if (destination == indices)
+		{
+			memcpy(centroids, indices, index_count * sizeof(unsigned int));
+			source = centroids;
+		}
+
+		for (size_t i = 0; i < face_count; ++i)
+			memcpy(destination + targets[i] * 3, static_cast<const char*>(source) + i * 3 * sizeof(unsigned int), 3 * sizeof(unsigned int));
+	}
+
+	assert(region_count == (face_count + region_triangles - 1) / region_triangles);
+
+	region_offsets[region_count] = unsigned(index_count);
+
+	meshopt_Tracer::counter("partitionMeshletRegions.regions", double(region_count));
+
+	return region_count;
+}
+
+size_t meshopt_mergeMeshlets(meshopt_Meshlet* destination, unsigned int* destination_vertices, unsigned char* destination_triangles, const meshopt_Meshlet* meshlets, const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, size_t meshlet_count, size_t vertex_count, size_t max_vertices, size_t max_triangles)
+{
+	using namespace meshopt;
+
+	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
+	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
+	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
+
+	meshopt_Tracer zone("meshopt_mergeMeshlets");
+	meshopt_Allocator allocator;
+
+	// build vertex => meshlet adjacency
+	unsigned int* counts = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* offsets = allocator.allocate<unsigned int>(vertex_count);
+	memset(counts, 0, vertex_count * sizeof(unsigned int));
+
+	size_t total_vertices = 0;
+
+	for (size_t i = 0; i < meshlet_count; ++i)
+	{
+		const meshopt_Meshlet& m = meshlets[i];
+		assert(m.vertex_count <= max_vertices && m.triangle_count <= max_triangles);
+
+		for (size_t j = 0; j < m.vertex_count; ++j)
+		{
+			unsigned int v = meshlet_vertices[m.vertex_offset + j];
+			assert(v < vertex_count);
+
+			counts[v]++;
+		}
+
+		total_vertices += m.vertex_count;
+	}
+
+	unsigned int* data = allocator.allocate<unsigned int>(total_vertices);
+
+	size_t offset = 0;
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		offsets[i] = unsigned(offset);
+		offset += counts[i];
+	}
+
+	for (size_t i = 0; i < meshlet_count; ++i)
+	{
+		const meshopt_Meshlet& m = meshlets[i];
+
+		for (size_t j = 0; j < m.vertex_count; ++j)
+		{
+			unsigned int v = meshlet_vertices[m.vertex_offset + j];
+
+			data[offsets[v]++] = unsigned(i);
+		}
+	}
+
+	// fix offsets that have been disturbed by the previous pass
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		assert(offsets[i] >= counts[i]);
+
+		offsets[i] -= counts[i];
+	}
+
+	// each group is a linked list of meshlets starting at the leader; ~0u marks meshlets that are not part of any group yet
+	unsigned int* group = allocator.allocate<unsigned int>(meshlet_count);
+	unsigned int* next = allocator.allocate<unsigned int>(meshlet_count);
+	memset(group, -1, meshlet_count * sizeof(unsigned int));
+	memset(next, -1, meshlet_count * sizeof(unsigned int));
+
+	unsigned int* shared = allocator.allocate<unsigned int>(meshlet_count);
+	unsigned int* candidates = allocator.allocate<unsigned int>(meshlet_count);
+	memset(shared, 0, meshlet_count * sizeof(unsigned int));
+
+	// index of the vertex in the meshlet, 0xff if the vertex isn't used
+	unsigned char* used = allocator.allocate<unsigned char>(vertex_count);
+	memset(used, -1, vertex_count);
+
+	unsigned int group_vertices[kMeshletMaxVertices];
+	size_t merged = 0;
+
+	for (size_t i = 0; i < meshlet_count; ++i)
+	{
+		// meshlets that were absorbed by an earlier group can't start their own group
+		if (group[i] != ~0u && group[i] != i)
+			continue;
+
+		size_t group_vertex_count = meshlets[i].vertex_count;
+		size_t group_triangle_count = meshlets[i].triangle_count;
+		unsigned int tail = unsigned(i);
+
+		while (isMeshletUndersized(group_vertex_count, group_triangle_count, max_vertices, max_triangles))
+		{
+			// gather unique group vertices
+			size_t unique = 0;
+
+			for (unsigned int m = unsigned(i); m != ~0u; m = next[m])
+				for (size_t j = 0; j < meshlets[m].vertex_count; ++j)
+				{
+					unsigned int v = meshlet_vertices[meshlets[m].vertex_offset + j];
+
+					if (used[v] == 0xff)
+					{
+						used[v] = 0;
+						group_vertices[unique++] = v;
+					}
+				}
+
+			assert(unique == group_vertex_count);
+
+			// count shared vertices for all neighboring meshlets that are not part of any group
+			size_t candidate_count = 0;
+
+			for (size_t j = 0; j < unique; ++j)
+			{
+				unsigned int v = group_vertices[j];
+				used[v] = 0xff;
+
+				const unsigned int* neighbors = &data[offsets[v]];
+
+				for (size_t k = 0; k < counts[v]; ++k)
+				{
+					unsigned int n = neighbors[k];
+
+					if (n == i || group[n] != ~0u)
+						continue;
+
+					if (shared[n] == 0)
+						candidates[candidate_count++] = n;
+
+					shared[n]++;
+				}
+			}
+
+			// pick the neighbor that shares the most vertices among the ones that fit
+			unsigned int best = ~0u;
+			unsigned int best_shared = 0;
+
+			for (size_t j = 0; j < candidate_count; ++j)
+			{
+				unsigned int n = candidates[j];
+				const meshopt_Meshlet& m = meshlets[n];
+
+				if (group_vertex_count + m.vertex_count - shared[n] <= max_vertices && group_triangle_count + m.triangle_count <= max_triangles &&
+				    (shared[n] > best_shared || (shared[n] == best_shared && m.triangle_count < meshlets[best].triangle_count)))
+				{
+					best = n;
+					best_shared = shared[n];
+				}
+
+				shared[n] = 0;
+			}
+
+			if (best == ~0u)
+				break;
+
+			group[i] = unsigned(i);
+			group[best] = unsigned(i);
+			next[tail] = best;
+			tail = best;
 
-				const Cone& tri_cone = triangles[triangle];
+			group_vertex_count += meshlets[best].vertex_count - best_shared;
+			group_triangle_count += meshlets[best].triangle_count;
+			merged++;
+		}
+	}
 
-				float distance2 =
-				    (tri_cone.px - meshlet_cone.px) * (tri_cone.px - meshlet_cone.px) +
-				    (tri_cone.py - meshlet_cone.py) * (tri_cone.py - meshlet_cone.py) +
-				    (tri_cone.pz - meshlet_cone.pz) * (tri_cone.pz - meshlet_cone.pz);
+	// emit all groups in the order of their leaders
+	meshopt_Meshlet meshlet = {};
+	size_t meshlet_offset = 0;
 
-				float spread = tri_cone.nx * meshlet_cone.nx + tri_cone.ny * meshlet_cone.ny + tri_cone.nz * meshlet_cone.nz;
+	for (size_t i = 0; i < meshlet_count; ++i)
+	{
+		if (group[i] != ~0u && group[i] != i)
+			continue;
 
-				float score = getMeshletScore(distance2, spread, cone_weight, meshlet_expected_radius);
+		for (unsigned int m = unsigned(i); m != ~0u; m = next[m])
+		{
+			const unsigned int* vertices = &meshlet_vertices[meshlets[m].vertex_offset];
+			const unsigned char* triangles = &meshlet_triangles[meshlets[m].triangle_offset];
 
-				// note that topology-based priority is always more important than the score
-				// this helps maintain reasonable effectiveness of meshlet data and reduces scoring cost
-				if (extra < best_extra || score < best_score)
-				{
-					best_triangle = triangle;
-					best_extra = extra;
-					best_score = score;
-				}
+			for (size_t j = 0; j < meshlets[m].triangle_count; ++j)
+			{
+				unsigned int a = vertices[triangles[j * 3 + 0]], b = vertices[triangles[j * 3 + 1]], c = vertices[triangles[j * 3 + 2]];
+
+				// the group is known to fit so this never flushes the meshlet
+				bool flushed = appendMeshlet(meshlet, a, b, c, used, destination, destination_vertices, destination_triangles, meshlet_offset, max_vertices, max_triangles);
+				assert(!flushed);
+				(void)flushed;
 			}
 		}
 
-		if (best_triangle == ~0u)
+		if (meshlet.triangle_count)
 		{
-			float position[3] = {meshlet_cone.px, meshlet_cone.py, meshlet_cone.pz};
-			unsigned int index = ~0u;
-			float limit = FLT_MAX;
+			finishMeshlet(meshlet, destination_triangles);
 
-			kdtreeNearest(nodes, 0, &triangles[0].px, sizeof(Cone) / sizeof(float), emitted_flags, position, index, limit);
+			destination[meshlet_offset++] = meshlet;
 
-			best_triangle = index;
+			for (size_t j = 0; j < meshlet.vertex_count; ++j)
+				used[destination_vertices[meshlet.vertex_offset + j]] = 0xff;
+
+			meshlet.vertex_offset += meshlet.vertex_count;
+			meshlet.triangle_offset += (meshlet.triangle_count * 3 + 3) & ~3; // 4b padding
+			meshlet.vertex_count = 0;
+			meshlet.triangle_count = 0;
 		}
+	}
 
-		if (best_triangle == ~0u)
-			break;
+	assert(meshlet_offset + merged <= meshlet_count);
 
-		unsigned int a = indices[best_triangle * 3 + 0], b = indices[best_triangle * 3 + 1], c = indices[best_triangle * 3 + 2];
-		assert(a < vertex_count && b < vertex_count && c < vertex_count);
+	meshopt_Tracer::counter("mergeMeshlets.merged", double(merged));
 
-		// add meshlet to the output; when the current meshlet is full we reset the accumulated bounds
-		if (appendMeshlet(meshlet, a, b, c, used, meshlets, meshlet_vertices, meshlet_triangles, meshlet_offset, max_vertices, max_triangles))
+	return meshlet_offset;
+}
+
+void meshopt_optimizeMeshlet(unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, size_t triangle_count, size_t vertex_count)
+{
+	using namespace meshopt;
+
+	assert(triangle_count <= kMeshletMaxTriangles);
+	assert(vertex_count <= kMeshletMaxVertices);
+
+	unsigned char* indices = meshlet_triangles;
+
+	// triangles are ordered greedily to maximize hits in a FIFO cache of recently referenced vertices (see meshopt_analyzeMeshletCache)
+	// vertices that have few remaining triangles get a small bonus so that they leave the working set quickly
+	// note that 16-bit timestamps are sufficient since meshlets have at most 512 triangles
+	unsigned short timestamps[kMeshletMaxVertices];
+	memset(timestamps, 0, vertex_count * sizeof(unsigned short));
+
+	unsigned short live[kMeshletMaxVertices];
+	memset(live, 0, vertex_count * sizeof(unsigned short));
+
+	for (size_t i = 0; i < triangle_count * 3; ++i)
+	{
+		assert(indices[i] < vertex_count);
+		live[indices[i]]++;
+	}
+
+	const unsigned int cache_size = kMeshletCacheSize;
+	unsigned int timestamp = cache_size + 1;
+
+	// the builder order is often good already; we keep it when the greedy reordering doesn't reduce the number of cache misses
+	unsigned char original[kMeshletMaxTriangles * 3];
+	memcpy(original, indices, triangle_count * 3);
+
+	unsigned int original_misses = 0;
+
+	for (size_t i = 0; i < triangle_count * 3; ++i)
+	{
+		unsigned char v = indices[i];
+
+		if (timestamp - timestamps[v] > cache_size)
 		{
-			meshlet_offset++;
-			memset(&meshlet_cone_acc, 0, sizeof(meshlet_cone_acc));
+			timestamps[v] = (unsigned short)timestamp++;
+			original_misses++;
 		}
+	}
 
-		live_triangles[a]--;
-		live_triangles[b]--;
-		live_triangles[c]--;
+	// reset cache
+	timestamp += cache_size + 1;
 
-		// remove emitted triangle from adjacency data
-		// this makes sure that we spend less time traversing these lists on subsequent iterations
-		for (size_t k = 0; k < 3; ++k)
-		{
-			unsigned int index = indices[best_triangle * 3 + k];
+	unsigned int start = timestamp;
 
-			unsigned int* neighbours = &adjacency.data[0] + adjacency.offsets[index];
-			size_t neighbours_size = adjacency.counts[index];
+	for (size_t i = 0; i < triangle_count; ++i)
+	{
+		size_t best = i;
+		int best_score = -1;
 
-			for (size_t i = 0; i < neighbours_size; ++i)
+		for (size_t j = i; j < triangle_count; ++j)
+		{
+			int score = 0;
+
+			for (int k = 0; k < 3; ++k)
 			{
-				unsigned int tri = neighbours[i];
+				unsigned char v = indices[j * 3 + k];
 
-				if (tri == best_triangle)
-				{
-					neighbours[i] = neighbours[neighbours_size - 1];
-					adjacency.counts[index]--;
-					break;
-				}
+				score += (timestamp - timestamps[v] <= cache_size) * 3 + (live[v] == 1);
+			}
+
+			// prefer earlier triangles on ties to keep the spatial order of the builder
+			if (score > best_score)
+			{
+				best = j;
+				best_score = score;
 			}
 		}
 
-		// update aggregated meshlet cone data for scoring subsequent triangles
-		meshlet_cone_acc.px += triangles[best_triangle].px;
-		meshlet_cone_acc.py += triangles[best_triangle].py;
-		meshlet_cone_acc.pz += triangles[best_triangle].pz;
-		meshlet_cone_acc.nx += triangles[best_triangle].nx;
-		meshlet_cone_acc.ny += triangles[best_triangle].ny;
-		meshlet_cone_acc.nz += triangles[best_triangle].nz;
+		if (best != i)
+		{
+			unsigned char t0 = indices[best * 3 + 0], t1 = indices[best * 3 + 1], t2 = indices[best * 3 + 2];
 
-		emitted_flags[best_triangle] = 1;
+			// shift triangles instead of swapping to keep the relative order of the remaining ones
+			memmove(&indices[i * 3 + 3], &indices[i * 3], (best - i) * 3);
+
+			indices[i * 3 + 0] = t0;
+			indices[i * 3 + 1] = t1;
+			indices[i * 3 + 2] = t2;
+		}
+
+		for (int k = 0; k < 3; ++k)
+		{
+			unsigned char v = indices[i * 3 + k];
+
+			if (timestamp - timestamps[v] > cache_size)
+				timestamps[v] = (unsigned short)timestamp++;
+
+			live[v]--;
+		}
 	}
 
-	if (meshlet.triangle_count)
+	// each cache miss advances the timestamp
+	if (timestamp - start >= original_misses)
+		memcpy(indices, original, triangle_count * 3);
+
+	// renumber vertices in the order of first use so that the triangle data refers to vertices sequentially
+	unsigned int order[kMeshletMaxVertices];
+	unsigned char remap[kMeshletMaxVertices];
+	memset(remap, -1, vertex_count);
+
+	size_t vertex_offset = 0;
+
+	for (size_t i = 0; i < triangle_count * 3; ++i)
 	{
-		finishMeshlet(meshlet, meshlet_triangles);
+		unsigned char& r = remap[indices[i]];
 
-		meshlets[meshlet_offset++] = meshlet;
+		if (r == 0xff)
+		{
+			r = (unsigned char)vertex_offset;
+			order[vertex_offset++] = meshlet_vertices[indices[i]];
+		}
+
+		indices[i] = r;
 	}
 
-	assert(meshlet_offset <= meshopt_buildMeshletsBound(index_count, max_vertices, max_triangles));
-	return meshlet_offset;
+	// vertices that are not referenced by any triangle are kept at the end
+	for (size_t i = 0; i < vertex_count; ++i)
+		if (remap[i] == 0xff)
+			order[vertex_offset++] = meshlet_vertices[i];
+
+	assert(vertex_offset == vertex_count);
+	memcpy(meshlet_vertices, order, vertex_count * sizeof(unsigned int));
 }
 
 size_t meshopt_buildMeshletsScan(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, size_t vertex_count, size_t max_vertices, size_t max_triangles)
@@ -694,9 +1955,10 @@ meshopt_Bounds meshopt_computeClusterBounds(const unsigned int* indices, size_t
 
 	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
 
-	// compute triangle normals and gather triangle corners
-	float normals[kMeshletMaxTriangles][3];
-	float corners[kMeshletMaxTriangles][3][3];
+	// compute triangle normals and gather triangle corners; all data is stored in SoA layout
+	float normals[3][kMeshletMaxTriangles];
+	float origins[3][kMeshletMaxTriangles];
+	float corners[3][kMeshletMaxTriangles * 3];
 	size_t triangles = 0;
 
 	for (size_t i = 0; i < index_count; i += 3)
@@ -722,12 +1984,18 @@ meshopt_Bounds meshopt_computeClusterBounds(const unsigned int* indices, size_t
 			continue;
 
 		// record triangle normals & corners for future use; normal and corner 0 define a plane equation
-		normals[triangles][0] = normalx / area;
-		normals[triangles][1] = normaly / area;
-		normals[triangles][2] = normalz / area;
-		memcpy(corners[triangles][0], p0, 3 * sizeof(float));
-		memcpy(corners[triangles][1], p1, 3 * sizeof(float));
-		memcpy(corners[triangles][2], p2, 3 * sizeof(float));
+		normals[0][triangles] = normalx / area;
+		normals[1][triangles] = normaly / area;
+		normals[2][triangles] = normalz / area;
+
+		for (int k = 0; k < 3; ++k)
+		{
+			origins[k][triangles] = p0[k];
+			corners[k][triangles * 3 + 0] = p0[k];
+			corners[k][triangles * 3 + 1] = p1[k];
+			corners[k][triangles * 3 + 2] = p2[k];
+		}
+
 		triangles++;
 	}
 
@@ -738,119 +2006,226 @@ meshopt_Bounds meshopt_computeClusterBounds(const unsigned int* indices, size_t
 		return bounds;
 
 	// compute cluster bounding sphere; we'll use the center to determine normal cone apex as well
+	const float* corner_streams[3] = {corners[0], corners[1], corners[2]};
+
 	float psphere[4] = {};
-	computeBoundingSphere(psphere, corners[0], triangles * 3);
+	computeBoundingSphere(psphere, corner_streams, triangles * 3);
 
-	float center[3] = {psphere[0], psphere[1], psphere[2]};
+	const float* normal_streams[3] = {normals[0], normals[1], normals[2]};
+	const float* origin_streams[3] = {origins[0], origins[1], origins[2]};
 
-	// treating triangle normals as points, find the bounding sphere - the sphere center determines the optimal cone axis
-	float nsphere[4] = {};
-	computeBoundingSphere(nsphere, normals, triangles);
+	computeClusterCone(bounds, psphere, normal_streams, origin_streams, triangles);
 
-	float axis[3] = {nsphere[0], nsphere[1], nsphere[2]};
-	float axislength = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
-	float invaxislength = axislength == 0.f ? 0.f : 1.f / axislength;
+	return bounds;
+}
 
-	axis[0] *= invaxislength;
-	axis[1] *= invaxislength;
-	axis[2] *= invaxislength;
+meshopt_Bounds meshopt_computeMeshletBounds(const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, size_t triangle_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
+{
+	using namespace meshopt;
 
-	// compute a tight cone around all normals, mindp = cos(angle/2)
-	float mindp = 1.f;
+	assert(triangle_count <= kMeshletMaxTriangles);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+
+	unsigned int indices[kMeshletMaxTriangles * 3];
 
-	for (size_t i = 0; i < triangles; ++i)
+	for (size_t i = 0; i < triangle_count * 3; ++i)
 	{
-		float dp = normals[i][0] * axis[0] + normals[i][1] * axis[1] + normals[i][2] * axis[2];
+		unsigned int index = meshlet_vertices[meshlet_triangles[i]];
+		assert(index < vertex_count);
 
-		mindp = (dp < mindp) ? dp : mindp;
+		indices[i] = index;
 	}
 
-	// fill bounding sphere info; note that below we can return bounds without cone information for degenerate cones
-	bounds.center[0] = center[0];
-	bounds.center[1] = center[1];
-	bounds.center[2] = center[2];
-	bounds.radius = psphere[3];
+	return meshopt_computeClusterBounds(indices, triangle_count * 3, vertex_positions, vertex_count, vertex_positions_stride);
+}
 
-	// degenerate cluster, normal cone is larger than a hemisphere => trivial accept
-	// note that if mindp is positive but close to 0, the triangle intersection code below gets less stable
-	// we arbitrarily decide that if a normal cone is ~168 degrees wide or more, the cone isn't useful
-	if (mindp <= 0.1f)
-	{
-		bounds.cone_cutoff = 1;
-		bounds.cone_cutoff_s8 = 127;
-		return bounds;
-	}
+void meshopt_computeMeshletBoundsBatch(meshopt_Bounds* destination, const meshopt_Meshlet* meshlets, size_t meshlet_count, const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
+{
+	using namespace meshopt;
 
-	float maxt = 0;
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
 
-	// we need to find the point on center-t*axis ray that lies in negative half-space of all triangles
-	for (size_t i = 0; i < triangles; ++i)
+	(void)vertex_count;
+
+	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+
+	meshopt_Tracer zone("meshopt_computeMeshletBoundsBatch");
+
+	// all data is stored in SoA layout; scratch arrays are reused for all meshlets
+	float positions[3][kMeshletMaxVertices];
+	float points[3][kMeshletMaxVertices];
+	unsigned char used[kMeshletMaxVertices];
+
+	float normals[3][kMeshletMaxTriangles];
+	float origins[3][kMeshletMaxTriangles];
+
+	const float* point_streams[3] = {points[0], points[1], points[2]};
+	const float* normal_streams[3] = {normals[0], normals[1], normals[2]};
+	const float* origin_streams[3] = {origins[0], origins[1], origins[2]};
+
+	for (size_t m = 0; m < meshlet_count; ++m)
 	{
-		// dot(center-t*axis-corner, trinormal) = 0
-		// dot(center-corner, trinormal) - t * dot(axis, trinormal) = 0
-		float cx = center[0] - corners[i][0][0];
-		float cy = center[1] - corners[i][0][1];
-		float cz = center[2] - corners[i][0][2];
+		const meshopt_Meshlet& meshlet = meshlets[m];
+		assert(meshlet.vertex_count <= kMeshletMaxVertices && meshlet.triangle_count <= kMeshletMaxTriangles);
 
-		float dc = cx * normals[i][0] + cy * normals[i][1] + cz * normals[i][2];
-		float dn = axis[0] * normals[i][0] + axis[1] * normals[i][1] + axis[2] * normals[i][2];
+		const unsigned int* vertices = &meshlet_vertices[meshlet.vertex_offset];
+		const unsigned char* indices = &meshlet_triangles[meshlet.triangle_offset];
 
-		// dn should be larger than mindp cutoff above
-		assert(dn > 0.f);
-		float t = dc / dn;
+		// gather meshlet vertex positions once; triangles then refer to them by local index
+		for (size_t i = 0; i < meshlet.vertex_count; ++i)
+		{
+			unsigned int index = vertices[i];
+			assert(index < vertex_count);
 
-		maxt = (t > maxt) ? t : maxt;
-	}
+			const float* p = vertex_positions + vertex_stride_float * index;
 
-	// cone apex should be in the negative half-space of all cluster triangles by construction
-	bounds.cone_apex[0] = center[0] - axis[0] * maxt;
-	bounds.cone_apex[1] = center[1] - axis[1] * maxt;
-	bounds.cone_apex[2] = center[2] - axis[2] * maxt;
+			positions[0][i] = p[0];
+			positions[1][i] = p[1];
+			positions[2][i] = p[2];
+		}
 
-	// note: this axis is the axis of the normal cone, but our test for perspective camera effectively negates the axis
-	bounds.cone_axis[0] = axis[0];
-	bounds.cone_axis[1] = axis[1];
-	bounds.cone_axis[2] = axis[2];
+		memset(used, 0, meshlet.vertex_count);
 
-	// cos(a) for normal cone is mindp; we need to add 90 degrees on both sides and invert the cone
-	// which gives us -cos(a+90) = -(-sin(a)) = sin(a) = sqrt(1 - cos^2(a))
-	bounds.cone_cutoff = sqrtf(1 - mindp * mindp);
+		size_t triangles = 0;
+		size_t i = 0;
 
-	// quantize axis & cutoff to 8-bit SNORM format
-	bounds.cone_axis_s8[0] = (signed char)(meshopt_quantizeSnorm(bounds.cone_axis[0], 8));
-	bounds.cone_axis_s8[1] = (signed char)(meshopt_quantizeSnorm(bounds.cone_axis[1], 8));
-	bounds.cone_axis_s8[2] = (signed char)(meshopt_quantizeSnorm(bounds.cone_axis[2], 8));
+#ifdef SIMD_SSE
+		// compute normals for 4 triangles at a time; degenerate triangles are rare so the results are compacted only when necessary
+		for (; i + 4 <= meshlet.triangle_count; i += 4)
+		{
+			const unsigned char* tri = &indices[i * 3];
 
-	// for the 8-bit test to be conservative, we need to adjust the cutoff by measuring the max. error
-	float cone_axis_s8_e0 = fabsf(bounds.cone_axis_s8[0] / 127.f - bounds.cone_axis[0]);
-	float cone_axis_s8_e1 = fabsf(bounds.cone_axis_s8[1] / 127.f - bounds.cone_axis[1]);
-	float cone_axis_s8_e2 = fabsf(bounds.cone_axis_s8[2] / 127.f - bounds.cone_axis[2]);
+			__m128 ax = _mm_setr_ps(positions[0][tri[0]], positions[0][tri[3]], positions[0][tri[6]], positions[0][tri[9]]);
+			__m128 ay = _mm_setr_ps(positions[1][tri[0]], positions[1][tri[3]], positions[1][tri[6]], positions[1][tri[9]]);
+			__m128 az = _mm_setr_ps(positions[2][tri[0]], positions[2][tri[3]], positions[2][tri[6]], positions[2][tri[9]]);
 
-	// note that we need to round this up instead of rounding to nearest, hence +1
-	int cone_cutoff_s8 = int(127 * (bounds.cone_cutoff + cone_axis_s8_e0 + cone_axis_s8_e1 + cone_axis_s8_e2) + 1);
+			__m128 p10x = _mm_sub_ps(_mm_setr_ps(positions[0][tri[1]], positions[0][tri[4]], positions[0][tri[7]], positions[0][tri[10]]), ax);
+			__m128 p10y = _mm_sub_ps(_mm_setr_ps(positions[1][tri[1]], positions[1][tri[4]], positions[1][tri[7]], positions[1][tri[10]]), ay);
+			__m128 p10z = _mm_sub_ps(_mm_setr_ps(positions[2][tri[1]], positions[2][tri[4]], positions[2][tri[7]], positions[2][tri[10]]), az);
 
-	bounds.cone_cutoff_s8 = (cone_cutoff_s8 > 127) ? 127 : (signed char)(cone_cutoff_s8);
+			__m128 p20x = _mm_sub_ps(_mm_setr_ps(positions[0][tri[2]], positions[0][tri[5]], positions[0][tri[8]], positions[0][tri[11]]), ax);
+			__m128 p20y = _mm_sub_ps(_mm_setr_ps(positions[1][tri[2]], positions[1][tri[5]], positions[1][tri[8]], positions[1][tri[11]]), ay);
+			__m128 p20z = _mm_sub_ps(_mm_setr_ps(positions[2][tri[2]], positions[2][tri[5]], positions[2][tri[8]], positions[2][tri[11]]), az);
 
-	return bounds;
+			__m128 normalx = _mm_sub_ps(_mm_mul_ps(p10y, p20z), _mm_mul_ps(p10z, p20y));
+			__m128 normaly = _mm_sub_ps(_mm_mul_ps(p10z, p20x), _mm_mul_ps(p10x, p20z));
+			__m128 normalz = _mm_sub_ps(_mm_mul_ps(p10x, p20y), _mm_mul_ps(p10y, p20x));
+
+			__m128 area = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(normalx, normalx), _mm_mul_ps(normaly, normaly)), _mm_mul_ps(normalz, normalz)));
+
+			_mm_storeu_ps(&normals[0][triangles], _mm_div_ps(normalx, area));
+			_mm_storeu_ps(&normals[1][triangles], _mm_div_ps(normaly, area));
+			_mm_storeu_ps(&normals[2][triangles], _mm_div_ps(normalz, area));
+
+			_mm_storeu_ps(&origins[0][triangles], ax);
+			_mm_storeu_ps(&origins[1][triangles], ay);
+			_mm_storeu_ps(&origins[2][triangles], az);
+
+			int degenerate = _mm_movemask_ps(_mm_cmpeq_ps(area, _mm_setzero_ps()));
+			size_t base = triangles;
+
+			for (int k = 0; k < 4; ++k)
+			{
+				unsigned char a = tri[k * 3 + 0], b = tri[k * 3 + 1], c = tri[k * 3 + 2];
+				assert(a < meshlet.vertex_count && b < meshlet.vertex_count && c < meshlet.vertex_count);
+
+				// no need to include degenerate triangles - they will be invisible anyway
+				if (degenerate & (1 << k))
+					continue;
+
+				// move the results over the skipped degenerate triangles
+				if (degenerate)
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						normals[axis][triangles] = normals[axis][base + k];
+						origins[axis][triangles] = origins[axis][base + k];
+					}
+
+				triangles++;
+
+				used[a] = used[b] = used[c] = 1;
+			}
+		}
+#endif
+
+		for (; i < meshlet.triangle_count; ++i)
+		{
+			unsigned char a = indices[i * 3 + 0], b = indices[i * 3 + 1], c = indices[i * 3 + 2];
+			assert(a < meshlet.vertex_count && b < meshlet.vertex_count && c < meshlet.vertex_count);
+
+			float p10[3] = {positions[0][b] - positions[0][a], positions[1][b] - positions[1][a], positions[2][b] - positions[2][a]};
+			float p20[3] = {positions[0][c] - positions[0][a], positions[1][c] - positions[1][a], positions[2][c] - positions[2][a]};
+
+			float normalx = p10[1] * p20[2] - p10[2] * p20[1];
+			float normaly = p10[2] * p20[0] - p10[0] * p20[2];
+			float normalz = p10[0] * p20[1] - p10[1] * p20[0];
+
+			float area = sqrtf(normalx * normalx + normaly * normaly + normalz * normalz);
+
+			// no need to include degenerate triangles - they will be invisible anyway
+			if (area == 0.f)
+				continue;
+
+			normals[0][triangles] = normalx / area;
+			normals[1][triangles] = normaly / area;
+			normals[2][triangles] = normalz / area;
+
+			origins[0][triangles] = positions[0][a];
+			origins[1][triangles] = positions[1][a];
+			origins[2][triangles] = positions[2][a];
+
+			triangles++;
+
+			used[a] = used[b] = used[c] = 1;
+		}
+
+		meshopt_Bounds bounds = {};
+
+		// degenerate cluster, no valid triangles => trivial reject (cone data is 0)
+		if (triangles)
+		{
+			// bounding sphere only needs to include each vertex once, which is ~3x fewer points than triangle corners
+			size_t point_count = 0;
+
+			for (size_t j = 0; j < meshlet.vertex_count; ++j)
+			{
+				points[0][point_count] = positions[0][j];
+				points[1][point_count] = positions[1][j];
+				points[2][point_count] = positions[2][j];
+				point_count += used[j];
+			}
+
+			float psphere[4] = {};
+			computeBoundingSphere(psphere, point_streams, point_count);
+
+			computeClusterCone(bounds, psphere, normal_streams, origin_streams, triangles);
+		}
+
+		destination[m] = bounds;
+	}
 }
 
-meshopt_Bounds meshopt_computeMeshletBounds(const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, size_t triangle_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
+size_t meshopt_buildMeshletBVH(meshopt_MeshletBVHNode* nodes, unsigned int* meshlet_indices, const meshopt_Bounds* bounds, size_t meshlet_count, size_t node_width, size_t leaf_size, unsigned int options)
 {
 	using namespace meshopt;
 
-	assert(triangle_count <= kMeshletMaxTriangles);
-	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
-	assert(vertex_positions_stride % sizeof(float) == 0);
+	assert(node_width >= 2 && node_width <= kMeshletBVHMaxWidth);
+	assert(leaf_size >= 1);
+	assert(sizeof(meshopt_Bounds) % sizeof(float) == 0);
 
-	unsigned int indices[kMeshletMaxTriangles * 3];
+	meshopt_Tracer zone("meshopt_buildMeshletBVH");
 
-	for (size_t i = 0; i < triangle_count * 3; ++i)
-	{
-		unsigned int index = meshlet_vertices[meshlet_triangles[i]];
-		assert(index < vertex_count);
+	for (size_t i = 0; i < meshlet_count; ++i)
+		meshlet_indices[i] = unsigned(i);
 
-		indices[i] = index;
-	}
+	size_t node_count = 1;
+	bvhBuild(nodes, node_count, 0, meshlet_indices, 0, meshlet_count, bounds, node_width, leaf_size, options, 0);
 
-	return meshopt_computeClusterBounds(indices, triangle_count * 3, vertex_positions, vertex_count, vertex_positions_stride);
+	assert(node_count <= (meshlet_count > 0 ? meshlet_count * 2 - 1 : 1));
+
+	meshopt_Tracer::counter("buildMeshletBVH.nodes", double(node_count));
+
+	return node_count;
 }
@@ -167,6 +167,8 @@ size_t meshopt_encodeIndexBuffer(unsigned char* buffer, size_t buffer_size, cons
 
 	assert(index_count % 3 == 0);
 
+	meshopt_Tracer zone("meshopt_encodeIndexBuffer");
+
 	// the minimum valid encoding is header, 1 byte per triangle and a 16-byte codeaux table
 	if (buffer_size < 1 + index_count / 3 + 16)
 		return 0;
@@ -333,6 +335,8 @@ size_t meshopt_encodeIndexBuffer(unsigned char* buffer, size_t buffer_size, cons
 	assert(data >= buffer + index_count / 3 + 16);
 	assert(data <= buffer + buffer_size);
 
+	meshopt_Tracer::counter("encodeIndexBuffer.bytes", double(data - buffer));
+
 	return data - buffer;
 }
 
@@ -366,6 +370,8 @@ int meshopt_decodeIndexBuffer(void* destination, size_t index_count, size_t inde
 	assert(index_count % 3 == 0);
 	assert(index_size == 2 || index_size == 4);
 
+	meshopt_Tracer zone("meshopt_decodeIndexBuffer");
+
 	// the minimum valid encoding is header, 1 byte per triangle and a 16-byte codeaux table
 	if (buffer_size < 1 + index_count / 3 + 16)
 		return -2;
@@ -550,6 +556,8 @@ size_t meshopt_encodeIndexSequence(unsigned char* buffer, size_t buffer_size, co
 {
 	using namespace meshopt;
 
+	meshopt_Tracer zone("meshopt_encodeIndexSequence");
+
 	// the minimum valid encoding is header, 1 byte per index and a 4-byte tail
 	if (buffer_size < 1 + index_count + 4)
 		return 0;
@@ -598,6 +606,8 @@ size_t meshopt_encodeIndexSequence(unsigned char* buffer, size_t buffer_size, co
 	for (int k = 0; k < 4; ++k)
 		*data++ = 0;
 
+	meshopt_Tracer::counter("encodeIndexSequence.bytes", double(data - buffer));
+
 	return data - buffer;
 }
 
@@ -619,6 +629,8 @@ int meshopt_decodeIndexSequence(void* destination, size_t index_count, size_t in
 {
 	using namespace meshopt;
 
+	meshopt_Tracer zone("meshopt_decodeIndexSequence");
+
 	// the minimum valid encoding is header, 1 byte per index and a 4-byte tail
 	if (buffer_size < 1 + index_count + 4)
 		return -2;
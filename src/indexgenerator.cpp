@@ -183,6 +183,11 @@ static void buildPositionRemap(unsigned int* remap, const float* vertex_position
 } // namespace meshopt
 
 size_t meshopt_generateVertexRemap(unsigned int* destination, const unsigned int* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size)
+{
+	return meshopt_generateVertexRemapWithContext(NULL, destination, indices, index_count, vertices, vertex_count, vertex_size);
+}
+
+size_t meshopt_generateVertexRemapWithContext(meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size)
 {
 	using namespace meshopt;
 
@@ -190,7 +195,10 @@ size_t meshopt_generateVertexRemap(unsigned int* destination, const unsigned int
 	assert(!indices || index_count % 3 == 0);
 	assert(vertex_size > 0 && vertex_size <= 256);
 
-	meshopt_Allocator allocator;
+	meshopt_Tracer zone("meshopt_generateVertexRemap");
+	meshopt_Allocator allocator(context);
+
+	allocator.stage("hash");
 
 	memset(destination, -1, vertex_count * sizeof(unsigned int));
 
@@ -231,6 +239,14 @@ size_t meshopt_generateVertexRemap(unsigned int* destination, const unsigned int
 	return next_vertex;
 }
 
+size_t meshopt_generateVertexRemapScratchSize(size_t vertex_count)
+{
+	using namespace meshopt;
+
+	// this needs to match the allocation sequence in meshopt_generateVertexRemapWithContext
+	return meshopt_Allocator::scratchSize<unsigned int>(0, hashBuckets(vertex_count));
+}
+
 size_t meshopt_generateVertexRemapMulti(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const struct meshopt_Stream* streams, size_t stream_count)
 {
 	using namespace meshopt;
@@ -47,6 +47,78 @@ struct meshopt_Stream
 	size_t stride;
 };
 
+/**
+ * Experimental: Execution statistics
+ * Filled by functions that accept meshopt_Context when the context has a non-NULL stats pointer; values describe the most recent call.
+ *
+ * peak_bytes is the amount of temporary memory used by the call, including memory served from scratch memory; it matches the value returned by
+ * the corresponding ScratchSize function (e.g. meshopt_simplifyScratchSize) for functions that have one, or does not exceed it when the function
+ * documents the value as an upper bound.
+ * allocation_count is the number of allocations performed by the call; allocations served from scratch memory are not counted.
+ * stage_names and stage_times contain the name and wall time in seconds of each algorithm stage, in execution order.
+ * Statistics are reset when the outermost call starts; nested calls made with the same context (for example, the individual steps of meshopt_optimizeMeshWithContext,
+ * or calls made from a progress callback) add their allocations and stages to the statistics of the outermost call, and peak_bytes covers all of them.
+ * The time of a stage includes the time spent in nested calls made during that stage.
+ */
+struct meshopt_Stats
+{
+	size_t peak_bytes;
+	size_t allocation_count;
+
+	size_t stage_count;
+	const char* stage_names[8];
+	double stage_times[8];
+};
+
+/**
+ * Experimental: Execution context
+ * Optional per-call state that can be passed to long-running algorithms via their WithContext variants.
+ * The structure should be zero-initialized; all fields are optional. A context must not be used by multiple threads at the same time.
+ *
+ * progress, when not NULL, is called periodically (between simplification passes, or after each meshlet is completed) with userdata, the fraction
+ * of work done in [0..1], the size of the current result (index count for simplification, meshlet count for meshlet building) and the current
+ * relative error (0 for meshlet building). Returning 0 from the callback cancels the operation, in which case the function returns the best result
+ * computed so far; the result is always valid output that can be used in place of the full result.
+ *
+ * allocate and deallocate, when not NULL, are used with userdata for all memory allocations made by the call instead of the global allocator set via
+ * meshopt_setAllocator; this makes it possible to route different threads to different allocators. Both callbacks must be set together, and they must
+ * not change while the context owns scratch memory. Similarly to meshopt_setAllocator, deallocations happen in a stack-like order, with the exception of
+ * scratch memory which outlives the call.
+ *
+ * scratch and scratch_size are managed by the library: temporary memory needed by each call is carved out of the scratch block, which grows to fit
+ * the largest call made so far and is reused by subsequent calls. Creating one context per thread and reusing it for all meshes removes allocations
+ * from the steady state. Scratch memory is released via meshopt_freeContext.
+ * scratch_used, scratch_peak and call_depth are also managed by the library: scratch_used tracks scratch memory used by calls that are in progress,
+ * so that a nested call made with the same context (for example, from a progress callback) allocates after the memory of the outer call instead of
+ * overlapping it; memory of a nested call is reused by the next nested call once it returns. Nested calls never release or grow scratch memory; the
+ * outermost call does that when it returns, based on the high water mark of all nested calls in scratch_peak. This is not a substitute for
+ * synchronization: concurrent calls with the same context from different threads are not supported.
+ *
+ * stats, when not NULL, receives statistics for each call; see meshopt_Stats.
+ */
+struct meshopt_Context
+{
+	int (*progress)(void* userdata, float fraction, size_t count, float error);
+	void* userdata;
+
+	void* (*allocate)(void* userdata, size_t size);
+	void (*deallocate)(void* userdata, void* ptr);
+
+	void* scratch;
+	size_t scratch_size;
+	size_t scratch_used;
+	size_t scratch_peak;
+	unsigned int call_depth;
+
+	struct meshopt_Stats* stats;
+};
+
+/**
+ * Experimental: Releases scratch memory owned by the context
+ * The context is left in a zero-initialized state and can be reused afterwards.
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_freeContext(struct meshopt_Context* context);
+
 /**
  * Generates a vertex remap table from the vertex buffer and an optional index buffer and returns number of unique vertices
  * As a result, all vertices that are binary equivalent map to the same (new) location, with no gaps in the resulting sequence.
@@ -58,6 +130,19 @@ struct meshopt_Stream
  */
 MESHOPTIMIZER_API size_t meshopt_generateVertexRemap(unsigned int* destination, const unsigned int* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size);
 
+/**
+ * Experimental: Equivalent to meshopt_generateVertexRemap, but uses scratch memory from context; see meshopt_Context.
+ *
+ * context can be NULL
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_generateVertexRemapWithContext(struct meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size);
+
+/**
+ * Experimental: Returns the amount of temporary memory in bytes that meshopt_generateVertexRemapWithContext needs for a given vertex count
+ * A call made with a context that has at least this much scratch memory does not allocate.
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_generateVertexRemapScratchSize(size_t vertex_count);
+
 /**
  * Generates a vertex remap table from multiple vertex streams and an optional index buffer and returns number of unique vertices
  * As a result, all vertices that are binary equivalent map to the same (new) location, with no gaps in the resulting sequence.
@@ -144,6 +229,27 @@ MESHOPTIMIZER_API void meshopt_generateTessellationIndexBuffer(unsigned int* des
  */
 MESHOPTIMIZER_API void meshopt_optimizeVertexCache(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count);
 
+/**
+ * Experimental: Equivalent to meshopt_optimizeVertexCache, but uses scratch memory from context; see meshopt_Context.
+ *
+ * context can be NULL
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_optimizeVertexCacheWithContext(struct meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count);
+
+/**
+ * Experimental: Vertex transform cache optimizer for large meshes
+ * Splits the mesh into spatially coherent chunks of up to chunk_triangles triangles (see meshopt_partitionMeshletRegions) and optimizes each chunk separately.
+ * Peak temporary memory is 20 bytes per triangle while partitioning, and 4 bytes per vertex plus memory proportional to the chunk size while optimizing chunks;
+ * this is less than meshopt_optimizeVertexCache needs (16 bytes per vertex and up to 29 bytes per triangle). Each chunk starts with a cold cache, which slightly increases ACMR.
+ * Returns the number of vertices that need to be transformed again because they are shared between chunks (counted once per extra chunk); the ACMR penalty of chunking is approximately result / (index_count / 3).
+ * To optimize chunks on multiple threads, partition the mesh with meshopt_partitionMeshletRegions and call meshopt_optimizeVertexCache on each region.
+ *
+ * destination must contain enough space for the resulting index buffer (index_count elements)
+ * vertex_positions should have float3 position in the first 12 bytes of each vertex
+ * chunk_triangles should be large enough for the cache optimizer to be effective; 64K triangles or more is recommended
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_optimizeVertexCacheChunked(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t chunk_triangles);
+
 /**
  * Vertex transform cache optimizer for strip-like caches
  * Produces inferior results to meshopt_optimizeVertexCache from the GPU vertex cache perspective
@@ -153,6 +259,13 @@ MESHOPTIMIZER_API void meshopt_optimizeVertexCache(unsigned int* destination, co
  */
 MESHOPTIMIZER_API void meshopt_optimizeVertexCacheStrip(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count);
 
+/**
+ * Experimental: Equivalent to meshopt_optimizeVertexCacheStrip, but uses scratch memory from context; see meshopt_Context.
+ *
+ * context can be NULL
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_optimizeVertexCacheStripWithContext(struct meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count);
+
 /**
  * Vertex transform cache optimizer for FIFO caches
  * Reorders indices to reduce the number of GPU vertex shader invocations
@@ -164,6 +277,25 @@ MESHOPTIMIZER_API void meshopt_optimizeVertexCacheStrip(unsigned int* destinatio
  */
 MESHOPTIMIZER_API void meshopt_optimizeVertexCacheFifo(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, unsigned int cache_size);
 
+struct meshopt_VertexScoreTable
+{
+	/* score of a vertex based on its position in the 16-entry cache model; cache[0] is used for vertices that are not in the cache, cache[1 + i] for cache position i (0 is most recent) */
+	float cache[17];
+
+	/* score of a vertex based on the number of triangles that still use it; live[0] is unused, live[i] is used for i remaining triangles, and live[8] for 8 or more */
+	float live[9];
+};
+
+/**
+ * Experimental: Vertex transform cache optimizer with custom vertex scoring
+ * Equivalent to meshopt_optimizeVertexCache, but uses a custom score table instead of the built-in one; this can be used to tune the ordering for specific hardware.
+ * Tables can be generated with tools/vcachetuner.cpp, and the result can be evaluated with meshopt_analyzeVertexCache using the target cache parameters.
+ *
+ * destination must contain enough space for the resulting index buffer (index_count elements)
+ * table scores are added together for each vertex, and triangles with the largest sum of vertex scores are emitted first
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_optimizeVertexCacheTable(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const struct meshopt_VertexScoreTable* table);
+
 /**
  * Overdraw optimizer
  * Reorders indices to reduce the number of GPU vertex shader invocations and the pixel overdraw
@@ -176,6 +308,27 @@ MESHOPTIMIZER_API void meshopt_optimizeVertexCacheFifo(unsigned int* destination
  */
 MESHOPTIMIZER_API void meshopt_optimizeOverdraw(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, float threshold);
 
+/**
+ * Experimental: Equivalent to meshopt_optimizeOverdraw, but uses scratch memory from context; see meshopt_Context.
+ *
+ * context can be NULL
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_optimizeOverdrawWithContext(struct meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, float threshold);
+
+/**
+ * Experimental: View-dependent overdraw optimizer
+ * Reorders indices like meshopt_optimizeOverdraw, but produces view_count orderings that sort the same clusters front to back for each view direction.
+ * All orderings are permutations of the same triangles, so they share the vertex buffer and have the same vertex cache efficiency; at runtime, the
+ * ordering with the direction closest to the camera view direction should be used.
+ *
+ * destination must contain enough space for view_count resulting index buffers (view_count * index_count elements); ordering k starts at destination + k * index_count
+ * indices must contain index data that is the result of meshopt_optimizeVertexCache (*not* the original mesh indices!)
+ * vertex_positions should have float3 position in the first 12 bytes of each vertex
+ * view_directions should contain view_count float3 directions the camera looks along; directions do not need to be normalized
+ * threshold indicates how much the overdraw optimizer can degrade vertex cache efficiency (1.05 = up to 5%) to reduce overdraw more efficiently
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_optimizeOverdrawMulti(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, float threshold);
+
 /**
  * Vertex fetch cache optimizer
  * Reorders vertices and changes indices to reduce the amount of GPU memory fetches during vertex processing
@@ -187,6 +340,13 @@ MESHOPTIMIZER_API void meshopt_optimizeOverdraw(unsigned int* destination, const
  */
 MESHOPTIMIZER_API size_t meshopt_optimizeVertexFetch(void* destination, unsigned int* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size);
 
+/**
+ * Experimental: Equivalent to meshopt_optimizeVertexFetch, but uses scratch memory from context; see meshopt_Context.
+ *
+ * context can be NULL
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_optimizeVertexFetchWithContext(struct meshopt_Context* context, void* destination, unsigned int* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size);
+
 /**
  * Vertex fetch cache optimizer
  * Generates vertex remap to reduce the amount of GPU memory fetches during vertex processing
@@ -197,6 +357,48 @@ MESHOPTIMIZER_API size_t meshopt_optimizeVertexFetch(void* destination, unsigned
  */
 MESHOPTIMIZER_API size_t meshopt_optimizeVertexFetchRemap(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count);
 
+/**
+ * Experimental: Vertex fetch cache optimizer for split vertex streams
+ * Generates vertex remap that reduces GPU memory fetches both for the full pass that uses indices and all vertex streams, and for the depth or shadow pass
+ * that uses shadow_indices generated by meshopt_generateShadowIndexBuffer and only a subset of vertex streams (for example, positions).
+ * Returns the number of unique vertices referenced by either index buffer
+ * The resulting remap table should be used to reorder all vertex streams using meshopt_remapVertexBuffer, and both index buffers using meshopt_remapIndexBuffer.
+ *
+ * destination must contain enough space for the resulting remap table (vertex_count elements)
+ * shadow_indices must contain index_count elements generated from indices, so that shadow_indices[i] refers to a vertex equivalent to indices[i]
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_optimizeVertexFetchRemapShadow(unsigned int* destination, const unsigned int* indices, const unsigned int* shadow_indices, size_t index_count, size_t vertex_count);
+
+enum
+{
+    /* Optimize triangle order for index compression using meshopt_optimizeVertexCacheStrip instead of meshopt_optimizeVertexCache. */
+    meshopt_OptimizeMeshStrip = 1 << 0,
+    /* Reorder triangles to reduce overdraw after vertex cache optimization using overdraw_threshold; see meshopt_optimizeOverdraw. Requires vertex_positions. */
+    meshopt_OptimizeMeshOverdraw = 1 << 1,
+};
+
+/**
+ * Experimental: Mesh optimization pipeline
+ * Convenience wrapper that runs vertex cache, overdraw (optional) and vertex fetch optimization on an indexed mesh, and remaps all vertex streams in place.
+ * This is equivalent to calling the individual functions in the recommended order followed by meshopt_remapIndexBuffer and meshopt_remapVertexBuffer for each stream.
+ * Returns the number of unique vertices; streams are compacted to that many elements.
+ *
+ * indices are optimized in place
+ * vertex_positions should have float3 position in the first 12 bytes of each vertex; it can be NULL unless meshopt_OptimizeMeshOverdraw is used, and it may point into one of the streams
+ * streams must contain stream_count pointers to tightly packed vertex data (vertex_count elements each); stream_sizes contains the size of each element in bytes (up to 256)
+ * options must be a bitmask composed of meshopt_OptimizeMeshX options; 0 is a safe default
+ * overdraw_threshold is passed to meshopt_optimizeOverdraw and is ignored unless meshopt_OptimizeMeshOverdraw is used; 1.05 is a reasonable default
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_optimizeMesh(unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, void* const* streams, const size_t* stream_sizes, size_t stream_count, unsigned int options, float overdraw_threshold);
+
+/**
+ * Experimental: Equivalent to meshopt_optimizeMesh, but uses scratch memory from context for all stages; see meshopt_Context.
+ * Passing the same context to multiple calls avoids reallocating scratch memory for every mesh.
+ *
+ * context can be NULL
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_optimizeMeshWithContext(struct meshopt_Context* context, unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, void* const* streams, const size_t* stream_sizes, size_t stream_count, unsigned int options, float overdraw_threshold);
+
 /**
  * Index buffer encoder
  * Encodes index data into an array of bytes that is generally much smaller (<1.5 bytes/triangle) and compresses better (<1 bytes/triangle) compared to original.
@@ -319,6 +521,8 @@ enum
 {
     /* Do not move vertices that are located on the topological border (vertices on triangle edges that don't have a paired triangle). Useful for simplifying portions of the larger mesh. */
     meshopt_SimplifyLockBorder = 1 << 0,
+    /* Experimental: Perform collapses one at a time in the order of increasing error, using a priority queue that re-ranks the neighborhood of each collapsed vertex. Produces lower error for the same triangle count; typically 2-5x slower than the default pass-based mode. */
+    meshopt_SimplifyExactOrder = 1 << 1,
 };
 
 /**
@@ -338,6 +542,88 @@ enum
  */
 MESHOPTIMIZER_API size_t meshopt_simplify(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options, float* result_error);
 
+/**
+ * Experimental: Mesh simplifier with attribute metric
+ * The algorithm extends meshopt_simplify by incorporating attribute values into the error metric used to prioritize simplification order; see meshopt_simplify for details.
+ * Unlike position error, attribute error is tracked per vertex (wedge), so collapses across UV/normal/color gradients are priced correctly and attribute discontinuities are preserved.
+ * Note that the number of attributes affects memory requirements and running time; this algorithm requires ~1.5x more memory and time compared to meshopt_simplify when using 4 scalar attributes.
+ *
+ * vertex_attributes should have attribute_count floats for each vertex
+ * attribute_weights should have attribute_count floats in total; the weights determine relative priority of attributes between each other and wrt position. The recommended weight range is [1e-3..1e-1], assuming attribute data is in [0..1] range.
+ * attribute_count must be <= 16
+ * target_error/result_error combine distance and attribute error, with attribute error scaled by the attribute weights
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyWithAttributes(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, size_t target_index_count, float target_error, unsigned int options, float* result_error);
+
+/**
+ * Experimental: Mesh simplifier with per-vertex error output
+ * Equivalent to meshopt_simplify, but additionally outputs the accumulated error for every vertex of the simplified mesh, which makes it possible to compute error bounds for regions of the mesh.
+ * The error of each vertex is the maximum relative error of all collapses that merged source vertices into it; the error of a triangle is the maximum of its vertex errors, and result_error is the maximum of all vertex errors.
+ * Like result_error, vertex errors are relative to the mesh extents; use meshopt_simplifyScale to convert them to absolute errors.
+ *
+ * vertex_errors must contain enough space for vertex_count elements; errors for vertices that are not referenced by the destination index buffer are unspecified
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyWithErrors(unsigned int* destination, float* vertex_errors, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options, float* result_error);
+
+struct meshopt_VertexSplit
+{
+	/* vertex that this vertex is collapsed into in meshes with fewer vertices; equal to the vertex index for base vertices */
+	unsigned int parent;
+
+	/* number of triangles in the mesh with i+1 vertices */
+	unsigned int triangle_count;
+
+	/* relative error of the mesh with i+1 vertices; 0 for the full mesh */
+	float error;
+
+	/* smallest vertex count that is at least i+1 and ends a group of vertices that must be split together; equal to i+1 for base vertices */
+	unsigned int group_end;
+};
+
+/**
+ * Experimental: Progressive mesh generator
+ * Simplifies the mesh like meshopt_simplify, and records the sequence of edge collapses as a progressive mesh that can be refined continuously from the simplified (base) mesh to the source mesh.
+ * Vertices are reordered so that the base vertices come first, followed by the vertices in refinement order; any prefix of N vertices, together with the first splits[N-1].triangle_count triangles, forms a valid mesh
+ * as long as N is not smaller than the number of base vertices (base vertices are the ones with splits[i].parent == i) and N ends a split group (splits[N-1].group_end == N).
+ * All wedges of one position (for example, vertices on both sides of a UV seam) form one group; prefixes that end inside a group are well-formed but may have cracks along seams.
+ * Returns the number of vertices in the progressive mesh; vertices that are not referenced by the index buffer are excluded.
+ *
+ * destination must contain enough space for the source index buffer (index_count elements); triangles are sorted by the vertex count at which they appear, and use the new vertex order
+ * vertex_remap must contain enough space for vertex_count elements; it can be used with meshopt_remapVertexBuffer to reorder the vertex data, and contains ~0u for excluded vertices
+ * splits must contain enough space for vertex_count elements; splits[i] describes vertex i and the mesh with i+1 vertices (see meshopt_VertexSplit)
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyProgressive(unsigned int* destination, unsigned int* vertex_remap, struct meshopt_VertexSplit* splits, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options);
+
+/**
+ * Experimental: Progressive mesh refiner
+ * Updates the index buffer of the progressive mesh from current_vertex_count to vertex_count vertices (refining or coarsening as needed), and returns the resulting index count.
+ * Each call scans all corners of the larger of the two meshes, so its cost is linear in that triangle count even when only a few vertices change; refining writes only the corners of the new triangles and the corners that referenced vertices that were not active yet.
+ *
+ * destination must contain enough space for the index buffer of the mesh with max(current_vertex_count, vertex_count) vertices, and contain the index buffer for current_vertex_count vertices
+ * indices and splits should be the output of meshopt_simplifyProgressive
+ * current_vertex_count can be 0, in which case the index buffer is generated from scratch; vertex_count must not be smaller than the number of base vertices
+ * vertex_count should end a split group (splits[vertex_count-1].group_end == vertex_count) to avoid cracks along seams
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_refineProgressive(unsigned int* destination, const unsigned int* indices, const struct meshopt_VertexSplit* splits, size_t current_vertex_count, size_t vertex_count);
+
+/**
+ * Experimental: Mesh simplifier with execution context
+ * Equivalent to meshopt_simplifyWithAttributes (or meshopt_simplify when attribute_count is 0), but uses scratch memory, reports progress and supports cancellation via context; see meshopt_Context.
+ * When the operation is cancelled, destination contains the result of the last completed simplification pass.
+ *
+ * context can be NULL
+ * vertex_attributes and attribute_weights can be NULL if attribute_count is 0
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyWithContext(struct meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, size_t target_index_count, float target_error, unsigned int options, float* result_error);
+
+/**
+ * Experimental: Returns the amount of temporary memory in bytes that meshopt_simplifyWithContext needs for given input sizes and options
+ * A call made with a context that has at least this much scratch memory does not allocate.
+ *
+ * options must be the same bitmask of meshopt_SimplifyX options that is passed to meshopt_simplifyWithContext
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyScratchSize(size_t index_count, size_t vertex_count, size_t attribute_count, unsigned int options);
+
 /**
  * Experimental: Mesh simplifier (sloppy)
  * Reduces the number of triangles in the mesh, sacrificing mesh appearance for simplification performance
@@ -353,6 +639,20 @@ MESHOPTIMIZER_API size_t meshopt_simplify(unsigned int* destination, const unsig
  */
 MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, float* result_error);
 
+/**
+ * Experimental: Equivalent to meshopt_simplifySloppy, but uses scratch memory from context; see meshopt_Context.
+ * Peak scratch memory is 20 bytes per vertex, a hash table with 1.25-2.5 entries per vertex, 52 bytes per output cell and a hash table of output triangles.
+ *
+ * context can be NULL
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifySloppyWithContext(struct meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, float* result_error);
+
+/**
+ * Experimental: Returns an upper bound on the amount of temporary memory in bytes that meshopt_simplifySloppyWithContext needs for given input sizes
+ * A call made with a context that has at least this much scratch memory does not allocate.
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifySloppyScratchSize(size_t index_count, size_t vertex_count);
+
 /**
  * Experimental: Point cloud simplifier
  * Reduces the number of points in the cloud to reach the given target
@@ -360,10 +660,40 @@ MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifySloppy(unsigned int* destinati
  * The resulting index buffer references vertices from the original vertex buffer.
  * If the original vertex data isn't required, creating a compact vertex buffer using meshopt_optimizeVertexFetch is recommended.
  *
+ * When colors are specified, points are selected to minimize the combined position and color error; color_weight determines relative importance of color deviation relative to position deviation (in units of mesh extent).
+ *
  * destination must contain enough space for the target index buffer (target_vertex_count elements)
  * vertex_positions should have float3 position in the first 12 bytes of each vertex
+ * vertex_colors can be NULL; when it's not NULL, it should have float3 color in the first 12 bytes of each vertex (for single-channel data like intensity, the same value can be used for all channels)
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyPoints(unsigned int* destination, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_colors, size_t vertex_colors_stride, float color_weight, size_t target_vertex_count);
+
+struct meshopt_PointNode
+{
+	/* offset and count of node points within the destination array; points of each node are sorted spatially */
+	unsigned int point_offset;
+	unsigned int point_count;
+
+	/* offset and count of child nodes within the node array; child_count is 0 for leaf nodes */
+	unsigned int child_offset;
+	unsigned int child_count;
+
+	/* node bounds: cube center and half-size */
+	float center[3];
+	float extent;
+};
+
+/**
+ * Experimental: Point cloud hierarchy builder
+ * Builds an octree over the point cloud, where every interior node holds a representative subset of at most max_node_points points selected similarly to meshopt_simplifyPoints.
+ * Each point belongs to exactly one node; rendering a node together with all of its ancestors produces a point cloud with uniform density. Leaf nodes hold all remaining points (nodes deeper than 20 levels are always leaves).
+ * Returns the number of nodes; nodes are stored in breadth-first order, with node 0 being the root. The result for any node only depends on points within its bounds, so large point clouds can be processed in parts by building each subtree separately with root_bounds set to the bounds of that subtree.
+ *
+ * nodes must contain enough space for vertex_count elements (worst case)
+ * destination must contain enough space for vertex_count elements and receives point indices for all nodes
+ * root_bounds can be NULL, in which case the root cube is computed from the point positions; otherwise it should contain center (x, y, z) and half-size of the root cube, and points outside of it are clamped to the nearest node
  */
-MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyPoints(unsigned int* destination, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_vertex_count);
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildPointHierarchy(struct meshopt_PointNode* nodes, unsigned int* destination, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_node_points, const float* root_bounds);
 
 /**
  * Returns the error scaling factor used by the simplifier to convert between absolute and relative extents
@@ -469,6 +799,117 @@ MESHOPTIMIZER_API size_t meshopt_buildMeshlets(struct meshopt_Meshlet* meshlets,
 MESHOPTIMIZER_API size_t meshopt_buildMeshletsScan(struct meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, size_t vertex_count, size_t max_vertices, size_t max_triangles);
 MESHOPTIMIZER_API size_t meshopt_buildMeshletsBound(size_t index_count, size_t max_vertices, size_t max_triangles);
 
+/**
+ * Experimental: Meshlet builder with execution context
+ * Equivalent to meshopt_buildMeshlets, but uses scratch memory, reports progress and supports cancellation via context; see meshopt_Context.
+ * When the operation is cancelled, remaining triangles are packed into meshlets in index order (similarly to meshopt_buildMeshletsScan), so the output always covers the entire mesh.
+ *
+ * context can be NULL
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildMeshletsWithContext(struct meshopt_Context* context, struct meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight);
+
+/**
+ * Experimental: Returns the amount of temporary memory in bytes that meshopt_buildMeshletsWithContext needs for given input sizes
+ * A call made with a context that has at least this much scratch memory does not allocate.
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildMeshletsScratchSize(size_t index_count, size_t vertex_count);
+
+/**
+ * Experimental: Meshlet builder for ray tracing
+ * Splits the mesh into a set of meshlets that are spatially compact, for use as ray tracing cluster acceleration structures or BVH leaves.
+ * Instead of optimizing for normal cone culling, triangles are added to meshlets to minimize the growth of the meshlet bounding box surface area, with a smaller weight on the distance to the meshlet center.
+ * Uses the same output layout, bounds and limits as meshopt_buildMeshlets; meshlets are filled up to max_triangles whenever the topology allows.
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildMeshletsSpatial(struct meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles);
+
+/**
+ * Experimental: Meshlet region partitioning
+ * Reorders triangles into spatially coherent regions of region_triangles triangles each (the last region may be smaller) by recursively splitting the mesh along the largest axis.
+ * Each region can be passed to meshopt_buildMeshlets separately, for example from multiple threads; the resulting meshlets can then be combined with meshopt_mergeMeshlets.
+ * Returns the number of regions; region i covers destination[region_offsets[i]..region_offsets[i + 1]), and triangles within each region keep their relative order.
+ * Temporary memory used by the partitioner is 20 bytes per triangle, including in-place partitioning where destination is equal to indices.
+ *
+ * destination must contain enough space for the resulting index buffer (index_count elements)
+ * region_offsets must contain enough space for the region offsets, which is (index_count / 3 + region_triangles - 1) / region_triangles + 1 elements
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_partitionMeshletRegions(unsigned int* destination, unsigned int* region_offsets, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t region_triangles);
+
+/**
+ * Experimental: Meshlet merging
+ * Merges undersized meshlets (less than half of max_vertices or max_triangles) with neighboring meshlets that share vertices, as long as the result fits into max_vertices/max_triangles.
+ * This is useful to clean up the meshlets on region boundaries after building meshlets for each region separately; to combine results of multiple meshopt_buildMeshlets calls into one input array, add the base offset of each call's output to vertex_offset/triangle_offset.
+ * Returns the number of output meshlets; meshlets that are not merged are copied as is, and the output uses the same layout as meshopt_buildMeshlets.
+ *
+ * destination must contain enough space for meshlet_count meshlets
+ * destination_vertices must contain enough space for all vertices of input meshlets (sum of vertex_count)
+ * destination_triangles must contain enough space for all triangles of input meshlets (sum of triangle_count * 3 rounded up to a multiple of 4)
+ * destination arrays must not overlap with input arrays
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_mergeMeshlets(struct meshopt_Meshlet* destination, unsigned int* destination_vertices, unsigned char* destination_triangles, const struct meshopt_Meshlet* meshlets, const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, size_t meshlet_count, size_t vertex_count, size_t max_vertices, size_t max_triangles);
+
+/**
+ * Experimental: Meshlet optimizer
+ * Reorders triangles within the meshlet to maximize reuse of recently referenced vertices (modeled as a FIFO of 16 vertices, see meshopt_analyzeMeshletCache), and renumbers meshlet vertices in the order of first use.
+ * The original triangle order is kept when reordering does not reduce the number of cache misses.
+ * This improves locality of primitive processing in mesh shaders and makes the local index data more compressible; meshlet contents are otherwise unchanged.
+ * The function works on one meshlet at a time and does not allocate memory, so it can be called for different meshlets in parallel.
+ *
+ * meshlet_vertices and meshlet_triangles should point to the data of a single meshlet (at meshlet.vertex_offset and meshlet.triangle_offset)
+ * triangle_count and vertex_count should match meshlet.triangle_count and meshlet.vertex_count
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_optimizeMeshlet(unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, size_t triangle_count, size_t vertex_count);
+
+/**
+ * Experimental: Meshlet vertex cache analyzer
+ * Returns cache hit statistics for meshlets using a simplified mesh shader model: each meshlet is processed by one workgroup, and primitives are
+ * assembled in order with a FIFO of cache_size recently referenced local vertices that is reset at the start of each meshlet.
+ * warps_executed is the number of meshlets, atvr is computed relative to the total number of meshlet vertices.
+ * Results may not match actual GPU performance
+ */
+MESHOPTIMIZER_EXPERIMENTAL struct meshopt_VertexCacheStatistics meshopt_analyzeMeshletCache(const struct meshopt_Meshlet* meshlets, size_t meshlet_count, const unsigned char* meshlet_triangles, unsigned int cache_size);
+
+/**
+ * Experimental: Multi-configuration vertex transform cache analyzer
+ * Computes the same statistics as meshopt_analyzeVertexCache for config_count cache configurations in a single pass over the index buffer.
+ * Configuration k uses cache_sizes[k], warp_sizes[k] and primgroup_sizes[k], and its statistics are written to results[k].
+ * This is faster than analyzing each configuration separately, but requires vertex_count * config_count * 4 bytes of temporary memory.
+ *
+ * results must contain enough space for config_count statistics
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_analyzeVertexCacheMulti(struct meshopt_VertexCacheStatistics* results, const unsigned int* indices, size_t index_count, size_t vertex_count, const unsigned int* cache_sizes, const unsigned int* warp_sizes, const unsigned int* primgroup_sizes, size_t config_count);
+
+/**
+ * Experimental: Multi-view overdraw analyzer
+ * Returns overdraw statistics for each of view_count orthographic views using a software rasterizer with a viewport_size x viewport_size viewport
+ * Statistics for view k are written to results[k]; meshopt_analyzeOverdraw is equivalent to summing the statistics for -X, -Y and -Z views at 256x256.
+ * Each call allocates its own temporary memory (unless a context is used), so different views can be analyzed in parallel by calling it once per view.
+ * Results may not match actual GPU performance
+ *
+ * vertex_positions should have float3 position in the first 12 bytes of each vertex
+ * view_directions should contain view_count float3 directions the camera looks along; directions do not need to be normalized
+ * viewport_size must be in [1..16384] range
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_analyzeOverdrawMulti(struct meshopt_OverdrawStatistics* results, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, unsigned int viewport_size);
+
+/**
+ * Experimental: Equivalent to meshopt_analyzeOverdrawMulti, but uses scratch memory from context; see meshopt_Context.
+ * Scratch memory holds two buffers of viewport_size^2 elements, so reusing the context avoids reallocating them when many meshes are analyzed.
+ *
+ * context can be NULL
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_analyzeOverdrawMultiWithContext(struct meshopt_Context* context, struct meshopt_OverdrawStatistics* results, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, unsigned int viewport_size);
+
+/**
+ * Experimental: Multi-stream vertex fetch cache analyzer
+ * Returns cache hit statistics for each of stream_count vertex streams that are stored in separate buffers and share the same cache, using a simplified direct mapped cache model
+ * Statistics for stream k are written to results[k]; with a single stream and 64-byte cache lines, results match meshopt_analyzeVertexFetch.
+ * Results may not match actual GPU performance
+ *
+ * vertex_sizes should contain stream_count vertex sizes in bytes, each in [1..256] range
+ * cache_line_sizes should contain stream_count cache line sizes in bytes, each a power of two in [16..4096] range; it can be NULL, in which case 64-byte lines are used
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_analyzeVertexFetchMulti(struct meshopt_VertexFetchStatistics* results, const unsigned int* indices, size_t index_count, size_t vertex_count, const size_t* vertex_sizes, const size_t* cache_line_sizes, size_t stream_count);
+
 struct meshopt_Bounds
 {
 	/* bounding sphere, useful for frustum and occlusion culling */
@@ -509,6 +950,53 @@ struct meshopt_Bounds
 MESHOPTIMIZER_API struct meshopt_Bounds meshopt_computeClusterBounds(const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride);
 MESHOPTIMIZER_API struct meshopt_Bounds meshopt_computeMeshletBounds(const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, size_t triangle_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride);
 
+/**
+ * Experimental: Batched meshlet bounds generator
+ * Computes bounds for meshlet_count meshlets in one call; the results are equivalent to calling meshopt_computeMeshletBounds for each meshlet, but may differ slightly as
+ * the bounding sphere is computed over unique meshlet vertices instead of triangle corners.
+ * The function does not allocate memory, so disjoint ranges of meshlets can be processed in parallel.
+ *
+ * destination must contain enough space for meshlet_count bounds
+ * vertex_positions should have float3 position in the first 12 bytes of each vertex
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_computeMeshletBoundsBatch(struct meshopt_Bounds* destination, const struct meshopt_Meshlet* meshlets, size_t meshlet_count, const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride);
+
+struct meshopt_MeshletBVHNode
+{
+	/* bounding sphere of all meshlets in the subtree */
+	float center[3];
+	float radius;
+
+	/* normal cone of all meshlets in the subtree, stored in 8-bit SNORM format; see meshopt_Bounds for usage (the cone has no apex, so only the tests that use the axis and the bounding sphere apply) */
+	signed char cone_axis_s8[3];
+	signed char cone_cutoff_s8;
+
+	/* inner nodes: children are stored at nodes[offset..offset+count); leaves: meshlets are stored at meshlet_indices[offset..offset+count) */
+	unsigned int offset;
+	unsigned int count;
+	unsigned int leaf;
+};
+
+enum
+{
+    /* Use surface area heuristic to pick split planes instead of splitting at the spatial median. Produces trees that cull better at the cost of slower construction. */
+    meshopt_MeshletBVHSAH = 1 << 0,
+};
+
+/**
+ * Experimental: Meshlet BVH builder
+ * Builds a bounding volume hierarchy over meshlets for hierarchical frustum, occlusion and backface culling; node 0 is the root.
+ * Each inner node has up to node_width children stored consecutively, and each leaf refers to up to leaf_size meshlets; nodes are 32 bytes so that two nodes fit in a cache line.
+ * Returns the number of nodes written to nodes.
+ *
+ * nodes must contain enough space for the resulting tree; worst case size is max(2 * meshlet_count - 1, 1)
+ * meshlet_indices must contain enough space for meshlet_count elements; it receives the meshlet order referenced by leaves
+ * bounds should contain meshlet bounds computed with meshopt_computeMeshletBounds or meshopt_computeMeshletBoundsBatch
+ * node_width should be between 2 and 8 (4 or 8 is recommended); leaf_size should be at least 1
+ * options must be a bitmask composed of meshopt_MeshletBVHX options; 0 is a safe default
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildMeshletBVH(struct meshopt_MeshletBVHNode* nodes, unsigned int* meshlet_indices, const struct meshopt_Bounds* bounds, size_t meshlet_count, size_t node_width, size_t leaf_size, unsigned int options);
+
 /**
  * Experimental: Spatial sorter
  * Generates a remap table that can be used to reorder points for spatial locality.
@@ -535,6 +1023,16 @@ MESHOPTIMIZER_EXPERIMENTAL void meshopt_spatialSortTriangles(unsigned int* desti
  */
 MESHOPTIMIZER_API void meshopt_setAllocator(void* (MESHOPTIMIZER_ALLOC_CALLCONV *allocate)(size_t), void (MESHOPTIMIZER_ALLOC_CALLCONV *deallocate)(void*));
 
+/**
+ * Experimental: Set tracing callbacks
+ * These callbacks can be used to forward algorithm timing and statistics to a profiler; all callbacks are optional and can be NULL.
+ * begin/end are called on the calling thread around each algorithm and its stages (e.g. meshopt_simplify and its "collapse" stage); zones are
+ * properly nested and end is called with the same name as the matching begin. counter reports a named value (e.g. "simplify.collapses" after each
+ * simplification pass). Names are static strings that can be retained by the profiler.
+ * Tracing can be compiled out by defining MESHOPTIMIZER_NO_TRACING when building the library.
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_setTracer(void (*begin)(void* userdata, const char* name), void (*end)(void* userdata, const char* name), void (*counter)(void* userdata, const char* name, double value), void* userdata);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -583,6 +1081,8 @@ inline float meshopt_quantizeFloat(float v, int N);
 template <typename T>
 inline size_t meshopt_generateVertexRemap(unsigned int* destination, const T* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size);
 template <typename T>
+inline size_t meshopt_generateVertexRemapWithContext(meshopt_Context* context, unsigned int* destination, const T* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size);
+template <typename T>
 inline size_t meshopt_generateVertexRemapMulti(unsigned int* destination, const T* indices, size_t index_count, size_t vertex_count, const meshopt_Stream* streams, size_t stream_count);
 template <typename T>
 inline void meshopt_remapIndexBuffer(T* destination, const T* indices, size_t index_count, const unsigned int* remap);
@@ -597,16 +1097,36 @@ inline void meshopt_generateTessellationIndexBuffer(T* destination, const T* ind
 template <typename T>
 inline void meshopt_optimizeVertexCache(T* destination, const T* indices, size_t index_count, size_t vertex_count);
 template <typename T>
+inline void meshopt_optimizeVertexCacheWithContext(meshopt_Context* context, T* destination, const T* indices, size_t index_count, size_t vertex_count);
+template <typename T>
+inline size_t meshopt_optimizeVertexCacheChunked(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t chunk_triangles);
+template <typename T>
 inline void meshopt_optimizeVertexCacheStrip(T* destination, const T* indices, size_t index_count, size_t vertex_count);
 template <typename T>
+inline void meshopt_optimizeVertexCacheStripWithContext(meshopt_Context* context, T* destination, const T* indices, size_t index_count, size_t vertex_count);
+template <typename T>
 inline void meshopt_optimizeVertexCacheFifo(T* destination, const T* indices, size_t index_count, size_t vertex_count, unsigned int cache_size);
 template <typename T>
+inline void meshopt_optimizeVertexCacheTable(T* destination, const T* indices, size_t index_count, size_t vertex_count, const meshopt_VertexScoreTable* table);
+template <typename T>
 inline void meshopt_optimizeOverdraw(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, float threshold);
 template <typename T>
+inline void meshopt_optimizeOverdrawWithContext(meshopt_Context* context, T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, float threshold);
+template <typename T>
+inline void meshopt_optimizeOverdrawMulti(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, float threshold);
+template <typename T>
 inline size_t meshopt_optimizeVertexFetchRemap(unsigned int* destination, const T* indices, size_t index_count, size_t vertex_count);
 template <typename T>
+inline size_t meshopt_optimizeVertexFetchRemapShadow(unsigned int* destination, const T* indices, const T* shadow_indices, size_t index_count, size_t vertex_count);
+template <typename T>
 inline size_t meshopt_optimizeVertexFetch(void* destination, T* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size);
 template <typename T>
+inline size_t meshopt_optimizeMesh(T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, void* const* streams, const size_t* stream_sizes, size_t stream_count, unsigned int options, float overdraw_threshold);
+template <typename T>
+inline size_t meshopt_optimizeMeshWithContext(meshopt_Context* context, T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, void* const* streams, const size_t* stream_sizes, size_t stream_count, unsigned int options, float overdraw_threshold);
+template <typename T>
+inline size_t meshopt_optimizeVertexFetchWithContext(meshopt_Context* context, void* destination, T* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size);
+template <typename T>
 inline size_t meshopt_encodeIndexBuffer(unsigned char* buffer, size_t buffer_size, const T* indices, size_t index_count);
 template <typename T>
 inline int meshopt_decodeIndexBuffer(T* destination, size_t index_count, const unsigned char* buffer, size_t buffer_size);
@@ -617,22 +1137,48 @@ inline int meshopt_decodeIndexSequence(T* destination, size_t index_count, const
 template <typename T>
 inline size_t meshopt_simplify(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options = 0, float* result_error = 0);
 template <typename T>
+inline size_t meshopt_simplifyWithAttributes(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, size_t target_index_count, float target_error, unsigned int options = 0, float* result_error = 0);
+template <typename T>
+inline size_t meshopt_simplifyWithErrors(T* destination, float* vertex_errors, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options = 0, float* result_error = 0);
+template <typename T>
+inline size_t meshopt_simplifyProgressive(T* destination, unsigned int* vertex_remap, meshopt_VertexSplit* splits, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options = 0);
+template <typename T>
+inline size_t meshopt_refineProgressive(T* destination, const T* indices, const meshopt_VertexSplit* splits, size_t current_vertex_count, size_t vertex_count);
+template <typename T>
+inline size_t meshopt_simplifyWithContext(meshopt_Context* context, T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, size_t target_index_count, float target_error, unsigned int options = 0, float* result_error = 0);
+template <typename T>
 inline size_t meshopt_simplifySloppy(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, float* result_error = 0);
 template <typename T>
+inline size_t meshopt_simplifySloppyWithContext(meshopt_Context* context, T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, float* result_error = 0);
+template <typename T>
 inline size_t meshopt_stripify(T* destination, const T* indices, size_t index_count, size_t vertex_count, T restart_index);
 template <typename T>
 inline size_t meshopt_unstripify(T* destination, const T* indices, size_t index_count, T restart_index);
 template <typename T>
 inline meshopt_VertexCacheStatistics meshopt_analyzeVertexCache(const T* indices, size_t index_count, size_t vertex_count, unsigned int cache_size, unsigned int warp_size, unsigned int buffer_size);
 template <typename T>
+inline void meshopt_analyzeVertexCacheMulti(meshopt_VertexCacheStatistics* results, const T* indices, size_t index_count, size_t vertex_count, const unsigned int* cache_sizes, const unsigned int* warp_sizes, const unsigned int* primgroup_sizes, size_t config_count);
+template <typename T>
 inline meshopt_OverdrawStatistics meshopt_analyzeOverdraw(const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride);
 template <typename T>
+inline void meshopt_analyzeOverdrawMulti(meshopt_OverdrawStatistics* results, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, unsigned int viewport_size);
+template <typename T>
+inline void meshopt_analyzeOverdrawMultiWithContext(meshopt_Context* context, meshopt_OverdrawStatistics* results, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, unsigned int viewport_size);
+template <typename T>
 inline meshopt_VertexFetchStatistics meshopt_analyzeVertexFetch(const T* indices, size_t index_count, size_t vertex_count, size_t vertex_size);
 template <typename T>
+inline void meshopt_analyzeVertexFetchMulti(meshopt_VertexFetchStatistics* results, const T* indices, size_t index_count, size_t vertex_count, const size_t* vertex_sizes, const size_t* cache_line_sizes, size_t stream_count);
+template <typename T>
 inline size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight);
 template <typename T>
+inline size_t meshopt_buildMeshletsWithContext(meshopt_Context* context, meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight);
+template <typename T>
+inline size_t meshopt_buildMeshletsSpatial(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles);
+template <typename T>
 inline size_t meshopt_buildMeshletsScan(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const T* indices, size_t index_count, size_t vertex_count, size_t max_vertices, size_t max_triangles);
 template <typename T>
+inline size_t meshopt_partitionMeshletRegions(T* destination, unsigned int* region_offsets, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t region_triangles);
+template <typename T>
 inline meshopt_Bounds meshopt_computeClusterBounds(const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride);
 template <typename T>
 inline void meshopt_spatialSortTriangles(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride);
@@ -709,6 +1255,82 @@ inline float meshopt_quantizeFloat(float v, int N)
 
 /* Internal implementation helpers */
 #ifdef __cplusplus
+// Scoped tracing zone; all methods compile to nothing when MESHOPTIMIZER_NO_TRACING is defined
+class meshopt_Tracer
+{
+public:
+	template <typename T>
+	struct StorageT
+	{
+		static void (*begin)(void*, const char*);
+		static void (*end)(void*, const char*);
+		static void (*counter)(void*, const char*, double);
+		static void* userdata;
+	};
+
+	typedef StorageT<void> Storage;
+
+	meshopt_Tracer(const char* name_)
+		: name(name_)
+	{
+		begin(name);
+	}
+
+	~meshopt_Tracer()
+	{
+		end(name);
+	}
+
+	// can be used to skip computing expensive counters
+	static bool enabled()
+	{
+#ifndef MESHOPTIMIZER_NO_TRACING
+		return Storage::counter != 0;
+#else
+		return false;
+#endif
+	}
+
+	static void begin(const char* name)
+	{
+#ifndef MESHOPTIMIZER_NO_TRACING
+		if (Storage::begin)
+			Storage::begin(Storage::userdata, name);
+#else
+		(void)name;
+#endif
+	}
+
+	static void end(const char* name)
+	{
+#ifndef MESHOPTIMIZER_NO_TRACING
+		if (Storage::end)
+			Storage::end(Storage::userdata, name);
+#else
+		(void)name;
+#endif
+	}
+
+	static void counter(const char* name, double value)
+	{
+#ifndef MESHOPTIMIZER_NO_TRACING
+		if (Storage::counter)
+			Storage::counter(Storage::userdata, name, value);
+#else
+		(void)name;
+		(void)value;
+#endif
+	}
+
+private:
+	const char* name;
+};
+
+template <typename T> void (*meshopt_Tracer::StorageT<T>::begin)(void*, const char*) = 0;
+template <typename T> void (*meshopt_Tracer::StorageT<T>::end)(void*, const char*) = 0;
+template <typename T> void (*meshopt_Tracer::StorageT<T>::counter)(void*, const char*, double) = 0;
+template <typename T> void* meshopt_Tracer::StorageT<T>::userdata = 0;
+
 class meshopt_Allocator
 {
 public:
@@ -721,29 +1343,187 @@ public:
 
 	typedef StorageT<void> Storage;
 
-	meshopt_Allocator()
-		: blocks()
-		, count(0)
+	static void* allocateRaw(meshopt_Context* context, size_t size)
+	{
+		return context && context->allocate ? context->allocate(context->userdata, size) : Storage::allocate(size);
+	}
+
+	static void deallocateRaw(meshopt_Context* context, void* ptr)
 	{
+		if (context && context->deallocate)
+			context->deallocate(context->userdata, ptr);
+		else
+			Storage::deallocate(ptr);
+	}
+
+	// returns the scratch memory offset after allocating size elements of type T at offset; matches the layout used by allocate
+	template <typename T> static size_t scratchSize(size_t offset, size_t size)
+	{
+		size_t bytes = size > size_t(-1) / sizeof(T) ? size_t(-1) : size * sizeof(T);
+
+		// all blocks are 16-byte aligned in scratch memory, which matches the guarantees of operator new for the types we use
+		return ((offset + 15) & ~size_t(15)) + bytes;
+	}
+
+	// wall time in seconds, used for stage statistics
+	static double timestamp();
+
+	meshopt_Allocator(meshopt_Context* context_ = 0)
+		: last(0)
+		, context(context_)
+		, outermost(!context_ || context_->call_depth == 0)
+		, scratch_base(context_ ? context_->scratch_used : 0)
+		, scratch_offset(scratch_base)
+		, stats(context_ ? context_->stats : 0)
+		, stage_start(0)
+		, stage_name(0)
+		, stage_index(~size_t(0))
+	{
+		if (!context)
+			return;
+
+		context->call_depth++;
+
+		// nested calls add to the statistics of the outermost call
+		if (stats && outermost)
+		{
+			stats->peak_bytes = 0;
+			stats->allocation_count = 0;
+			stats->stage_count = 0;
+		}
+
+		// scratch memory is grown lazily on the next call after a call that did not fit; see destructor
+		if (outermost && !context->scratch && context->scratch_size)
+		{
+			context->scratch = allocateRaw(context, context->scratch_size);
+
+			if (stats)
+				stats->allocation_count++;
+		}
 	}
 
 	~meshopt_Allocator()
 	{
-		for (size_t i = count; i > 0; --i)
-			Storage::deallocate(blocks[i - 1]);
+		if (stage_name)
+			meshopt_Tracer::end(stage_name);
+
+		if (stats && stage_index != ~size_t(0))
+			stats->stage_times[stage_index] = timestamp() - stage_start;
+
+		while (last)
+		{
+			Block* block = last;
+			last = block->prev;
+
+			deallocateRaw(context, block);
+		}
+
+		if (!context)
+			return;
+
+		// memory of this call is dead now, so the next call at this depth can reuse it; the high water mark is kept in scratch_peak
+		context->scratch_used = scratch_base;
+		context->call_depth--;
+
+		// nested calls leave scratch memory to the outermost call, which sees the high water mark of all nested calls in scratch_peak
+		if (outermost)
+		{
+			size_t required = context->scratch_peak > scratch_offset ? context->scratch_peak : scratch_offset;
+
+			context->scratch_peak = 0;
+
+			if (stats)
+				stats->peak_bytes = required;
+
+			// release scratch memory that is too small to fit all allocations made during this call; the next call will allocate a larger block
+			if (required > context->scratch_size)
+			{
+				if (context->scratch)
+					deallocateRaw(context, context->scratch);
+
+				context->scratch = 0;
+				context->scratch_size = required;
+			}
+		}
 	}
 
 	template <typename T> T* allocate(size_t size)
 	{
-		assert(count < sizeof(blocks) / sizeof(blocks[0]));
-		T* result = static_cast<T*>(Storage::allocate(size > size_t(-1) / sizeof(T) ? size_t(-1) : size * sizeof(T)));
-		blocks[count++] = result;
-		return result;
+		size_t bytes = size > size_t(-1) / sizeof(T) ? size_t(-1) : size * sizeof(T);
+
+		if (context)
+		{
+			size_t offset = scratch_offset;
+
+			scratch_offset = scratchSize<T>(offset, size);
+
+			// the innermost call in progress owns the top of scratch memory
+			context->scratch_used = scratch_offset;
+
+			if (context->scratch_peak < scratch_offset)
+				context->scratch_peak = scratch_offset;
+
+			if (context->scratch && scratch_offset <= context->scratch_size && scratch_offset >= offset)
+				return reinterpret_cast<T*>(static_cast<char*>(context->scratch) + (scratch_offset - bytes));
+		}
+
+		if (stats)
+			stats->allocation_count++;
+
+		// heap blocks are linked through a header that precedes the data, so the number of blocks per call is not limited
+		Block* block = static_cast<Block*>(allocateRaw(context, bytes > size_t(-1) - sizeof(Block) ? size_t(-1) : bytes + sizeof(Block)));
+		block->prev = last;
+		last = block;
+
+		return reinterpret_cast<T*>(block + 1);
+	}
+
+	// starts a new algorithm stage for statistics and tracing; the previous stage, if any, ends at this point
+	void stage(const char* name)
+	{
+		if (stage_name)
+			meshopt_Tracer::end(stage_name);
+
+		meshopt_Tracer::begin(name);
+		stage_name = name;
+
+		// when all stage slots are used, the remaining stages of this call are accounted to its current stage
+		if (!stats || stats->stage_count == sizeof(stats->stage_names) / sizeof(stats->stage_names[0]))
+			return;
+
+		double time = timestamp();
+
+		// each call only closes its own stages, since nested calls append their stages after the current stage of the outer call
+		if (stage_index != ~size_t(0))
+			stats->stage_times[stage_index] = time - stage_start;
+
+		stage_index = stats->stage_count++;
+
+		stats->stage_names[stage_index] = name;
+		stats->stage_times[stage_index] = 0;
+
+		stage_start = time;
 	}
 
 private:
-	void* blocks[24];
-	size_t count;
+	// header size is padded to 16 bytes to preserve alignment of the data that follows
+	union Block
+	{
+		Block* prev;
+		char padding[16];
+	};
+
+	Block* last;
+
+	meshopt_Context* context;
+	bool outermost;
+	size_t scratch_base;
+	size_t scratch_offset;
+
+	meshopt_Stats* stats;
+	double stage_start;
+	const char* stage_name;
+	size_t stage_index;
 };
 
 // This makes sure that allocate/deallocate are lazily generated in translation units that need them and are deduplicated by the linker
@@ -763,14 +1543,17 @@ struct meshopt_IndexAdapter<T, false>
 	unsigned int* data;
 	size_t count;
 
-	meshopt_IndexAdapter(T* result_, const T* input, size_t count_)
+	meshopt_Context* context;
+
+	meshopt_IndexAdapter(T* result_, const T* input, size_t count_, meshopt_Context* context_ = 0)
 	    : result(result_)
 	    , data(0)
 	    , count(count_)
+	    , context(context_)
 	{
 		size_t size = count > size_t(-1) / sizeof(unsigned int) ? size_t(-1) : count * sizeof(unsigned int);
 
-		data = static_cast<unsigned int*>(meshopt_Allocator::Storage::allocate(size));
+		data = static_cast<unsigned int*>(meshopt_Allocator::allocateRaw(context, size));
 
 		if (input)
 		{
@@ -787,7 +1570,7 @@ struct meshopt_IndexAdapter<T, false>
 				result[i] = T(data[i]);
 		}
 
-		meshopt_Allocator::Storage::deallocate(data);
+		meshopt_Allocator::deallocateRaw(context, data);
 	}
 };
 
@@ -796,7 +1579,7 @@ struct meshopt_IndexAdapter<T, true>
 {
 	unsigned int* data;
 
-	meshopt_IndexAdapter(T* result, const T* input, size_t)
+	meshopt_IndexAdapter(T* result, const T* input, size_t, meshopt_Context* = 0)
 	    : data(reinterpret_cast<unsigned int*>(result ? result : const_cast<T*>(input)))
 	{
 	}
@@ -810,6 +1593,14 @@ inline size_t meshopt_generateVertexRemap(unsigned int* destination, const T* in
 	return meshopt_generateVertexRemap(destination, indices ? in.data : 0, index_count, vertices, vertex_count, vertex_size);
 }
 
+template <typename T>
+inline size_t meshopt_generateVertexRemapWithContext(meshopt_Context* context, unsigned int* destination, const T* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size)
+{
+	meshopt_IndexAdapter<T> in(0, indices, indices ? index_count : 0, context);
+
+	return meshopt_generateVertexRemapWithContext(context, destination, indices ? in.data : 0, index_count, vertices, vertex_count, vertex_size);
+}
+
 template <typename T>
 inline size_t meshopt_generateVertexRemapMulti(unsigned int* destination, const T* indices, size_t index_count, size_t vertex_count, const meshopt_Stream* streams, size_t stream_count)
 {
@@ -872,6 +1663,24 @@ inline void meshopt_optimizeVertexCache(T* destination, const T* indices, size_t
 	meshopt_optimizeVertexCache(out.data, in.data, index_count, vertex_count);
 }
 
+template <typename T>
+inline void meshopt_optimizeVertexCacheWithContext(meshopt_Context* context, T* destination, const T* indices, size_t index_count, size_t vertex_count)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count, context);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count, context);
+
+	meshopt_optimizeVertexCacheWithContext(context, out.data, in.data, index_count, vertex_count);
+}
+
+template <typename T>
+inline size_t meshopt_optimizeVertexCacheChunked(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t chunk_triangles)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count);
+
+	return meshopt_optimizeVertexCacheChunked(out.data, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, chunk_triangles);
+}
+
 template <typename T>
 inline void meshopt_optimizeVertexCacheStrip(T* destination, const T* indices, size_t index_count, size_t vertex_count)
 {
@@ -881,6 +1690,15 @@ inline void meshopt_optimizeVertexCacheStrip(T* destination, const T* indices, s
 	meshopt_optimizeVertexCacheStrip(out.data, in.data, index_count, vertex_count);
 }
 
+template <typename T>
+inline void meshopt_optimizeVertexCacheStripWithContext(meshopt_Context* context, T* destination, const T* indices, size_t index_count, size_t vertex_count)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count, context);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count, context);
+
+	meshopt_optimizeVertexCacheStripWithContext(context, out.data, in.data, index_count, vertex_count);
+}
+
 template <typename T>
 inline void meshopt_optimizeVertexCacheFifo(T* destination, const T* indices, size_t index_count, size_t vertex_count, unsigned int cache_size)
 {
@@ -890,6 +1708,15 @@ inline void meshopt_optimizeVertexCacheFifo(T* destination, const T* indices, si
 	meshopt_optimizeVertexCacheFifo(out.data, in.data, index_count, vertex_count, cache_size);
 }
 
+template <typename T>
+inline void meshopt_optimizeVertexCacheTable(T* destination, const T* indices, size_t index_count, size_t vertex_count, const meshopt_VertexScoreTable* table)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count);
+
+	meshopt_optimizeVertexCacheTable(out.data, in.data, index_count, vertex_count, table);
+}
+
 template <typename T>
 inline void meshopt_optimizeOverdraw(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, float threshold)
 {
@@ -899,6 +1726,24 @@ inline void meshopt_optimizeOverdraw(T* destination, const T* indices, size_t in
 	meshopt_optimizeOverdraw(out.data, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, threshold);
 }
 
+template <typename T>
+inline void meshopt_optimizeOverdrawWithContext(meshopt_Context* context, T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, float threshold)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count, context);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count, context);
+
+	meshopt_optimizeOverdrawWithContext(context, out.data, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, threshold);
+}
+
+template <typename T>
+inline void meshopt_optimizeOverdrawMulti(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, float threshold)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count * view_count);
+
+	meshopt_optimizeOverdrawMulti(out.data, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, view_directions, view_count, threshold);
+}
+
 template <typename T>
 inline size_t meshopt_optimizeVertexFetchRemap(unsigned int* destination, const T* indices, size_t index_count, size_t vertex_count)
 {
@@ -907,6 +1752,15 @@ inline size_t meshopt_optimizeVertexFetchRemap(unsigned int* destination, const
 	return meshopt_optimizeVertexFetchRemap(destination, in.data, index_count, vertex_count);
 }
 
+template <typename T>
+inline size_t meshopt_optimizeVertexFetchRemapShadow(unsigned int* destination, const T* indices, const T* shadow_indices, size_t index_count, size_t vertex_count)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+	meshopt_IndexAdapter<T> shadow(0, shadow_indices, index_count);
+
+	return meshopt_optimizeVertexFetchRemapShadow(destination, in.data, shadow.data, index_count, vertex_count);
+}
+
 template <typename T>
 inline size_t meshopt_optimizeVertexFetch(void* destination, T* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size)
 {
@@ -915,6 +1769,30 @@ inline size_t meshopt_optimizeVertexFetch(void* destination, T* indices, size_t
 	return meshopt_optimizeVertexFetch(destination, inout.data, index_count, vertices, vertex_count, vertex_size);
 }
 
+template <typename T>
+inline size_t meshopt_optimizeMesh(T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, void* const* streams, const size_t* stream_sizes, size_t stream_count, unsigned int options, float overdraw_threshold)
+{
+	meshopt_IndexAdapter<T> inout(indices, indices, index_count);
+
+	return meshopt_optimizeMesh(inout.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, streams, stream_sizes, stream_count, options, overdraw_threshold);
+}
+
+template <typename T>
+inline size_t meshopt_optimizeMeshWithContext(meshopt_Context* context, T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, void* const* streams, const size_t* stream_sizes, size_t stream_count, unsigned int options, float overdraw_threshold)
+{
+	meshopt_IndexAdapter<T> inout(indices, indices, index_count, context);
+
+	return meshopt_optimizeMeshWithContext(context, inout.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, streams, stream_sizes, stream_count, options, overdraw_threshold);
+}
+
+template <typename T>
+inline size_t meshopt_optimizeVertexFetchWithContext(meshopt_Context* context, void* destination, T* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size)
+{
+	meshopt_IndexAdapter<T> inout(indices, indices, index_count, context);
+
+	return meshopt_optimizeVertexFetchWithContext(context, destination, inout.data, index_count, vertices, vertex_count, vertex_size);
+}
+
 template <typename T>
 inline size_t meshopt_encodeIndexBuffer(unsigned char* buffer, size_t buffer_size, const T* indices, size_t index_count)
 {
@@ -958,6 +1836,62 @@ inline size_t meshopt_simplify(T* destination, const T* indices, size_t index_co
 	return meshopt_simplify(out.data, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, target_index_count, target_error, options, result_error);
 }
 
+template <typename T>
+inline size_t meshopt_simplifyWithAttributes(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, size_t target_index_count, float target_error, unsigned int options, float* result_error)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count);
+
+	return meshopt_simplifyWithAttributes(out.data, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, vertex_attributes, vertex_attributes_stride, attribute_weights, attribute_count, target_index_count, target_error, options, result_error);
+}
+
+template <typename T>
+inline size_t meshopt_simplifyWithErrors(T* destination, float* vertex_errors, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options, float* result_error)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count);
+
+	return meshopt_simplifyWithErrors(out.data, vertex_errors, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, target_index_count, target_error, options, result_error);
+}
+
+template <typename T>
+inline size_t meshopt_simplifyProgressive(T* destination, unsigned int* vertex_remap, meshopt_VertexSplit* splits, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count);
+
+	return meshopt_simplifyProgressive(out.data, vertex_remap, splits, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, target_index_count, target_error, options);
+}
+
+template <typename T>
+inline size_t meshopt_refineProgressive(T* destination, const T* indices, const meshopt_VertexSplit* splits, size_t current_vertex_count, size_t vertex_count)
+{
+	size_t current_index_count = current_vertex_count ? splits[current_vertex_count - 1].triangle_count * 3 : 0;
+	size_t index_count = vertex_count ? splits[vertex_count - 1].triangle_count * 3 : 0;
+
+	// source indices are only read when refining, and only up to the resulting index count
+	meshopt_IndexAdapter<T> in(0, indices, vertex_count > current_vertex_count ? index_count : 0);
+
+	// destination only needs to hold the result; when coarsening, refinement reads just the prefix that it writes
+	meshopt_IndexAdapter<T> out(destination, 0, index_count);
+
+	size_t prefix_count = current_index_count < index_count ? current_index_count : index_count;
+
+	for (size_t i = 0; i < prefix_count; ++i)
+		out.data[i] = unsigned(destination[i]);
+
+	return meshopt_refineProgressive(out.data, in.data, splits, current_vertex_count, vertex_count);
+}
+
+template <typename T>
+inline size_t meshopt_simplifyWithContext(meshopt_Context* context, T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, size_t target_index_count, float target_error, unsigned int options, float* result_error)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count, context);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count, context);
+
+	return meshopt_simplifyWithContext(context, out.data, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, vertex_attributes, vertex_attributes_stride, attribute_weights, attribute_count, target_index_count, target_error, options, result_error);
+}
+
 template <typename T>
 inline size_t meshopt_simplifySloppy(T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, float* result_error)
 {
@@ -967,6 +1901,15 @@ inline size_t meshopt_simplifySloppy(T* destination, const T* indices, size_t in
 	return meshopt_simplifySloppy(out.data, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, target_index_count, target_error, result_error);
 }
 
+template <typename T>
+inline size_t meshopt_simplifySloppyWithContext(meshopt_Context* context, T* destination, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, float* result_error)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count, context);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count, context);
+
+	return meshopt_simplifySloppyWithContext(context, out.data, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, target_index_count, target_error, result_error);
+}
+
 template <typename T>
 inline size_t meshopt_stripify(T* destination, const T* indices, size_t index_count, size_t vertex_count, T restart_index)
 {
@@ -993,6 +1936,14 @@ inline meshopt_VertexCacheStatistics meshopt_analyzeVertexCache(const T* indices
 	return meshopt_analyzeVertexCache(in.data, index_count, vertex_count, cache_size, warp_size, buffer_size);
 }
 
+template <typename T>
+inline void meshopt_analyzeVertexCacheMulti(meshopt_VertexCacheStatistics* results, const T* indices, size_t index_count, size_t vertex_count, const unsigned int* cache_sizes, const unsigned int* warp_sizes, const unsigned int* primgroup_sizes, size_t config_count)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+
+	meshopt_analyzeVertexCacheMulti(results, in.data, index_count, vertex_count, cache_sizes, warp_sizes, primgroup_sizes, config_count);
+}
+
 template <typename T>
 inline meshopt_OverdrawStatistics meshopt_analyzeOverdraw(const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
 {
@@ -1001,6 +1952,22 @@ inline meshopt_OverdrawStatistics meshopt_analyzeOverdraw(const T* indices, size
 	return meshopt_analyzeOverdraw(in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride);
 }
 
+template <typename T>
+inline void meshopt_analyzeOverdrawMulti(meshopt_OverdrawStatistics* results, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, unsigned int viewport_size)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+
+	meshopt_analyzeOverdrawMulti(results, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, view_directions, view_count, viewport_size);
+}
+
+template <typename T>
+inline void meshopt_analyzeOverdrawMultiWithContext(meshopt_Context* context, meshopt_OverdrawStatistics* results, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, unsigned int viewport_size)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count, context);
+
+	meshopt_analyzeOverdrawMultiWithContext(context, results, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, view_directions, view_count, viewport_size);
+}
+
 template <typename T>
 inline meshopt_VertexFetchStatistics meshopt_analyzeVertexFetch(const T* indices, size_t index_count, size_t vertex_count, size_t vertex_size)
 {
@@ -1009,6 +1976,14 @@ inline meshopt_VertexFetchStatistics meshopt_analyzeVertexFetch(const T* indices
 	return meshopt_analyzeVertexFetch(in.data, index_count, vertex_count, vertex_size);
 }
 
+template <typename T>
+inline void meshopt_analyzeVertexFetchMulti(meshopt_VertexFetchStatistics* results, const T* indices, size_t index_count, size_t vertex_count, const size_t* vertex_sizes, const size_t* cache_line_sizes, size_t stream_count)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+
+	meshopt_analyzeVertexFetchMulti(results, in.data, index_count, vertex_count, vertex_sizes, cache_line_sizes, stream_count);
+}
+
 template <typename T>
 inline size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight)
 {
@@ -1017,6 +1992,22 @@ inline size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* mes
 	return meshopt_buildMeshlets(meshlets, meshlet_vertices, meshlet_triangles, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, max_vertices, max_triangles, cone_weight);
 }
 
+template <typename T>
+inline size_t meshopt_buildMeshletsWithContext(meshopt_Context* context, meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count, context);
+
+	return meshopt_buildMeshletsWithContext(context, meshlets, meshlet_vertices, meshlet_triangles, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, max_vertices, max_triangles, cone_weight);
+}
+
+template <typename T>
+inline size_t meshopt_buildMeshletsSpatial(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+
+	return meshopt_buildMeshletsSpatial(meshlets, meshlet_vertices, meshlet_triangles, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, max_vertices, max_triangles);
+}
+
 template <typename T>
 inline size_t meshopt_buildMeshletsScan(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const T* indices, size_t index_count, size_t vertex_count, size_t max_vertices, size_t max_triangles)
 {
@@ -1025,6 +2016,15 @@ inline size_t meshopt_buildMeshletsScan(meshopt_Meshlet* meshlets, unsigned int*
 	return meshopt_buildMeshletsScan(meshlets, meshlet_vertices, meshlet_triangles, in.data, index_count, vertex_count, max_vertices, max_triangles);
 }
 
+template <typename T>
+inline size_t meshopt_partitionMeshletRegions(T* destination, unsigned int* region_offsets, const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t region_triangles)
+{
+	meshopt_IndexAdapter<T> in(0, indices, index_count);
+	meshopt_IndexAdapter<T> out(destination, 0, index_count);
+
+	return meshopt_partitionMeshletRegions(out.data, region_offsets, in.data, index_count, vertex_positions, vertex_count, vertex_positions_stride, region_triangles);
+}
+
 template <typename T>
 inline meshopt_Bounds meshopt_computeClusterBounds(const T* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
 {
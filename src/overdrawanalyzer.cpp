@@ -3,6 +3,7 @@
 
 #include <assert.h>
 #include <float.h>
+#include <math.h>
 #include <string.h>
 
 // This work is based on:
@@ -14,8 +15,11 @@ const int kViewport = 256;
 
 struct OverdrawBuffer
 {
-	float z[kViewport][kViewport][2];
-	unsigned int overdraw[kViewport][kViewport][2];
+	int viewport;
+
+	// viewport * viewport pixels, each with separate values for front and back faces
+	float* z;
+	unsigned int* overdraw;
 };
 
 #ifndef min
@@ -45,25 +49,7 @@ static float computeDepthGradients(float& dzdx, float& dzdy, float x1, float y1,
 // half-space fixed point triangle rasterizer
 static void rasterize(OverdrawBuffer* buffer, float v1x, float v1y, float v1z, float v2x, float v2y, float v2z, float v3x, float v3y, float v3z)
 {
-	// compute depth gradients
-	float DZx, DZy;
-	float det = computeDepthGradients(DZx, DZy, v1x, v1y, v1z, v2x, v2y, v2z, v3x, v3y, v3z);
-	int sign = det > 0;
-
-	// flip backfacing triangles to simplify rasterization logic
-	if (sign)
-	{
-		// flipping v2 & v3 preserves depth gradients since they're based on v1
-		float t;
-		t = v2x, v2x = v3x, v3x = t;
-		t = v2y, v2y = v3y, v3y = t;
-		t = v2z, v2z = v3z, v3z = t;
-
-		// flip depth since we rasterize backfacing triangles to second buffer with reverse Z; only v1z is used below
-		v1z = kViewport - v1z;
-		DZx = -DZx;
-		DZy = -DZy;
-	}
+	int viewport = buffer->viewport;
 
 	// coordinates, 28.4 fixed point
 	int X1 = int(16.0f * v1x + 0.5f);
@@ -79,9 +65,32 @@ static void rasterize(OverdrawBuffer* buffer, float v1x, float v1y, float v1z, f
 	// as for max, due to top-left filling convention we will never rasterize right/bottom edges
 	// so max >= 0.5 should round down
 	int minx = max((min(X1, min(X2, X3)) + 7) >> 4, 0);
-	int maxx = min((max(X1, max(X2, X3)) + 7) >> 4, kViewport);
+	int maxx = min((max(X1, max(X2, X3)) + 7) >> 4, viewport);
 	int miny = max((min(Y1, min(Y2, Y3)) + 7) >> 4, 0);
-	int maxy = min((max(Y1, max(Y2, Y3)) + 7) >> 4, kViewport);
+	int maxy = min((max(Y1, max(Y2, Y3)) + 7) >> 4, viewport);
+
+	// dense meshes have many triangles that don't cover any pixel centers; reject them before the setup below
+	if (minx >= maxx || miny >= maxy)
+		return;
+
+	// compute depth gradients
+	float DZx, DZy;
+	float det = computeDepthGradients(DZx, DZy, v1x, v1y, v1z, v2x, v2y, v2z, v3x, v3y, v3z);
+	int sign = det > 0;
+
+	// flip backfacing triangles to simplify rasterization logic
+	if (sign)
+	{
+		// flipping v2 & v3 preserves depth gradients since they're based on v1, and doesn't change the bounding rectangle
+		int t;
+		t = X2, X2 = X3, X3 = t;
+		t = Y2, Y2 = Y3, Y3 = t;
+
+		// flip depth since we rasterize backfacing triangles to second buffer with reverse Z; only v1z is used below
+		v1z = float(viewport) - v1z;
+		DZx = -DZx;
+		DZy = -DZy;
+	}
 
 	// deltas, 28.4 fixed point
 	int DX12 = X1 - X2;
@@ -99,62 +108,89 @@ static void rasterize(OverdrawBuffer* buffer, float v1x, float v1y, float v1z, f
 
 	// half edge equations, 24.8 fixed point
 	// note that we offset minx/miny by half pixel since we want to rasterize pixels with covered centers
+	// edge values need 64-bit precision since products of 28.4 coordinates overflow 32 bits for viewports larger than ~2048 pixels
 	int FX = (minx << 4) + 8;
 	int FY = (miny << 4) + 8;
-	int CY1 = DX12 * (FY - Y1) - DY12 * (FX - X1) + TL1 - 1;
-	int CY2 = DX23 * (FY - Y2) - DY23 * (FX - X2) + TL2 - 1;
-	int CY3 = DX31 * (FY - Y3) - DY31 * (FX - X3) + TL3 - 1;
+	long long CY1 = (long long)DX12 * (FY - Y1) - (long long)DY12 * (FX - X1) + TL1 - 1;
+	long long CY2 = (long long)DX23 * (FY - Y2) - (long long)DY23 * (FX - X2) + TL2 - 1;
+	long long CY3 = (long long)DX31 * (FY - Y3) - (long long)DY31 * (FX - X3) + TL3 - 1;
 	float ZY = v1z + (DZx * float(FX - X1) + DZy * float(FY - Y1)) * (1 / 16.f);
 
 	for (int y = miny; y < maxy; y++)
 	{
-		int CX1 = CY1;
-		int CX2 = CY2;
-		int CX3 = CY3;
+		long long CX1 = CY1;
+		long long CX2 = CY2;
+		long long CX3 = CY3;
 		float ZX = ZY;
 
+		float* zrow = buffer->z + y * viewport * 2 + sign;
+		unsigned int* overdrawrow = buffer->overdraw + y * viewport * 2 + sign;
+
 		for (int x = minx; x < maxx; x++)
 		{
 			// check if all CXn are non-negative
 			if ((CX1 | CX2 | CX3) >= 0)
 			{
-				if (ZX >= buffer->z[y][x][sign])
+				if (ZX >= zrow[x * 2])
 				{
-					buffer->z[y][x][sign] = ZX;
-					buffer->overdraw[y][x][sign]++;
+					zrow[x * 2] = ZX;
+					overdrawrow[x * 2]++;
 				}
 			}
 
-			// signed left shift is UB for negative numbers so use unsigned-signed casts
-			CX1 -= int(unsigned(DY12) << 4);
-			CX2 -= int(unsigned(DY23) << 4);
-			CX3 -= int(unsigned(DY31) << 4);
+			CX1 -= (long long)DY12 * 16;
+			CX2 -= (long long)DY23 * 16;
+			CX3 -= (long long)DY31 * 16;
 			ZX += DZx;
 		}
 
-		// signed left shift is UB for negative numbers so use unsigned-signed casts
-		CY1 += int(unsigned(DX12) << 4);
-		CY2 += int(unsigned(DX23) << 4);
-		CY3 += int(unsigned(DX31) << 4);
+		CY1 += (long long)DX12 * 16;
+		CY2 += (long long)DX23 * 16;
+		CY3 += (long long)DX31 * 16;
 		ZY += DZy;
 	}
 }
 
-} // namespace meshopt
-
-meshopt_OverdrawStatistics meshopt_analyzeOverdraw(const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
+static void buildViewBasis(float basis[3][3], const float* direction)
 {
-	using namespace meshopt;
+	float length = sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+	float rlength = length == 0.f ? 0.f : 1.f / length;
 
-	assert(index_count % 3 == 0);
-	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
-	assert(vertex_positions_stride % sizeof(float) == 0);
+	float d[3] = {direction[0] * rlength, direction[1] * rlength, direction[2] * rlength};
 
-	meshopt_Allocator allocator;
+	// pick a helper axis by rotating direction components; for coordinate axes this results in the same projections meshopt_analyzeOverdraw uses
+	float h[3] = {d[2], d[0], d[1]};
 
-	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+	// the rotated direction is parallel to the original one for diagonal directions, so a fixed axis is used instead
+	if (fabsf(d[0] - d[1]) < 1e-3f && fabsf(d[1] - d[2]) < 1e-3f)
+		h[0] = 1.f, h[1] = 0.f, h[2] = 0.f;
 
-	meshopt_OverdrawStatistics result = {};
+	float u[3] = {d[1] * h[2] - d[2] * h[1], d[2] * h[0] - d[0] * h[2], d[0] * h[1] - d[1] * h[0]};
+
+	float ulength = sqrtf(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+	float rulength = ulength == 0.f ? 0.f : 1.f / ulength;
+
+	u[0] *= rulength;
+	u[1] *= rulength;
+	u[2] *= rulength;
+
+	// u, v and direction form an orthonormal basis; x and y are rasterized along u and v, and depth is computed along direction
+	basis[0][0] = u[0];
+	basis[0][1] = u[1];
+	basis[0][2] = u[2];
+
+	basis[1][0] = u[1] * d[2] - u[2] * d[1];
+	basis[1][1] = u[2] * d[0] - u[0] * d[2];
+	basis[1][2] = u[0] * d[1] - u[1] * d[0];
+
+	basis[2][0] = d[0];
+	basis[2][1] = d[1];
+	basis[2][2] = d[2];
+}
+
+static void analyzeView(meshopt_OverdrawStatistics& result, OverdrawBuffer* buffer, float* projected, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_stride_float, const float basis[3][3])
+{
+	int viewport = buffer->viewport;
 
 	float minv[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
 	float maxv[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
@@ -165,66 +201,110 @@ meshopt_OverdrawStatistics meshopt_analyzeOverdraw(const unsigned int* indices,
 
 		for (int j = 0; j < 3; ++j)
 		{
-			minv[j] = min(minv[j], v[j]);
-			maxv[j] = max(maxv[j], v[j]);
+			float p = v[0] * basis[j][0] + v[1] * basis[j][1] + v[2] * basis[j][2];
+
+			projected[i * 3 + j] = p;
+			minv[j] = min(minv[j], p);
+			maxv[j] = max(maxv[j], p);
 		}
 	}
 
 	float extent = max(maxv[0] - minv[0], max(maxv[1] - minv[1], maxv[2] - minv[2]));
-	float scale = kViewport / extent;
+	float scale = float(viewport) / extent;
+
+	// project each vertex once instead of once per triangle corner
+	for (size_t i = 0; i < vertex_count; ++i)
+		for (int j = 0; j < 3; ++j)
+			projected[i * 3 + j] = (projected[i * 3 + j] - minv[j]) * scale;
 
-	float* triangles = allocator.allocate<float>(index_count * 3);
+	memset(buffer->z, 0, viewport * viewport * 2 * sizeof(float));
+	memset(buffer->overdraw, 0, viewport * viewport * 2 * sizeof(unsigned int));
 
-	for (size_t i = 0; i < index_count; ++i)
+	for (size_t i = 0; i < index_count; i += 3)
 	{
-		unsigned int index = indices[i];
-		assert(index < vertex_count);
+		unsigned int a = indices[i + 0], b = indices[i + 1], c = indices[i + 2];
+		assert(a < vertex_count && b < vertex_count && c < vertex_count);
 
-		const float* v = vertex_positions + index * vertex_stride_float;
+		const float* vn0 = &projected[a * 3];
+		const float* vn1 = &projected[b * 3];
+		const float* vn2 = &projected[c * 3];
 
-		triangles[i * 3 + 0] = (v[0] - minv[0]) * scale;
-		triangles[i * 3 + 1] = (v[1] - minv[1]) * scale;
-		triangles[i * 3 + 2] = (v[2] - minv[2]) * scale;
+		rasterize(buffer, vn0[0], vn0[1], vn0[2], vn1[0], vn1[1], vn1[2], vn2[0], vn2[1], vn2[2]);
 	}
 
-	OverdrawBuffer* buffer = allocator.allocate<OverdrawBuffer>(1);
-
-	for (int axis = 0; axis < 3; ++axis)
+	for (int i = 0; i < viewport * viewport * 2; ++i)
 	{
-		memset(buffer, 0, sizeof(OverdrawBuffer));
+		unsigned int overdraw = buffer->overdraw[i];
 
-		for (size_t i = 0; i < index_count; i += 3)
-		{
-			const float* vn0 = &triangles[3 * (i + 0)];
-			const float* vn1 = &triangles[3 * (i + 1)];
-			const float* vn2 = &triangles[3 * (i + 2)];
+		result.pixels_covered += overdraw > 0;
+		result.pixels_shaded += overdraw;
+	}
+}
 
-			switch (axis)
-			{
-			case 0:
-				rasterize(buffer, vn0[2], vn0[1], vn0[0], vn1[2], vn1[1], vn1[0], vn2[2], vn2[1], vn2[0]);
-				break;
-			case 1:
-				rasterize(buffer, vn0[0], vn0[2], vn0[1], vn1[0], vn1[2], vn1[1], vn2[0], vn2[2], vn2[1]);
-				break;
-			case 2:
-				rasterize(buffer, vn0[1], vn0[0], vn0[2], vn1[1], vn1[0], vn1[2], vn2[1], vn2[0], vn2[2]);
-				break;
-			}
-		}
+} // namespace meshopt
 
-		for (int y = 0; y < kViewport; ++y)
-			for (int x = 0; x < kViewport; ++x)
-				for (int s = 0; s < 2; ++s)
-				{
-					unsigned int overdraw = buffer->overdraw[y][x][s];
+meshopt_OverdrawStatistics meshopt_analyzeOverdraw(const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
+{
+	using namespace meshopt;
 
-					result.pixels_covered += overdraw > 0;
-					result.pixels_shaded += overdraw;
-				}
+	const float kAxes[3][3] = {{-1, 0, 0}, {0, -1, 0}, {0, 0, -1}};
+
+	meshopt_OverdrawStatistics views[3];
+	meshopt_analyzeOverdrawMulti(views, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, kAxes[0], 3, kViewport);
+
+	meshopt_OverdrawStatistics result = {};
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		result.pixels_covered += views[axis].pixels_covered;
+		result.pixels_shaded += views[axis].pixels_shaded;
 	}
 
 	result.overdraw = result.pixels_covered ? float(result.pixels_shaded) / float(result.pixels_covered) : 0.f;
 
 	return result;
 }
+
+void meshopt_analyzeOverdrawMulti(meshopt_OverdrawStatistics* results, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, unsigned int viewport_size)
+{
+	meshopt_analyzeOverdrawMultiWithContext(NULL, results, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, view_directions, view_count, viewport_size);
+}
+
+void meshopt_analyzeOverdrawMultiWithContext(meshopt_Context* context, meshopt_OverdrawStatistics* results, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, unsigned int viewport_size)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+	assert(viewport_size > 0 && viewport_size <= 16384);
+
+	meshopt_Allocator allocator(context);
+
+	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+
+	float* projected = allocator.allocate<float>(vertex_count * 3);
+
+	OverdrawBuffer buffer;
+	buffer.viewport = int(viewport_size);
+	buffer.z = allocator.allocate<float>(size_t(viewport_size) * viewport_size * 2);
+	buffer.overdraw = allocator.allocate<unsigned int>(size_t(viewport_size) * viewport_size * 2);
+
+	for (size_t view = 0; view < view_count; ++view)
+	{
+		// the rasterizer keeps fragments with larger depth, so depth increases towards the camera
+		const float* view_direction = &view_directions[view * 3];
+		float direction[3] = {-view_direction[0], -view_direction[1], -view_direction[2]};
+
+		float basis[3][3];
+		buildViewBasis(basis, direction);
+
+		meshopt_OverdrawStatistics& result = results[view];
+		meshopt_OverdrawStatistics zero = {};
+		result = zero;
+
+		analyzeView(result, &buffer, projected, indices, index_count, vertex_positions, vertex_count, vertex_stride_float, basis);
+
+		result.overdraw = result.pixels_covered ? float(result.pixels_shaded) / float(result.pixels_covered) : 0.f;
+	}
+}
@@ -10,11 +10,11 @@
 namespace meshopt
 {
 
-static void calculateSortData(float* sort_data, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_positions_stride, const unsigned int* clusters, size_t cluster_count)
+static void calculateClusterData(float* cluster_data, float* mesh_centroid, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_positions_stride, const unsigned int* clusters, size_t cluster_count)
 {
 	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
 
-	float mesh_centroid[3] = {};
+	mesh_centroid[0] = mesh_centroid[1] = mesh_centroid[2] = 0;
 
 	for (size_t i = 0; i < index_count; ++i)
 	{
@@ -76,9 +76,57 @@ static void calculateSortData(float* sort_data, const unsigned int* indices, siz
 		cluster_normal[1] *= inv_cluster_normal_length;
 		cluster_normal[2] *= inv_cluster_normal_length;
 
-		float centroid_vector[3] = {cluster_centroid[0] - mesh_centroid[0], cluster_centroid[1] - mesh_centroid[1], cluster_centroid[2] - mesh_centroid[2]};
+		float* data = cluster_data + cluster * 6;
 
-		sort_data[cluster] = centroid_vector[0] * cluster_normal[0] + centroid_vector[1] * cluster_normal[1] + centroid_vector[2] * cluster_normal[2];
+		// store centroid relative to mesh centroid followed by normal
+		data[0] = cluster_centroid[0] - mesh_centroid[0];
+		data[1] = cluster_centroid[1] - mesh_centroid[1];
+		data[2] = cluster_centroid[2] - mesh_centroid[2];
+		data[3] = cluster_normal[0];
+		data[4] = cluster_normal[1];
+		data[5] = cluster_normal[2];
+	}
+}
+
+static void calculateSortData(float* sort_data, const float* cluster_data, size_t cluster_count)
+{
+	// clusters facing away from the mesh centroid are on the outside of the mesh and are likely to occlude other clusters from any direction
+	for (size_t cluster = 0; cluster < cluster_count; ++cluster)
+	{
+		const float* data = cluster_data + cluster * 6;
+
+		sort_data[cluster] = data[0] * data[3] + data[1] * data[4] + data[2] * data[5];
+	}
+}
+
+static void calculateViewSortData(float* sort_data, const float* cluster_data, size_t cluster_count, const float* view_direction)
+{
+	float length = sqrtf(view_direction[0] * view_direction[0] + view_direction[1] * view_direction[1] + view_direction[2] * view_direction[2]);
+	float inv_length = length == 0 ? 0 : 1 / length;
+
+	float direction[3] = {view_direction[0] * inv_length, view_direction[1] * inv_length, view_direction[2] * inv_length};
+
+	float max_depth = 0;
+
+	for (size_t cluster = 0; cluster < cluster_count; ++cluster)
+	{
+		const float* data = cluster_data + cluster * 6;
+
+		float depth = data[0] * direction[0] + data[1] * direction[1] + data[2] * direction[2];
+
+		max_depth = max_depth < fabsf(depth) ? fabsf(depth) : max_depth;
+	}
+
+	for (size_t cluster = 0; cluster < cluster_count; ++cluster)
+	{
+		const float* data = cluster_data + cluster * 6;
+
+		float depth = data[0] * direction[0] + data[1] * direction[1] + data[2] * direction[2];
+		float facing = data[3] * direction[0] + data[4] * direction[1] + data[5] * direction[2];
+
+		// front-facing clusters come first, sorted front to back; back-facing clusters are either culled or occluded by front-facing ones,
+		// so they come last, sorted front to back as seen from the opposite direction
+		sort_data[cluster] = (facing <= 0) ? 2 * max_depth - depth : -2 * max_depth + depth;
 	}
 }
 
@@ -265,17 +313,13 @@ static size_t generateSoftBoundaries(unsigned int* destination, const unsigned i
 	return result;
 }
 
-} // namespace meshopt
-
-void meshopt_optimizeOverdraw(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, float threshold)
+static void optimizeOverdraw(meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, float threshold, const float* view_directions, size_t view_count)
 {
-	using namespace meshopt;
-
 	assert(index_count % 3 == 0);
 	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
 	assert(vertex_positions_stride % sizeof(float) == 0);
 
-	meshopt_Allocator allocator;
+	meshopt_Allocator allocator(context);
 
 	// guard for empty meshes
 	if (index_count == 0 || vertex_count == 0)
@@ -304,30 +348,69 @@ void meshopt_optimizeOverdraw(unsigned int* destination, const unsigned int* ind
 	const unsigned int* clusters = soft_clusters;
 	size_t cluster_count = soft_cluster_count;
 
-	// fill sort data
-	float* sort_data = allocator.allocate<float>(cluster_count);
-	calculateSortData(sort_data, indices, index_count, vertex_positions, vertex_positions_stride, clusters, cluster_count);
+	// compute cluster centroids and normals once; they are shared between all orderings
+	float* cluster_data = allocator.allocate<float>(cluster_count * 6);
+	float mesh_centroid[3];
+	calculateClusterData(cluster_data, mesh_centroid, indices, index_count, vertex_positions, vertex_positions_stride, clusters, cluster_count);
 
-	// sort clusters using sort data
+	float* sort_data = allocator.allocate<float>(cluster_count);
 	unsigned short* sort_keys = allocator.allocate<unsigned short>(cluster_count);
 	unsigned int* sort_order = allocator.allocate<unsigned int>(cluster_count);
-	calculateSortOrderRadix(sort_order, sort_data, sort_keys, cluster_count);
 
-	// fill output buffer
-	size_t offset = 0;
+	// view independent ordering is produced when no view directions are given
+	size_t ordering_count = view_directions ? view_count : 1;
 
-	for (size_t it = 0; it < cluster_count; ++it)
+	for (size_t view = 0; view < ordering_count; ++view)
 	{
-		unsigned int cluster = sort_order[it];
-		assert(cluster < cluster_count);
+		// fill sort data
+		if (view_directions)
+			calculateViewSortData(sort_data, cluster_data, cluster_count, &view_directions[view * 3]);
+		else
+			calculateSortData(sort_data, cluster_data, cluster_count);
 
-		size_t cluster_begin = clusters[cluster] * 3;
-		size_t cluster_end = (cluster + 1 < cluster_count) ? clusters[cluster + 1] * 3 : index_count;
-		assert(cluster_begin < cluster_end);
+		// sort clusters using sort data
+		calculateSortOrderRadix(sort_order, sort_data, sort_keys, cluster_count);
+
+		// fill output buffer
+		unsigned int* result = destination + view * index_count;
+		size_t offset = 0;
 
-		memcpy(destination + offset, indices + cluster_begin, (cluster_end - cluster_begin) * sizeof(unsigned int));
-		offset += cluster_end - cluster_begin;
+		for (size_t it = 0; it < cluster_count; ++it)
+		{
+			unsigned int cluster = sort_order[it];
+			assert(cluster < cluster_count);
+
+			size_t cluster_begin = clusters[cluster] * 3;
+			size_t cluster_end = (cluster + 1 < cluster_count) ? clusters[cluster + 1] * 3 : index_count;
+			assert(cluster_begin < cluster_end);
+
+			memcpy(result + offset, indices + cluster_begin, (cluster_end - cluster_begin) * sizeof(unsigned int));
+			offset += cluster_end - cluster_begin;
+		}
+
+		assert(offset == index_count);
 	}
+}
+
+} // namespace meshopt
+
+void meshopt_optimizeOverdraw(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, float threshold)
+{
+	meshopt_optimizeOverdrawWithContext(NULL, destination, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, threshold);
+}
+
+void meshopt_optimizeOverdrawWithContext(meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, float threshold)
+{
+	using namespace meshopt;
+
+	optimizeOverdraw(context, destination, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, threshold, NULL, 0);
+}
+
+void meshopt_optimizeOverdrawMulti(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, float threshold)
+{
+	using namespace meshopt;
+
+	assert(view_directions && view_count > 0);
 
-	assert(offset == index_count);
+	optimizeOverdraw(NULL, destination, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, threshold, view_directions, view_count);
 }
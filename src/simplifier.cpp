@@ -10,16 +10,11 @@
 #define TRACE 0
 #endif
 
+// TRACE > 1 enables verbose dumps of collapse statistics for development; use meshopt_setTracer for runtime statistics
 #if TRACE
 #include <stdio.h>
 #endif
 
-#if TRACE
-#define TRACESTATS(i) stats[i]++;
-#else
-#define TRACESTATS(i) (void)0
-#endif
-
 // This work is based on:
 // Michael Garland and Paul S. Heckbert. Surface simplification using quadric error metrics. 1997
 // Michael Garland. Quadric-based polygonal surface simplification. 1999
@@ -290,9 +285,7 @@ static void classifyVertices(unsigned char* result, unsigned int* loop, unsigned
 		}
 	}
 
-#if TRACE
 	size_t stats[4] = {};
-#endif
 
 	for (size_t i = 0; i < vertex_count; ++i)
 	{
@@ -317,7 +310,7 @@ static void classifyVertices(unsigned char* result, unsigned int* loop, unsigned
 				else
 				{
 					result[i] = Kind_Locked;
-					TRACESTATS(0);
+					stats[0]++;
 				}
 			}
 			else if (wedge[wedge[i]] == i)
@@ -338,20 +331,20 @@ static void classifyVertices(unsigned char* result, unsigned int* loop, unsigned
 					else
 					{
 						result[i] = Kind_Locked;
-						TRACESTATS(1);
+						stats[1]++;
 					}
 				}
 				else
 				{
 					result[i] = Kind_Locked;
-					TRACESTATS(2);
+					stats[2]++;
 				}
 			}
 			else
 			{
 				// more than one vertex maps to this one; we don't have classification available
 				result[i] = Kind_Locked;
-				TRACESTATS(3);
+				stats[3]++;
 			}
 		}
 		else
@@ -367,10 +360,10 @@ static void classifyVertices(unsigned char* result, unsigned int* loop, unsigned
 			if (result[i] == Kind_Border)
 				result[i] = Kind_Locked;
 
-#if TRACE
-	printf("locked: many open edges %d, disconnected seam %d, many seam edges %d, many wedges %d\n",
-	    int(stats[0]), int(stats[1]), int(stats[2]), int(stats[3]));
-#endif
+	meshopt_Tracer::counter("simplify.locked_open_edges", double(stats[0]));
+	meshopt_Tracer::counter("simplify.locked_disconnected_seam", double(stats[1]));
+	meshopt_Tracer::counter("simplify.locked_seam_edges", double(stats[2]));
+	meshopt_Tracer::counter("simplify.locked_wedges", double(stats[3]));
 }
 
 struct Vector3
@@ -426,6 +419,23 @@ static float rescalePositions(Vector3* result, const float* vertex_positions_dat
 	return extent;
 }
 
+static void rescaleAttributes(float* result, const float* vertex_attributes_data, size_t vertex_count, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count)
+{
+	size_t vertex_attributes_stride_float = vertex_attributes_stride / sizeof(float);
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		for (size_t k = 0; k < attribute_count; ++k)
+		{
+			float a = vertex_attributes_data[i * vertex_attributes_stride_float + k];
+
+			result[i * attribute_count + k] = a * attribute_weights[k];
+		}
+	}
+}
+
+const size_t kMaxAttributes = 16;
+
 struct Quadric
 {
 	float a00, a11, a22;
@@ -434,6 +444,11 @@ struct Quadric
 	float w;
 };
 
+struct QuadricGrad
+{
+	float gx, gy, gz, gw;
+};
+
 struct Collapse
 {
 	unsigned int v0;
@@ -476,6 +491,17 @@ static void quadricAdd(Quadric& Q, const Quadric& R)
 	Q.w += R.w;
 }
 
+static void quadricAdd(QuadricGrad* G, const QuadricGrad* R, size_t attribute_count)
+{
+	for (size_t k = 0; k < attribute_count; ++k)
+	{
+		G[k].gx += R[k].gx;
+		G[k].gy += R[k].gy;
+		G[k].gz += R[k].gz;
+		G[k].gw += R[k].gw;
+	}
+}
+
 static float quadricError(const Quadric& Q, const Vector3& v)
 {
 	float rx = Q.b0;
@@ -504,6 +530,44 @@ static float quadricError(const Quadric& Q, const Vector3& v)
 	return fabsf(r) * s;
 }
 
+static float quadricError(const Quadric& Q, const QuadricGrad* G, size_t attribute_count, const Vector3& v, const float* va)
+{
+	float rx = Q.b0;
+	float ry = Q.b1;
+	float rz = Q.b2;
+
+	rx += Q.a10 * v.y;
+	ry += Q.a21 * v.z;
+	rz += Q.a20 * v.x;
+
+	rx *= 2;
+	ry *= 2;
+	rz *= 2;
+
+	rx += Q.a00 * v.x;
+	ry += Q.a11 * v.y;
+	rz += Q.a22 * v.z;
+
+	float r = Q.c;
+	r += rx * v.x;
+	r += ry * v.y;
+	r += rz * v.z;
+
+	// see quadricFromAttributes for general derivation; here we need to add the parts of (eval(pos) - attr)^2 that depend on attr
+	for (size_t k = 0; k < attribute_count; ++k)
+	{
+		float a = va[k];
+		float g = v.x * G[k].gx + v.y * G[k].gy + v.z * G[k].gz + G[k].gw;
+
+		r += a * a * Q.w;
+		r -= 2 * a * g;
+	}
+
+	float s = Q.w == 0.f ? 0.f : 1.f / Q.w;
+
+	return fabsf(r) * s;
+}
+
 static void quadricFromPlane(Quadric& Q, float a, float b, float c, float d, float w)
 {
 	float aw = a * w;
@@ -527,15 +591,16 @@ static void quadricFromPlane(Quadric& Q, float a, float b, float c, float d, flo
 static void quadricFromPoint(Quadric& Q, float x, float y, float z, float w)
 {
 	// we need to encode (x - X) ^ 2 + (y - Y)^2 + (z - Z)^2 into the quadric
+	// note: quadricError doubles the linear term, so b stores -x (not -2x) to expand to -2xX
 	Q.a00 = w;
 	Q.a11 = w;
 	Q.a22 = w;
 	Q.a10 = 0.f;
 	Q.a20 = 0.f;
 	Q.a21 = 0.f;
-	Q.b0 = -2.f * x * w;
-	Q.b1 = -2.f * y * w;
-	Q.b2 = -2.f * z * w;
+	Q.b0 = -x * w;
+	Q.b1 = -y * w;
+	Q.b2 = -z * w;
 	Q.c = (x * x + y * y + z * z) * w;
 	Q.w = w;
 }
@@ -574,6 +639,82 @@ static void quadricFromTriangleEdge(Quadric& Q, const Vector3& p0, const Vector3
 	quadricFromPlane(Q, normal.x, normal.y, normal.z, -distance, length * weight);
 }
 
+static void quadricFromAttributes(Quadric& Q, QuadricGrad* G, const Vector3& p0, const Vector3& p1, const Vector3& p2, const float* va0, const float* va1, const float* va2, size_t attribute_count)
+{
+	// for each attribute we want to encode the following function into the quadric:
+	// (eval(pos) - attr)^2
+	// where eval(pos) interpolates attribute across the triangle like so:
+	// eval(pos) = pos.x * gx + pos.y * gy + pos.z * gz + gw
+	// where gx/gy/gz/gw are gradients
+	Vector3 p10 = {p1.x - p0.x, p1.y - p0.y, p1.z - p0.z};
+	Vector3 p20 = {p2.x - p0.x, p2.y - p0.y, p2.z - p0.z};
+
+	// weight is scaled the same way as in quadricFromTriangle to keep position and attribute errors balanced
+	Vector3 normal = {p10.y * p20.z - p10.z * p20.y, p10.z * p20.x - p10.x * p20.z, p10.x * p20.y - p10.y * p20.x};
+	float area = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+	float w = sqrtf(area);
+
+	// we compute gradients using barycentric coordinates; barycentric coordinates can be computed as follows:
+	// v = (d11 * d20 - d01 * d21) / denom
+	// w = (d00 * d21 - d01 * d20) / denom
+	// u = 1 - v - w
+	// here v0, v1 are triangle edge vectors, v2 is a vector from point to triangle corner, and dij = dot(vi, vj)
+	const Vector3& v0 = p10;
+	const Vector3& v1 = p20;
+	float d00 = v0.x * v0.x + v0.y * v0.y + v0.z * v0.z;
+	float d01 = v0.x * v1.x + v0.y * v1.y + v0.z * v1.z;
+	float d11 = v1.x * v1.x + v1.y * v1.y + v1.z * v1.z;
+	float denom = d00 * d11 - d01 * d01;
+	float denomr = denom == 0 ? 0.f : 1.f / denom;
+
+	// precompute gradient factors
+	// these are derived by directly computing derivative of eval(pos) = a0 * u + a1 * v + a2 * w and factoring out common factors that are shared between attributes
+	float gx1 = (d11 * v0.x - d01 * v1.x) * denomr;
+	float gx2 = (d00 * v1.x - d01 * v0.x) * denomr;
+	float gy1 = (d11 * v0.y - d01 * v1.y) * denomr;
+	float gy2 = (d00 * v1.y - d01 * v0.y) * denomr;
+	float gz1 = (d11 * v0.z - d01 * v1.z) * denomr;
+	float gz2 = (d00 * v1.z - d01 * v0.z) * denomr;
+
+	memset(&Q, 0, sizeof(Quadric));
+
+	Q.w = w;
+
+	for (size_t k = 0; k < attribute_count; ++k)
+	{
+		float a0 = va0[k], a1 = va1[k], a2 = va2[k];
+
+		// compute gradient of eval(pos) for x/y/z/w
+		// the formulas below are obtained by directly computing derivative of eval(pos) = a0 * u + a1 * v + a2 * w
+		float gx = gx1 * (a1 - a0) + gx2 * (a2 - a0);
+		float gy = gy1 * (a1 - a0) + gy2 * (a2 - a0);
+		float gz = gz1 * (a1 - a0) + gz2 * (a2 - a0);
+		float gw = a0 - p0.x * gx - p0.y * gy - p0.z * gz;
+
+		// quadric encodes (eval(pos)-attr)^2; this means that the resulting expansion needs to compute, for example, pos.x * pos.y * K
+		// since quadrics already encode factors for pos.x * pos.y, we can accumulate almost everything in basic quadric fields
+		Q.a00 += w * (gx * gx);
+		Q.a11 += w * (gy * gy);
+		Q.a22 += w * (gz * gz);
+
+		Q.a10 += w * (gy * gx);
+		Q.a20 += w * (gz * gx);
+		Q.a21 += w * (gz * gy);
+
+		Q.b0 += w * (gx * gw);
+		Q.b1 += w * (gy * gw);
+		Q.b2 += w * (gz * gw);
+
+		Q.c += w * (gw * gw);
+
+		// the only remaining sum components are ones that depend on attr; these will be added during error evaluation, see quadricError
+		G[k].gx = w * gx;
+		G[k].gy = w * gy;
+		G[k].gz = w * gz;
+		G[k].gw = w * gw;
+	}
+}
+
 static void fillFaceQuadrics(Quadric* vertex_quadrics, const unsigned int* indices, size_t index_count, const Vector3* vertex_positions, const unsigned int* remap)
 {
 	for (size_t i = 0; i < index_count; i += 3)
@@ -639,6 +780,29 @@ static void fillEdgeQuadrics(Quadric* vertex_quadrics, const unsigned int* indic
 	}
 }
 
+static void fillAttributeQuadrics(Quadric* attribute_quadrics, QuadricGrad* attribute_gradients, const unsigned int* indices, size_t index_count, const Vector3* vertex_positions, const float* vertex_attributes, size_t attribute_count)
+{
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		unsigned int i0 = indices[i + 0];
+		unsigned int i1 = indices[i + 1];
+		unsigned int i2 = indices[i + 2];
+
+		Quadric QA;
+		QuadricGrad G[kMaxAttributes];
+		quadricFromAttributes(QA, G, vertex_positions[i0], vertex_positions[i1], vertex_positions[i2], &vertex_attributes[i0 * attribute_count], &vertex_attributes[i1 * attribute_count], &vertex_attributes[i2 * attribute_count], attribute_count);
+
+		// note: attribute quadrics are tracked per wedge (not per position) to avoid blending attributes across discontinuities
+		quadricAdd(attribute_quadrics[i0], QA);
+		quadricAdd(attribute_quadrics[i1], QA);
+		quadricAdd(attribute_quadrics[i2], QA);
+
+		quadricAdd(&attribute_gradients[i0 * attribute_count], G, attribute_count);
+		quadricAdd(&attribute_gradients[i1 * attribute_count], G, attribute_count);
+		quadricAdd(&attribute_gradients[i2 * attribute_count], G, attribute_count);
+	}
+}
+
 // does triangle ABC flip when C is replaced with D?
 static bool hasTriangleFlip(const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& d)
 {
@@ -739,7 +903,7 @@ static size_t pickEdgeCollapses(Collapse* collapses, const unsigned int* indices
 	return collapse_count;
 }
 
-static void rankEdgeCollapses(Collapse* collapses, size_t collapse_count, const Vector3* vertex_positions, const Quadric* vertex_quadrics, const unsigned int* remap)
+static void rankEdgeCollapses(Collapse* collapses, size_t collapse_count, const Vector3* vertex_positions, const float* vertex_attributes, const Quadric* vertex_quadrics, const Quadric* attribute_quadrics, const QuadricGrad* attribute_gradients, size_t attribute_count, const unsigned int* remap)
 {
 	for (size_t i = 0; i < collapse_count; ++i)
 	{
@@ -759,6 +923,12 @@ static void rankEdgeCollapses(Collapse* collapses, size_t collapse_count, const
 		float ei = quadricError(qi, vertex_positions[i1]);
 		float ej = quadricError(qj, vertex_positions[j1]);
 
+		if (attribute_count)
+		{
+			ei += quadricError(attribute_quadrics[i0], &attribute_gradients[i0 * attribute_count], attribute_count, vertex_positions[i1], &vertex_attributes[i1 * attribute_count]);
+			ej += quadricError(attribute_quadrics[j0], &attribute_gradients[j0 * attribute_count], attribute_count, vertex_positions[j1], &vertex_attributes[j1 * attribute_count]);
+		}
+
 		// pick edge direction with minimal error
 		c.v0 = ei <= ej ? i0 : j0;
 		c.v1 = ei <= ej ? i1 : j1;
@@ -859,7 +1029,28 @@ static void sortEdgeCollapses(unsigned int* sort_order, const Collapse* collapse
 	}
 }
 
-static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char* collapse_locked, Quadric* vertex_quadrics, const Collapse* collapses, size_t collapse_count, const unsigned int* collapse_order, const unsigned int* remap, const unsigned int* wedge, const unsigned char* vertex_kind, const Vector3* vertex_positions, const EdgeAdjacency& adjacency, size_t triangle_collapse_goal, float error_limit, float& result_error)
+static void collapseQuadrics(Quadric* vertex_quadrics, Quadric* attribute_quadrics, QuadricGrad* attribute_gradients, size_t attribute_count, unsigned int i0, unsigned int i1, const unsigned int* remap, const unsigned int* wedge, const unsigned char* vertex_kind)
+{
+	quadricAdd(vertex_quadrics[remap[i1]], vertex_quadrics[remap[i0]]);
+
+	if (attribute_count)
+	{
+		quadricAdd(attribute_quadrics[i1], attribute_quadrics[i0]);
+		quadricAdd(&attribute_gradients[i1 * attribute_count], &attribute_gradients[i0 * attribute_count], attribute_count);
+
+		// note: this is intentionally missing handling for Kind_Complex; we assume that complex vertices have similar attribute values so just using the primary vertex is fine
+		if (vertex_kind[i0] == Kind_Seam)
+		{
+			// seam collapses involve two edges so we need to update attribute quadrics for both target vertices; position quadrics are shared
+			unsigned int s0 = wedge[i0], s1 = wedge[i1];
+
+			quadricAdd(attribute_quadrics[s1], attribute_quadrics[s0]);
+			quadricAdd(&attribute_gradients[s1 * attribute_count], &attribute_gradients[s0 * attribute_count], attribute_count);
+		}
+	}
+}
+
+static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char* collapse_locked, Quadric* vertex_quadrics, Quadric* attribute_quadrics, QuadricGrad* attribute_gradients, size_t attribute_count, const Collapse* collapses, size_t collapse_count, const unsigned int* collapse_order, const unsigned int* remap, const unsigned int* wedge, const unsigned char* vertex_kind, const Vector3* vertex_positions, const EdgeAdjacency& adjacency, size_t triangle_collapse_goal, float error_limit, float& result_error, float* collapse_errors)
 {
 	size_t edge_collapses = 0;
 	size_t triangle_collapses = 0;
@@ -868,15 +1059,13 @@ static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char*
 	// note that edge_collapse_goal is an estimate; triangle_collapse_goal will be used to actually limit collapses
 	size_t edge_collapse_goal = triangle_collapse_goal / 2;
 
-#if TRACE
 	size_t stats[4] = {};
-#endif
 
 	for (size_t i = 0; i < collapse_count; ++i)
 	{
 		const Collapse& c = collapses[collapse_order[i]];
 
-		TRACESTATS(0);
+		stats[0]++;
 
 		if (c.error > error_limit)
 			break;
@@ -904,7 +1093,7 @@ static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char*
 		// it's important to not move other vertices towards a moved vertex to preserve error since we don't re-rank collapses mid-pass
 		if (collapse_locked[r0] | collapse_locked[r1])
 		{
-			TRACESTATS(1);
+			stats[1]++;
 			continue;
 		}
 
@@ -913,14 +1102,14 @@ static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char*
 			// adjust collapse goal since this collapse is invalid and shouldn't factor into error goal
 			edge_collapse_goal++;
 
-			TRACESTATS(2);
+			stats[2]++;
 			continue;
 		}
 
 		assert(collapse_remap[r0] == r0);
 		assert(collapse_remap[r1] == r1);
 
-		quadricAdd(vertex_quadrics[r1], vertex_quadrics[r0]);
+		collapseQuadrics(vertex_quadrics, attribute_quadrics, attribute_gradients, attribute_count, i0, i1, remap, wedge, vertex_kind);
 
 		if (vertex_kind[i0] == Kind_Complex)
 		{
@@ -954,6 +1143,10 @@ static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char*
 		collapse_locked[r0] = 1;
 		collapse_locked[r1] = 1;
 
+		// each position is collapsed at most once, so we can record the error for all of its wedges in the slot of the primary vertex
+		if (collapse_errors)
+			collapse_errors[r0] = c.error;
+
 		// border edges collapse 1 triangle, other edges collapse 2 or more
 		triangle_collapses += (vertex_kind[i0] == Kind_Border) ? 1 : 2;
 		edge_collapses++;
@@ -961,17 +1154,82 @@ static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char*
 		result_error = result_error < c.error ? c.error : result_error;
 	}
 
-#if TRACE
-	float error_goal_perfect = edge_collapse_goal < collapse_count ? collapses[collapse_order[edge_collapse_goal]].error : 0.f;
-
-	printf("removed %d triangles, error %e (goal %e); evaluated %d/%d collapses (done %d, skipped %d, invalid %d)\n",
-	    int(triangle_collapses), sqrtf(result_error), sqrtf(error_goal_perfect),
-	    int(stats[0]), int(collapse_count), int(edge_collapses), int(stats[1]), int(stats[2]));
-#endif
+	meshopt_Tracer::counter("simplify.candidates", double(collapse_count));
+	meshopt_Tracer::counter("simplify.evaluated", double(stats[0]));
+	meshopt_Tracer::counter("simplify.skipped", double(stats[1]));
+	meshopt_Tracer::counter("simplify.invalid", double(stats[2]));
+	meshopt_Tracer::counter("simplify.collapses", double(edge_collapses));
+	meshopt_Tracer::counter("simplify.triangles_removed", double(triangle_collapses));
 
 	return edge_collapses;
 }
 
+struct CollapseLog
+{
+	// per-vertex collapse target and squared collapse error; ~0u for vertices that were not collapsed
+	unsigned int* parents;
+	float* errors;
+
+	// collapsed vertices in the order of collapse; all wedges of a position are stored contiguously
+	unsigned int* sequence;
+	size_t sequence_count;
+
+	// optional per-vertex position (primary wedge) of collapsed vertices; used to identify groups of wedges that are split together
+	unsigned int* groups;
+
+	// scratch for sorting collapses within each pass
+	Collapse* pass_collapses;
+	unsigned int* pass_order;
+};
+
+static void recordCollapses(CollapseLog& log, const unsigned int* collapse_remap, const unsigned int* remap, const unsigned int* wedge, size_t vertex_count)
+{
+	size_t pass_count = 0;
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		if (collapse_remap[i] == i)
+			continue;
+
+		// vertices are never collapsed twice since all wedges of a position are collapsed together
+		assert(log.parents[i] == ~0u);
+		assert(collapse_remap[remap[i]] != remap[i]);
+
+		log.parents[i] = collapse_remap[i];
+		log.errors[i] = log.errors[remap[i]];
+
+		if (log.groups)
+			log.groups[i] = remap[i];
+
+		// collapses are sorted per position; the remaining wedges follow their primary wedge below
+		if (remap[i] != i)
+			continue;
+
+		Collapse& c = log.pass_collapses[pass_count++];
+		c.v0 = unsigned(i);
+		c.v1 = collapse_remap[i];
+		c.error = log.errors[i];
+	}
+
+	// collapses within a pass are independent; we order them by error so that refinement restores the most significant detail first
+	sortEdgeCollapses(log.pass_order, log.pass_collapses, pass_count);
+
+	// wedges of one position (e.g. along attribute seams) must be split together to avoid cracks, so they are recorded as a contiguous group
+	for (size_t i = 0; i < pass_count; ++i)
+	{
+		unsigned int v = log.pass_collapses[log.pass_order[i]].v0;
+		unsigned int w = v;
+
+		do
+		{
+			if (collapse_remap[w] != w)
+				log.sequence[log.sequence_count++] = w;
+
+			w = wedge[w];
+		} while (w != v);
+	}
+}
+
 static size_t remapIndexBuffer(unsigned int* indices, size_t index_count, const unsigned int* collapse_remap)
 {
 	size_t write = 0;
@@ -1014,131 +1272,587 @@ static void remapEdgeLoops(unsigned int* loop, size_t vertex_count, const unsign
 	}
 }
 
-struct CellHasher
+struct CornerList
 {
-	const unsigned int* vertex_ids;
+	// corners of triangles that reference each position, linked through next; corners of collapsed triangles are skipped (and eventually unlinked)
+	unsigned int* head;
+	unsigned int* next;
+};
 
-	size_t hash(unsigned int i) const
+static void buildCornerLists(CornerList& corners, const unsigned int* indices, size_t index_count, size_t vertex_count, const unsigned int* remap)
+{
+	memset(corners.head, -1, vertex_count * sizeof(unsigned int));
+
+	for (size_t i = index_count; i > 0; --i)
 	{
-		unsigned int h = vertex_ids[i];
+		unsigned int r = remap[indices[i - 1]];
 
-		// MurmurHash2 finalizer
-		h ^= h >> 13;
-		h *= 0x5bd1e995;
-		h ^= h >> 15;
-		return h;
+		corners.next[i - 1] = corners.head[r];
+		corners.head[r] = unsigned(i - 1);
 	}
+}
 
-	bool equal(unsigned int lhs, unsigned int rhs) const
-	{
-		return vertex_ids[lhs] == vertex_ids[rhs];
-	}
-};
+static bool isTriangleCollapsed(const unsigned int* indices, unsigned int corner)
+{
+	const unsigned int* tri = indices + (corner - corner % 3);
 
-struct IdHasher
+	return tri[0] == tri[1] || tri[0] == tri[2] || tri[1] == tri[2];
+}
+
+static bool hasTriangleFlips(const CornerList& corners, const unsigned int* indices, const unsigned int* remap, const Vector3* vertex_positions, unsigned int r0, unsigned int i1)
 {
-	size_t hash(unsigned int id) const
-	{
-		unsigned int h = id;
+	static const unsigned int next[4] = {1, 2, 0, 1};
 
-		// MurmurHash2 finalizer
-		h ^= h >> 13;
-		h *= 0x5bd1e995;
-		h ^= h >> 15;
-		return h;
-	}
+	const Vector3& v0 = vertex_positions[r0];
+	const Vector3& v1 = vertex_positions[i1];
 
-	bool equal(unsigned int lhs, unsigned int rhs) const
+	unsigned int r1 = remap[i1];
+
+	for (unsigned int c = corners.head[r0]; c != ~0u; c = corners.next[c])
 	{
-		return lhs == rhs;
+		if (isTriangleCollapsed(indices, c))
+			continue;
+
+		unsigned int t = c - c % 3;
+		unsigned int a = indices[t + next[c % 3]];
+		unsigned int b = indices[t + next[c % 3 + 1]];
+
+		// skip triangles that get collapsed
+		if (remap[a] == r1 || remap[b] == r1)
+			continue;
+
+		if (hasTriangleFlip(vertex_positions[a], vertex_positions[b], v0, v1))
+			return true;
 	}
-};
 
-struct TriangleHasher
+	return false;
+}
+
+static void rankVertexCollapse(Collapse& best, unsigned int r, const CornerList& corners, const unsigned int* indices, const unsigned int* remap, const unsigned char* vertex_kind, const unsigned int* loop, const Vector3* vertex_positions, const float* vertex_attributes, const Quadric* vertex_quadrics, const Quadric* attribute_quadrics, const QuadricGrad* attribute_gradients, size_t attribute_count)
 {
-	const unsigned int* indices;
+	static const unsigned int next[4] = {1, 2, 0, 1};
 
-	size_t hash(unsigned int i) const
-	{
-		const unsigned int* tri = indices + i * 3;
+	best.v0 = ~0u;
+	best.v1 = ~0u;
+	best.error = FLT_MAX;
 
-		// Optimized Spatial Hashing for Collision Detection of Deformable Objects
-		return (tri[0] * 73856093) ^ (tri[1] * 19349663) ^ (tri[2] * 83492791);
-	}
+	if (vertex_kind[r] == Kind_Locked)
+		return;
 
-	bool equal(unsigned int lhs, unsigned int rhs) const
-	{
-		const unsigned int* lt = indices + lhs * 3;
-		const unsigned int* rt = indices + rhs * 3;
+	// the position quadric is the same for all collapses; a local copy keeps it in registers
+	Quadric q = vertex_quadrics[r];
 
-		return lt[0] == rt[0] && lt[1] == rt[1] && lt[2] == rt[2];
-	}
-};
+	// manifold vertices have a closed triangle fan, so all neighbors can be reached through outgoing half-edges
+	int edges = vertex_kind[r] == Kind_Manifold ? 1 : 2;
 
-static void computeVertexIds(unsigned int* vertex_ids, const Vector3* vertex_positions, size_t vertex_count, int grid_size)
-{
-	assert(grid_size >= 1 && grid_size <= 1024);
-	float cell_scale = float(grid_size - 1);
+	// flip test is more expensive than error evaluation, so the first pass picks the best collapse without it; most of the time it's valid
+	// if it isn't, the second pass runs the flip test for every collapse that would improve the result, skipping the invalid target
+	unsigned int invalid = ~0u;
 
-	for (size_t i = 0; i < vertex_count; ++i)
+	for (int pass = 0; pass < 2; ++pass)
 	{
-		const Vector3& v = vertex_positions[i];
+		for (unsigned int c = corners.head[r]; c != ~0u; c = corners.next[c])
+		{
+			if (isTriangleCollapsed(indices, c))
+				continue;
 
-		int xi = int(v.x * cell_scale + 0.5f);
-		int yi = int(v.y * cell_scale + 0.5f);
-		int zi = int(v.z * cell_scale + 0.5f);
+			unsigned int t = c - c % 3;
+			unsigned int i0 = indices[c];
 
-		vertex_ids[i] = (xi << 20) | (yi << 10) | zi;
+			// each corner provides up to two candidate edges, one for the outgoing half-edge (i0->next) and one for the incoming half-edge (prev->i0)
+			for (int e = 0; e < edges; ++e)
+			{
+				unsigned int i1 = indices[t + next[c % 3 + e]];
+				unsigned int h0 = e == 0 ? i0 : i1;
+				unsigned int h1 = e == 0 ? i1 : i0;
+
+				// the same rules as in pickEdgeCollapses apply, but only the direction that moves r is considered; the opposite one is ranked for the other vertex
+				if (remap[i1] == r || remap[i1] == invalid)
+					continue;
+
+				unsigned char k0 = vertex_kind[i0];
+				unsigned char k1 = vertex_kind[i1];
+
+				if (!kCanCollapse[k0][k1])
+					continue;
+
+				if (k0 == k1 && (k0 == Kind_Border || k0 == Kind_Seam) && loop[h0] != h1)
+					continue;
+
+				float error = quadricError(q, vertex_positions[i1]);
+
+				if (attribute_count)
+					error += quadricError(attribute_quadrics[i0], &attribute_gradients[i0 * attribute_count], attribute_count, vertex_positions[i1], &vertex_attributes[i1 * attribute_count]);
+
+				if (error < best.error && (pass == 0 || !hasTriangleFlips(corners, indices, remap, vertex_positions, r, i1)))
+				{
+					best.v0 = i0;
+					best.v1 = i1;
+					best.error = error;
+				}
+			}
+		}
+
+		// the second pass only picks valid collapses
+		if (pass == 1 || best.v0 == ~0u || !hasTriangleFlips(corners, indices, remap, vertex_positions, r, best.v1))
+			return;
+
+		invalid = remap[best.v1];
+
+		best.v0 = ~0u;
+		best.v1 = ~0u;
+		best.error = FLT_MAX;
 	}
 }
 
-static size_t countTriangles(const unsigned int* vertex_ids, const unsigned int* indices, size_t index_count)
+struct CollapseHeap
 {
-	size_t result = 0;
+	// positions ordered by key; slots maps each position to its heap index, ~0u if it's not in the heap
+	// keys are lower bounds of collapse errors: increases are applied lazily once the position reaches the top, decreases are applied immediately
+	unsigned int* heap;
+	unsigned int* slots;
+	float* keys;
+	size_t size;
+};
 
-	for (size_t i = 0; i < index_count; i += 3)
+static void heapSiftUp(CollapseHeap& heap, size_t i)
+{
+	unsigned int v = heap.heap[i];
+
+	while (i > 0)
 	{
-		unsigned int id0 = vertex_ids[indices[i + 0]];
-		unsigned int id1 = vertex_ids[indices[i + 1]];
-		unsigned int id2 = vertex_ids[indices[i + 2]];
+		size_t parent = (i - 1) / 2;
+		unsigned int p = heap.heap[parent];
 
-		result += (id0 != id1) & (id0 != id2) & (id1 != id2);
+		if (heap.keys[p] <= heap.keys[v])
+			break;
+
+		heap.heap[i] = p;
+		heap.slots[p] = unsigned(i);
+		i = parent;
 	}
 
-	return result;
+	heap.heap[i] = v;
+	heap.slots[v] = unsigned(i);
 }
 
-static size_t fillVertexCells(unsigned int* table, size_t table_size, unsigned int* vertex_cells, const unsigned int* vertex_ids, size_t vertex_count)
+static void heapSiftDown(CollapseHeap& heap, size_t i)
 {
-	CellHasher hasher = {vertex_ids};
+	unsigned int v = heap.heap[i];
 
-	memset(table, -1, table_size * sizeof(unsigned int));
+	for (;;)
+	{
+		size_t child = i * 2 + 1;
 
-	size_t result = 0;
+		if (child >= heap.size)
+			break;
 
-	for (size_t i = 0; i < vertex_count; ++i)
-	{
-		unsigned int* entry = hashLookup2(table, table_size, hasher, unsigned(i), ~0u);
+		if (child + 1 < heap.size && heap.keys[heap.heap[child + 1]] < heap.keys[heap.heap[child]])
+			child++;
 
-		if (*entry == ~0u)
-		{
-			*entry = unsigned(i);
-			vertex_cells[i] = unsigned(result++);
-		}
-		else
-		{
-			vertex_cells[i] = vertex_cells[*entry];
-		}
+		unsigned int c = heap.heap[child];
+
+		if (heap.keys[v] <= heap.keys[c])
+			break;
+
+		heap.heap[i] = c;
+		heap.slots[c] = unsigned(i);
+		i = child;
 	}
 
-	return result;
+	heap.heap[i] = v;
+	heap.slots[v] = unsigned(i);
 }
 
-static size_t countVertexCells(unsigned int* table, size_t table_size, const unsigned int* vertex_ids, size_t vertex_count)
+static void heapPop(CollapseHeap& heap)
 {
-	IdHasher hasher;
+	assert(heap.size > 0);
 
-	memset(table, -1, table_size * sizeof(unsigned int));
+	heap.slots[heap.heap[0]] = ~0u;
+	heap.size--;
+
+	if (heap.size > 0)
+	{
+		heap.heap[0] = heap.heap[heap.size];
+		heapSiftDown(heap, 0);
+	}
+}
+
+static void heapUpdate(CollapseHeap& heap, const Collapse& best, unsigned int v)
+{
+	// positions without a valid collapse stay in the heap until they reach the top
+	if (best.v0 == ~0u)
+		return;
+
+	if (heap.slots[v] == ~0u)
+	{
+		heap.heap[heap.size] = v;
+		heap.keys[v] = best.error;
+		heap.size++;
+
+		heapSiftUp(heap, heap.size - 1);
+	}
+	else if (best.error < heap.keys[v])
+	{
+		heap.keys[v] = best.error;
+
+		heapSiftUp(heap, heap.slots[v]);
+	}
+}
+
+static void collapseEdgeLoop(unsigned int* loop, unsigned int* loopback, unsigned int v, unsigned int target)
+{
+	// neighbors along the edge loop that point to v need to point to the target instead; when the target is the neighbor itself, the loop skips over v
+	unsigned int prev = loopback[v];
+	unsigned int next = loop[v];
+
+	if (prev != ~0u && prev != v && loop[prev] == v)
+		loop[prev] = (prev == target) ? next : target;
+
+	if (next != ~0u && next != v && loopback[next] == v)
+		loopback[next] = (next == target) ? prev : target;
+}
+
+static size_t collapseVertex(CornerList& corners, unsigned int* indices, const Collapse& c, const unsigned int* remap, const unsigned int* wedge, const unsigned char* vertex_kind, unsigned int* loop, unsigned int* loopback, CollapseLog* log)
+{
+	unsigned int i0 = c.v0;
+	unsigned int i1 = c.v1;
+
+	unsigned int r0 = remap[i0];
+	unsigned int r1 = remap[i1];
+
+	// all wedges of the position move together, matching collapse_remap in performEdgeCollapses: complex vertices move to the target position,
+	// seam vertices move to the matching wedge of the target, and all other vertices only have one wedge
+	unsigned int v = i0;
+
+	do
+	{
+		unsigned int target = (vertex_kind[i0] == Kind_Complex) ? r1 : (v == i0) ? i1 : wedge[i1];
+
+		collapseEdgeLoop(loop, loopback, v, target);
+
+		if (log)
+		{
+			log->parents[v] = target;
+			log->errors[v] = c.error;
+			log->sequence[log->sequence_count++] = v;
+
+			if (log->groups)
+				log->groups[v] = r0;
+		}
+
+		v = wedge[v];
+	} while (v != i0);
+
+	// rewrite all corners of the collapsed position; triangles that become degenerate are removed from the result
+	size_t triangle_collapses = 0;
+	unsigned int last = ~0u;
+
+	for (unsigned int k = corners.head[r0]; k != ~0u; k = corners.next[k])
+	{
+		bool collapsed = isTriangleCollapsed(indices, k);
+
+		unsigned int w = indices[k];
+		assert(remap[w] == r0);
+
+		indices[k] = (vertex_kind[i0] == Kind_Complex) ? r1 : (w == i0) ? i1 : wedge[i1];
+
+		triangle_collapses += !collapsed && isTriangleCollapsed(indices, k);
+		last = k;
+	}
+
+	// corners of the collapsed position now reference the target position
+	if (last != ~0u)
+	{
+		corners.next[last] = corners.head[r1];
+		corners.head[r1] = corners.head[r0];
+		corners.head[r0] = ~0u;
+	}
+
+	return triangle_collapses;
+}
+
+static size_t performExactCollapses(meshopt_Context* context, CollapseLog* log, unsigned int* indices, size_t index_count, size_t vertex_count, size_t target_index_count, float error_limit, float& result_error, Quadric* vertex_quadrics, Quadric* attribute_quadrics, QuadricGrad* attribute_gradients, size_t attribute_count, const float* vertex_attributes, const Vector3* vertex_positions, const unsigned int* remap, const unsigned int* wedge, const unsigned char* vertex_kind, unsigned int* loop, unsigned int* loopback, meshopt_Allocator& allocator)
+{
+	static const unsigned int next[4] = {1, 2, 0, 1};
+
+	CornerList corners = {};
+	corners.head = allocator.allocate<unsigned int>(vertex_count);
+	corners.next = allocator.allocate<unsigned int>(index_count);
+	buildCornerLists(corners, indices, index_count, vertex_count, remap);
+
+	Collapse* best = allocator.allocate<Collapse>(vertex_count);
+
+	CollapseHeap heap = {};
+	heap.heap = allocator.allocate<unsigned int>(vertex_count);
+	heap.slots = allocator.allocate<unsigned int>(vertex_count);
+	heap.keys = allocator.allocate<float>(vertex_count);
+	memset(heap.slots, -1, vertex_count * sizeof(unsigned int));
+
+	// positions that were re-ranked after a given collapse; avoids ranking vertices that share several triangles with the target twice
+	unsigned int* rank_stamps = allocator.allocate<unsigned int>(vertex_count);
+	memset(rank_stamps, -1, vertex_count * sizeof(unsigned int));
+
+	// degenerate input triangles are never part of the result
+	size_t result_count = 0;
+
+	for (size_t i = 0; i < index_count; i += 3)
+		result_count += isTriangleCollapsed(indices, unsigned(i)) ? 0 : 3;
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		if (remap[i] != i)
+			continue;
+
+		rankVertexCollapse(best[i], unsigned(i), corners, indices, remap, vertex_kind, loop, vertex_positions, vertex_attributes, vertex_quadrics, attribute_quadrics, attribute_gradients, attribute_count);
+		heapUpdate(heap, best[i], unsigned(i));
+	}
+
+	size_t edge_collapses = 0;
+	size_t reranks = 0;
+
+	// progress is reported in steps that are comparable to the default mode passes
+	size_t report_step = result_count > target_index_count ? (result_count - target_index_count) / 16 + 3 : 0;
+	size_t report_count = result_count > report_step ? result_count - report_step : 0;
+
+	while (result_count > target_index_count && heap.size)
+	{
+		unsigned int r0 = heap.heap[0];
+		Collapse c = best[r0];
+
+		// lazy re-ranking: collapse error may have increased (or the collapse may have become invalid) after the position was added to the heap
+		if (c.v0 == ~0u)
+		{
+			heapPop(heap);
+			continue;
+		}
+
+		if (heap.keys[r0] < c.error)
+		{
+			heap.keys[r0] = c.error;
+			heapSiftDown(heap, 0);
+			continue;
+		}
+
+		if (c.error > error_limit)
+			break;
+
+		heapPop(heap);
+
+		unsigned int r1 = remap[c.v1];
+
+		// collapses are re-ranked after every change to their neighborhood, so the top of the heap is always valid
+		assert(!hasTriangleFlips(corners, indices, remap, vertex_positions, r0, c.v1));
+
+		collapseQuadrics(vertex_quadrics, attribute_quadrics, attribute_gradients, attribute_count, c.v0, c.v1, remap, wedge, vertex_kind);
+
+		unsigned int tail = corners.head[r1];
+
+		size_t triangle_collapses = collapseVertex(corners, indices, c, remap, wedge, vertex_kind, loop, loopback, log);
+		assert(triangle_collapses * 3 <= result_count);
+
+		result_count -= triangle_collapses * 3;
+		result_error = result_error < c.error ? c.error : result_error;
+		edge_collapses++;
+
+		// only the target and the neighbors of the collapsed vertex (including vertices of removed triangles) can have a different collapse now:
+		// their quadrics, triangle fans or edge loops changed, whereas the collapse errors of other vertices only depend on target positions
+		rank_stamps[r1] = unsigned(edge_collapses);
+
+		bool moved = true;
+		unsigned int* link = &corners.head[r1];
+
+		while (*link != ~0u)
+		{
+			unsigned int k = *link;
+			unsigned int t = k - k % 3;
+			bool collapsed = isTriangleCollapsed(indices, k);
+
+			// corners of the collapsed vertex were prepended to the target list
+			moved &= k != tail;
+
+			for (int e = 0; moved && e < 2; ++e)
+			{
+				unsigned int n = remap[indices[t + next[k % 3 + e]]];
+
+				if (rank_stamps[n] == unsigned(edge_collapses))
+					continue;
+
+				rank_stamps[n] = unsigned(edge_collapses);
+
+				rankVertexCollapse(best[n], n, corners, indices, remap, vertex_kind, loop, vertex_positions, vertex_attributes, vertex_quadrics, attribute_quadrics, attribute_gradients, attribute_count);
+				heapUpdate(heap, best[n], n);
+				reranks++;
+			}
+
+			// corners of removed triangles don't need to be visited again
+			if (collapsed)
+				*link = corners.next[k];
+			else
+				link = &corners.next[k];
+		}
+
+		rankVertexCollapse(best[r1], r1, corners, indices, remap, vertex_kind, loop, vertex_positions, vertex_attributes, vertex_quadrics, attribute_quadrics, attribute_gradients, attribute_count);
+		heapUpdate(heap, best[r1], r1);
+
+		// indices contain a valid mesh once the removed triangles are filtered out, so we can stop early if the caller requests cancellation
+		if (context && context->progress && result_count <= report_count)
+		{
+			report_count = result_count > report_step ? result_count - report_step : 0;
+
+			float fraction = float(index_count - result_count) / float(index_count - target_index_count);
+
+			if (!context->progress(context->userdata, fraction, result_count, sqrtf(result_error)))
+				break;
+		}
+	}
+
+	meshopt_Tracer::counter("simplify.collapses", double(edge_collapses));
+	meshopt_Tracer::counter("simplify.reranks", double(reranks));
+
+	size_t write = 0;
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		if (isTriangleCollapsed(indices, unsigned(i)))
+			continue;
+
+		indices[write + 0] = indices[i + 0];
+		indices[write + 1] = indices[i + 1];
+		indices[write + 2] = indices[i + 2];
+		write += 3;
+	}
+
+	assert(write == result_count);
+
+	return write;
+}
+
+struct CellHasher
+{
+	const unsigned int* vertex_ids;
+
+	size_t hash(unsigned int i) const
+	{
+		unsigned int h = vertex_ids[i];
+
+		// MurmurHash2 finalizer
+		h ^= h >> 13;
+		h *= 0x5bd1e995;
+		h ^= h >> 15;
+		return h;
+	}
+
+	bool equal(unsigned int lhs, unsigned int rhs) const
+	{
+		return vertex_ids[lhs] == vertex_ids[rhs];
+	}
+};
+
+struct IdHasher
+{
+	size_t hash(unsigned int id) const
+	{
+		unsigned int h = id;
+
+		// MurmurHash2 finalizer
+		h ^= h >> 13;
+		h *= 0x5bd1e995;
+		h ^= h >> 15;
+		return h;
+	}
+
+	bool equal(unsigned int lhs, unsigned int rhs) const
+	{
+		return lhs == rhs;
+	}
+};
+
+struct TriangleHasher
+{
+	const unsigned int* indices;
+
+	size_t hash(unsigned int i) const
+	{
+		const unsigned int* tri = indices + i * 3;
+
+		// Optimized Spatial Hashing for Collision Detection of Deformable Objects
+		return (tri[0] * 73856093) ^ (tri[1] * 19349663) ^ (tri[2] * 83492791);
+	}
+
+	bool equal(unsigned int lhs, unsigned int rhs) const
+	{
+		const unsigned int* lt = indices + lhs * 3;
+		const unsigned int* rt = indices + rhs * 3;
+
+		return lt[0] == rt[0] && lt[1] == rt[1] && lt[2] == rt[2];
+	}
+};
+
+static void computeVertexIds(unsigned int* vertex_ids, const Vector3* vertex_positions, size_t vertex_count, int grid_size)
+{
+	assert(grid_size >= 1 && grid_size <= 1024);
+	float cell_scale = float(grid_size - 1);
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		const Vector3& v = vertex_positions[i];
+
+		int xi = int(v.x * cell_scale + 0.5f);
+		int yi = int(v.y * cell_scale + 0.5f);
+		int zi = int(v.z * cell_scale + 0.5f);
+
+		vertex_ids[i] = (xi << 20) | (yi << 10) | zi;
+	}
+}
+
+static size_t countTriangles(const unsigned int* vertex_ids, const unsigned int* indices, size_t index_count)
+{
+	size_t result = 0;
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		unsigned int id0 = vertex_ids[indices[i + 0]];
+		unsigned int id1 = vertex_ids[indices[i + 1]];
+		unsigned int id2 = vertex_ids[indices[i + 2]];
+
+		result += (id0 != id1) & (id0 != id2) & (id1 != id2);
+	}
+
+	return result;
+}
+
+static size_t fillVertexCells(unsigned int* table, size_t table_size, unsigned int* vertex_cells, const unsigned int* vertex_ids, size_t vertex_count)
+{
+	CellHasher hasher = {vertex_ids};
+
+	memset(table, -1, table_size * sizeof(unsigned int));
+
+	size_t result = 0;
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		unsigned int* entry = hashLookup2(table, table_size, hasher, unsigned(i), ~0u);
+
+		if (*entry == ~0u)
+		{
+			*entry = unsigned(i);
+			vertex_cells[i] = unsigned(result++);
+		}
+		else
+		{
+			vertex_cells[i] = vertex_cells[*entry];
+		}
+	}
+
+	return result;
+}
+
+static size_t countVertexCells(unsigned int* table, size_t table_size, const unsigned int* vertex_ids, size_t vertex_count)
+{
+	IdHasher hasher;
+
+	memset(table, -1, table_size * sizeof(unsigned int));
 
 	size_t result = 0;
 
@@ -1198,15 +1912,46 @@ static void fillCellQuadrics(Quadric* cell_quadrics, const Vector3* vertex_posit
 	}
 }
 
-static void fillCellRemap(unsigned int* cell_remap, float* cell_errors, size_t cell_count, const unsigned int* vertex_cells, const Quadric* cell_quadrics, const Vector3* vertex_positions, size_t vertex_count)
+static void fillCellColors(float* cell_colors, const float* vertex_colors, size_t vertex_colors_stride, size_t vertex_count, const unsigned int* vertex_cells)
+{
+	size_t vertex_stride_float = vertex_colors_stride / sizeof(float);
+
+	// each cell accumulates the sum of colors and the number of points
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		unsigned int c = vertex_cells[i];
+		const float* color = vertex_colors + i * vertex_stride_float;
+
+		cell_colors[c * 4 + 0] += color[0];
+		cell_colors[c * 4 + 1] += color[1];
+		cell_colors[c * 4 + 2] += color[2];
+		cell_colors[c * 4 + 3] += 1.f;
+	}
+}
+
+static void fillCellRemap(unsigned int* cell_remap, float* cell_errors, size_t cell_count, const unsigned int* vertex_cells, const Quadric* cell_quadrics, const Vector3* vertex_positions, size_t vertex_count, const float* cell_colors, const float* vertex_colors, size_t vertex_colors_stride, float color_weight)
 {
 	memset(cell_remap, -1, cell_count * sizeof(unsigned int));
 
+	size_t vertex_stride_float = vertex_colors_stride / sizeof(float);
+
 	for (size_t i = 0; i < vertex_count; ++i)
 	{
 		unsigned int cell = vertex_cells[i];
 		float error = quadricError(cell_quadrics[cell], vertex_positions[i]);
 
+		if (cell_colors)
+		{
+			// point quadric error is the mean squared distance to all points in the cell, up to a constant; we add squared distance to the mean color
+			const float* color = vertex_colors + i * vertex_stride_float;
+			const float* sum = &cell_colors[cell * 4];
+
+			float scale = 1.f / sum[3];
+			float dr = color[0] - sum[0] * scale, dg = color[1] - sum[1] * scale, db = color[2] - sum[2] * scale;
+
+			error += (dr * dr + dg * dg + db * db) * color_weight * color_weight;
+		}
+
 		if (cell_remap[cell] == ~0u || cell_errors[cell] > error)
 		{
 			cell_remap[cell] = unsigned(i);
@@ -1250,177 +1995,595 @@ static size_t filterTriangles(unsigned int* destination, unsigned int* tritable,
 			destination[result * 3 + 1] = b;
 			destination[result * 3 + 2] = c;
 
-			unsigned int* entry = hashLookup2(tritable, tritable_size, hasher, unsigned(result), ~0u);
+			unsigned int* entry = hashLookup2(tritable, tritable_size, hasher, unsigned(result), ~0u);
+
+			if (*entry == ~0u)
+				*entry = unsigned(result++);
+		}
+	}
+
+	return result * 3;
+}
+
+static float interpolate(float y, float x0, float y0, float x1, float y1, float x2, float y2)
+{
+	// three point interpolation from "revenge of interpolation search" paper
+	float num = (y1 - y) * (x1 - x2) * (x1 - x0) * (y2 - y0);
+	float den = (y2 - y) * (x1 - x2) * (y0 - y1) + (y0 - y) * (x1 - x0) * (y1 - y2);
+	return x1 + num / den;
+}
+
+static unsigned int refineLevel(const meshopt_VertexSplit* splits, unsigned int a, unsigned int b, unsigned int level)
+{
+	// walk both collapse chains towards the base mesh until they meet; parents always have smaller indices than children
+	unsigned int pa = ~0u, pb = ~0u;
+
+	while (a != b)
+	{
+		if (a > b)
+		{
+			if (splits[a].parent == a)
+				return level;
+
+			pa = a;
+			a = splits[a].parent;
+		}
+		else
+		{
+			if (splits[b].parent == b)
+				return level;
+
+			pb = b;
+			b = splits[b].parent;
+		}
+	}
+
+	// the corners map to the same vertex until the first vertex on either chain before the meeting point becomes active
+	unsigned int split = pa < pb ? pa : pb;
+
+	if (split == ~0u)
+		return ~0u;
+
+	return level == ~0u ? level : (level < split + 1 ? split + 1 : level);
+}
+
+} // namespace meshopt
+
+#ifndef NDEBUG
+// Note: this is only exposed for debug visualization purposes; do *not* use these in debug builds
+MESHOPTIMIZER_API unsigned char* meshopt_simplifyDebugKind = 0;
+MESHOPTIMIZER_API unsigned int* meshopt_simplifyDebugLoop = 0;
+MESHOPTIMIZER_API unsigned int* meshopt_simplifyDebugLoopBack = 0;
+#endif
+
+static size_t meshopt_simplifyEdge(meshopt_Context* context, meshopt::CollapseLog* log, unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes_data, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, size_t target_index_count, float target_error, unsigned int options, float* out_result_error)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+	assert(target_index_count <= index_count);
+	assert((options & ~(meshopt_SimplifyLockBorder | meshopt_SimplifyExactOrder)) == 0);
+	assert(vertex_attributes_stride >= attribute_count * sizeof(float) && vertex_attributes_stride <= 256);
+	assert(vertex_attributes_stride % sizeof(float) == 0);
+	assert(attribute_count <= kMaxAttributes);
+
+	meshopt_Tracer zone("meshopt_simplify");
+	meshopt_Allocator allocator(context);
+
+	unsigned int* result = destination;
+
+	allocator.stage("classify");
+
+	// build adjacency information
+	EdgeAdjacency adjacency = {};
+	prepareEdgeAdjacency(adjacency, index_count, vertex_count, allocator);
+	updateEdgeAdjacency(adjacency, indices, index_count, vertex_count, NULL);
+
+	// build position remap that maps each vertex to the one with identical position
+	unsigned int* remap = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* wedge = allocator.allocate<unsigned int>(vertex_count);
+	buildPositionRemap(remap, wedge, vertex_positions_data, vertex_count, vertex_positions_stride, allocator);
+
+	// classify vertices; vertex kind determines collapse rules, see kCanCollapse
+	unsigned char* vertex_kind = allocator.allocate<unsigned char>(vertex_count);
+	unsigned int* loop = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* loopback = allocator.allocate<unsigned int>(vertex_count);
+	classifyVertices(vertex_kind, loop, loopback, vertex_count, adjacency, remap, wedge, options);
+
+	if (meshopt_Tracer::enabled())
+	{
+		size_t kinds[Kind_Count] = {};
+		for (size_t i = 0; i < vertex_count; ++i)
+			kinds[vertex_kind[i]] += remap[i] == i;
+
+		meshopt_Tracer::counter("simplify.positions", double(kinds[Kind_Manifold] + kinds[Kind_Border] + kinds[Kind_Seam] + kinds[Kind_Complex] + kinds[Kind_Locked]));
+		meshopt_Tracer::counter("simplify.manifold", double(kinds[Kind_Manifold]));
+		meshopt_Tracer::counter("simplify.border", double(kinds[Kind_Border]));
+		meshopt_Tracer::counter("simplify.seam", double(kinds[Kind_Seam]));
+		meshopt_Tracer::counter("simplify.complex", double(kinds[Kind_Complex]));
+		meshopt_Tracer::counter("simplify.locked", double(kinds[Kind_Locked]));
+	}
+
+	allocator.stage("quadrics");
+
+	Vector3* vertex_positions = allocator.allocate<Vector3>(vertex_count);
+	rescalePositions(vertex_positions, vertex_positions_data, vertex_count, vertex_positions_stride);
+
+	Quadric* vertex_quadrics = allocator.allocate<Quadric>(vertex_count);
+	memset(vertex_quadrics, 0, vertex_count * sizeof(Quadric));
+
+	fillFaceQuadrics(vertex_quadrics, indices, index_count, vertex_positions, remap);
+	fillEdgeQuadrics(vertex_quadrics, indices, index_count, vertex_positions, remap, vertex_kind, loop, loopback);
+
+	float* vertex_attributes = NULL;
+	Quadric* attribute_quadrics = NULL;
+	QuadricGrad* attribute_gradients = NULL;
+
+	if (attribute_count)
+	{
+		vertex_attributes = allocator.allocate<float>(vertex_count * attribute_count);
+		rescaleAttributes(vertex_attributes, vertex_attributes_data, vertex_count, vertex_attributes_stride, attribute_weights, attribute_count);
+
+		attribute_quadrics = allocator.allocate<Quadric>(vertex_count);
+		memset(attribute_quadrics, 0, vertex_count * sizeof(Quadric));
+
+		attribute_gradients = allocator.allocate<QuadricGrad>(vertex_count * attribute_count);
+		memset(attribute_gradients, 0, vertex_count * attribute_count * sizeof(QuadricGrad));
+
+		fillAttributeQuadrics(attribute_quadrics, attribute_gradients, indices, index_count, vertex_positions, vertex_attributes, attribute_count);
+	}
+
+	if (result != indices)
+		memcpy(result, indices, index_count * sizeof(unsigned int));
+
+	allocator.stage("collapse");
+
+	size_t result_count = index_count;
+	float result_error = 0;
+
+	// target_error input is linear; we need to adjust it to match quadricError units
+	float error_limit = target_error * target_error;
+
+	if (options & meshopt_SimplifyExactOrder)
+	{
+		// collapses are performed one at a time in the order of increasing error; quadrics, topology and collapse errors are updated around each collapsed vertex
+		result_count = performExactCollapses(context, log, result, index_count, vertex_count, target_index_count, error_limit, result_error, vertex_quadrics, attribute_quadrics, attribute_gradients, attribute_count, vertex_attributes, vertex_positions, remap, wedge, vertex_kind, loop, loopback, allocator);
+	}
+	else
+	{
+		size_t pass_count = 0;
+
+		Collapse* edge_collapses = allocator.allocate<Collapse>(index_count);
+		unsigned int* collapse_order = allocator.allocate<unsigned int>(index_count);
+		unsigned int* collapse_remap = allocator.allocate<unsigned int>(vertex_count);
+		unsigned char* collapse_locked = allocator.allocate<unsigned char>(vertex_count);
+
+		while (result_count > target_index_count)
+		{
+			// note: throughout the simplification process adjacency structure reflects welded topology for result-in-progress
+			updateEdgeAdjacency(adjacency, result, result_count, vertex_count, remap);
+
+			size_t edge_collapse_count = pickEdgeCollapses(edge_collapses, result, result_count, remap, vertex_kind, loop);
+
+			// no edges can be collapsed any more due to topology restrictions
+			if (edge_collapse_count == 0)
+				break;
+
+			rankEdgeCollapses(edge_collapses, edge_collapse_count, vertex_positions, vertex_attributes, vertex_quadrics, attribute_quadrics, attribute_gradients, attribute_count, remap);
+
+#if TRACE > 1
+			dumpEdgeCollapses(edge_collapses, edge_collapse_count, vertex_kind);
+#endif
+
+			sortEdgeCollapses(collapse_order, edge_collapses, edge_collapse_count);
+
+			size_t triangle_collapse_goal = (result_count - target_index_count) / 3;
+
+			for (size_t i = 0; i < vertex_count; ++i)
+				collapse_remap[i] = unsigned(i);
+
+			memset(collapse_locked, 0, vertex_count);
+
+			pass_count++;
+
+			size_t collapses = performEdgeCollapses(collapse_remap, collapse_locked, vertex_quadrics, attribute_quadrics, attribute_gradients, attribute_count, edge_collapses, edge_collapse_count, collapse_order, remap, wedge, vertex_kind, vertex_positions, adjacency, triangle_collapse_goal, error_limit, result_error, log ? log->errors : NULL);
+
+			// no edges can be collapsed any more due to hitting the error limit or triangle collapse limit
+			if (collapses == 0)
+				break;
+
+			if (log)
+				recordCollapses(*log, collapse_remap, remap, wedge, vertex_count);
+
+			remapEdgeLoops(loop, vertex_count, collapse_remap);
+			remapEdgeLoops(loopback, vertex_count, collapse_remap);
+
+			size_t new_count = remapIndexBuffer(result, result_count, collapse_remap);
+			assert(new_count < result_count);
+
+			result_count = new_count;
+
+			// each pass leaves a valid index buffer in result, so we can stop early if the caller requests cancellation
+			if (context && context->progress)
+			{
+				float fraction = float(index_count - result_count) / float(index_count - target_index_count);
+
+				if (!context->progress(context->userdata, fraction, result_count, sqrtf(result_error)))
+					break;
+			}
+		}
+
+		meshopt_Tracer::counter("simplify.passes", double(pass_count));
+	}
+
+	meshopt_Tracer::counter("simplify.result_triangles", double(result_count / 3));
+	meshopt_Tracer::counter("simplify.result_error", sqrtf(result_error));
+
+#if TRACE > 1
+	dumpLockedCollapses(result, result_count, vertex_kind);
+#endif
+
+#ifndef NDEBUG
+	if (meshopt_simplifyDebugKind)
+		memcpy(meshopt_simplifyDebugKind, vertex_kind, vertex_count);
+
+	if (meshopt_simplifyDebugLoop)
+		memcpy(meshopt_simplifyDebugLoop, loop, vertex_count * sizeof(unsigned int));
+
+	if (meshopt_simplifyDebugLoopBack)
+		memcpy(meshopt_simplifyDebugLoopBack, loopback, vertex_count * sizeof(unsigned int));
+#endif
+
+	// result_error is quadratic; we need to remap it back to linear
+	if (out_result_error)
+		*out_result_error = sqrtf(result_error);
+
+	return result_count;
+}
+
+size_t meshopt_simplify(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options, float* out_result_error)
+{
+	return meshopt_simplifyEdge(NULL, NULL, destination, indices, index_count, vertex_positions_data, vertex_count, vertex_positions_stride, NULL, 0, NULL, 0, target_index_count, target_error, options, out_result_error);
+}
+
+size_t meshopt_simplifyWithAttributes(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes_data, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, size_t target_index_count, float target_error, unsigned int options, float* out_result_error)
+{
+	return meshopt_simplifyEdge(NULL, NULL, destination, indices, index_count, vertex_positions_data, vertex_count, vertex_positions_stride, vertex_attributes_data, vertex_attributes_stride, attribute_weights, attribute_count, target_index_count, target_error, options, out_result_error);
+}
+
+size_t meshopt_simplifyWithContext(meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes_data, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, size_t target_index_count, float target_error, unsigned int options, float* out_result_error)
+{
+	return meshopt_simplifyEdge(context, NULL, destination, indices, index_count, vertex_positions_data, vertex_count, vertex_positions_stride, vertex_attributes_data, vertex_attributes_stride, attribute_weights, attribute_count, target_index_count, target_error, options, out_result_error);
+}
+
+size_t meshopt_simplifyScratchSize(size_t index_count, size_t vertex_count, size_t attribute_count, unsigned int options)
+{
+	using namespace meshopt;
+
+	// this needs to match the allocation sequence in meshopt_simplifyEdge
+	size_t size = 0;
+
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // adjacency.counts
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // adjacency.offsets
+	size = meshopt_Allocator::scratchSize<EdgeAdjacency::Edge>(size, index_count); // adjacency.data
+
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // remap
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // wedge
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, hashBuckets2(vertex_count)); // buildPositionRemap
+
+	size = meshopt_Allocator::scratchSize<unsigned char>(size, vertex_count); // vertex_kind
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // loop
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // loopback
+
+	size = meshopt_Allocator::scratchSize<Vector3>(size, vertex_count); // vertex_positions
+	size = meshopt_Allocator::scratchSize<Quadric>(size, vertex_count); // vertex_quadrics
+
+	if (attribute_count)
+	{
+		size = meshopt_Allocator::scratchSize<float>(size, vertex_count * attribute_count); // vertex_attributes
+		size = meshopt_Allocator::scratchSize<Quadric>(size, vertex_count); // attribute_quadrics
+		size = meshopt_Allocator::scratchSize<QuadricGrad>(size, vertex_count * attribute_count); // attribute_gradients
+	}
+
+	if (options & meshopt_SimplifyExactOrder)
+	{
+		// this needs to match the allocation sequence in performExactCollapses
+		size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // corners.head
+		size = meshopt_Allocator::scratchSize<unsigned int>(size, index_count); // corners.next
+		size = meshopt_Allocator::scratchSize<Collapse>(size, vertex_count); // best
+		size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // heap.heap
+		size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // heap.slots
+		size = meshopt_Allocator::scratchSize<float>(size, vertex_count); // heap.keys
+		size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // rank_stamps
+	}
+	else
+	{
+		size = meshopt_Allocator::scratchSize<Collapse>(size, index_count); // edge_collapses
+		size = meshopt_Allocator::scratchSize<unsigned int>(size, index_count); // collapse_order
+		size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // collapse_remap
+		size = meshopt_Allocator::scratchSize<unsigned char>(size, vertex_count); // collapse_locked
+	}
+
+	return size;
+}
+
+size_t meshopt_simplifyProgressive(unsigned int* destination, unsigned int* vertex_remap, meshopt_VertexSplit* splits, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+
+	meshopt_Tracer zone("meshopt_simplifyProgressive");
+	meshopt_Allocator allocator;
+
+	// copy indices so that destination can alias them; destination is used as scratch during simplification
+	unsigned int* source = allocator.allocate<unsigned int>(index_count);
+	memcpy(source, indices, index_count * sizeof(unsigned int));
+
+	CollapseLog log = {};
+	log.parents = allocator.allocate<unsigned int>(vertex_count);
+	log.errors = allocator.allocate<float>(vertex_count);
+	log.sequence = allocator.allocate<unsigned int>(vertex_count);
+	log.pass_collapses = allocator.allocate<Collapse>(vertex_count);
+	log.pass_order = allocator.allocate<unsigned int>(vertex_count);
+	log.groups = allocator.allocate<unsigned int>(vertex_count);
+
+	memset(log.parents, -1, vertex_count * sizeof(unsigned int));
+	memset(log.errors, 0, vertex_count * sizeof(float));
+
+	size_t base_index_count = meshopt_simplifyEdge(NULL, &log, destination, source, index_count, vertex_positions_data, vertex_count, vertex_positions_stride, NULL, 0, NULL, 0, target_index_count, target_error, options, NULL);
+	(void)base_index_count;
+
+	// vertices that are referenced by the source mesh, or are a target of a collapse of such vertex, are part of the progressive mesh
+	unsigned char* used = allocator.allocate<unsigned char>(vertex_count);
+	memset(used, 0, vertex_count);
+
+	for (size_t i = 0; i < index_count; ++i)
+	{
+		assert(source[i] < vertex_count);
+		used[source[i]] = 1;
+	}
+
+	// collapse targets are collapsed after their sources (or never), so a single forward pass propagates the flags
+	for (size_t i = 0; i < log.sequence_count; ++i)
+	{
+		unsigned int v = log.sequence[i];
+		used[log.parents[v]] |= used[v];
+	}
+
+	// base vertices come first in their original order, followed by collapsed vertices in the reverse collapse order
+	memset(vertex_remap, -1, vertex_count * sizeof(unsigned int));
+
+	unsigned int next_vertex = 0;
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		if (used[i] && log.parents[i] == ~0u)
+			vertex_remap[i] = next_vertex++;
+
+	size_t base_vertex_count = next_vertex;
+
+	for (size_t i = log.sequence_count; i > 0; --i)
+	{
+		unsigned int v = log.sequence[i - 1];
+
+		if (used[v])
+			vertex_remap[v] = next_vertex++;
+	}
+
+	size_t progressive_vertex_count = next_vertex;
+
+	unsigned int* vertex_order = allocator.allocate<unsigned int>(progressive_vertex_count);
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		if (vertex_remap[i] != ~0u)
+			vertex_order[vertex_remap[i]] = unsigned(i);
+
+	// error of the mesh with N vertices is the maximum error of all collapses that haven't been undone by refining to N vertices
+	float error = 0.f;
+
+	for (size_t i = progressive_vertex_count; i > 0; --i)
+	{
+		unsigned int v = vertex_order[i - 1];
+		unsigned int parent = log.parents[v];
+
+		splits[i - 1].parent = (parent == ~0u) ? unsigned(i - 1) : vertex_remap[parent];
+		splits[i - 1].error = sqrtf(error);
+
+		// collapse targets are collapsed later, so they precede their sources in refinement order
+		assert(splits[i - 1].parent <= i - 1);
+		assert(parent == ~0u || i - 1 >= base_vertex_count);
+
+		error = (parent != ~0u && error < log.errors[v]) ? log.errors[v] : error;
+	}
+
+	// wedges of one position are adjacent in refinement order; a group ends before the next vertex that belongs to a different position
+	size_t group_end = progressive_vertex_count;
+
+	for (size_t i = progressive_vertex_count; i > 0; --i)
+	{
+		unsigned int v = vertex_order[i - 1];
 
-			if (*entry == ~0u)
-				*entry = unsigned(result++);
-		}
-	}
+		if (i == progressive_vertex_count || log.parents[v] == ~0u || log.groups[vertex_order[i]] != log.groups[v])
+			group_end = i;
 
-	return result * 3;
-}
+		splits[i - 1].group_end = unsigned(group_end);
+	}
 
-static float interpolate(float y, float x0, float y0, float x1, float y1, float x2, float y2)
-{
-	// three point interpolation from "revenge of interpolation search" paper
-	float num = (y1 - y) * (x1 - x2) * (x1 - x0) * (y2 - y0);
-	float den = (y2 - y) * (x1 - x2) * (y0 - y1) + (y0 - y) * (x1 - x0) * (y1 - y2);
-	return x1 + num / den;
-}
+	// each triangle becomes active once all of its corners map to distinct vertices; this is monotonic wrt vertex count
+	unsigned int* triangle_levels = allocator.allocate<unsigned int>(index_count / 3);
 
-} // namespace meshopt
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		unsigned int level = 0;
 
-#ifndef NDEBUG
-// Note: this is only exposed for debug visualization purposes; do *not* use these in debug builds
-MESHOPTIMIZER_API unsigned char* meshopt_simplifyDebugKind = 0;
-MESHOPTIMIZER_API unsigned int* meshopt_simplifyDebugLoop = 0;
-MESHOPTIMIZER_API unsigned int* meshopt_simplifyDebugLoopBack = 0;
-#endif
+		for (int e = 0; e < 3; ++e)
+		{
+			unsigned int a = vertex_remap[source[i + e]];
+			unsigned int b = vertex_remap[source[i + (e + 1) % 3]];
 
-size_t meshopt_simplify(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options, float* out_result_error)
-{
-	using namespace meshopt;
+			level = refineLevel(splits, a, b, level);
+		}
 
-	assert(index_count % 3 == 0);
-	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
-	assert(vertex_positions_stride % sizeof(float) == 0);
-	assert(target_index_count <= index_count);
-	assert((options & ~(meshopt_SimplifyLockBorder)) == 0);
+		// base mesh is the coarsest level; collapse chains end at base vertices so they all need to be active
+		triangle_levels[i / 3] = (level != ~0u && level < base_vertex_count) ? unsigned(base_vertex_count) : level;
+	}
 
-	meshopt_Allocator allocator;
+	// counting sort of triangles by activation level; triangles that are never active (degenerate in the source) go last and are discarded
+	unsigned int* level_offsets = allocator.allocate<unsigned int>(progressive_vertex_count + 2);
+	memset(level_offsets, 0, (progressive_vertex_count + 2) * sizeof(unsigned int));
 
-	unsigned int* result = destination;
+	for (size_t i = 0; i < index_count / 3; ++i)
+		level_offsets[triangle_levels[i] == ~0u ? progressive_vertex_count + 1 : triangle_levels[i]]++;
 
-	// build adjacency information
-	EdgeAdjacency adjacency = {};
-	prepareEdgeAdjacency(adjacency, index_count, vertex_count, allocator);
-	updateEdgeAdjacency(adjacency, indices, index_count, vertex_count, NULL);
+	size_t level_sum = 0;
 
-	// build position remap that maps each vertex to the one with identical position
-	unsigned int* remap = allocator.allocate<unsigned int>(vertex_count);
-	unsigned int* wedge = allocator.allocate<unsigned int>(vertex_count);
-	buildPositionRemap(remap, wedge, vertex_positions_data, vertex_count, vertex_positions_stride, allocator);
+	for (size_t i = 0; i < progressive_vertex_count + 2; ++i)
+	{
+		size_t count = level_offsets[i];
+		level_offsets[i] = unsigned(level_sum);
+		level_sum += count;
 
-	// classify vertices; vertex kind determines collapse rules, see kCanCollapse
-	unsigned char* vertex_kind = allocator.allocate<unsigned char>(vertex_count);
-	unsigned int* loop = allocator.allocate<unsigned int>(vertex_count);
-	unsigned int* loopback = allocator.allocate<unsigned int>(vertex_count);
-	classifyVertices(vertex_kind, loop, loopback, vertex_count, adjacency, remap, wedge, options);
+		// the mesh with i vertices contains all triangles with level <= i
+		if (i > 0 && i <= progressive_vertex_count)
+			splits[i - 1].triangle_count = unsigned(level_sum);
+	}
 
-#if TRACE
-	size_t unique_positions = 0;
-	for (size_t i = 0; i < vertex_count; ++i)
-		unique_positions += remap[i] == i;
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		unsigned int level = triangle_levels[i / 3];
 
-	printf("position remap: %d vertices => %d positions\n", int(vertex_count), int(unique_positions));
+		if (level == ~0u)
+			continue;
 
-	size_t kinds[Kind_Count] = {};
-	for (size_t i = 0; i < vertex_count; ++i)
-		kinds[vertex_kind[i]] += remap[i] == i;
+		unsigned int write = level_offsets[level]++;
 
-	printf("kinds: manifold %d, border %d, seam %d, complex %d, locked %d\n",
-	    int(kinds[Kind_Manifold]), int(kinds[Kind_Border]), int(kinds[Kind_Seam]), int(kinds[Kind_Complex]), int(kinds[Kind_Locked]));
-#endif
+		destination[write * 3 + 0] = vertex_remap[source[i + 0]];
+		destination[write * 3 + 1] = vertex_remap[source[i + 1]];
+		destination[write * 3 + 2] = vertex_remap[source[i + 2]];
+	}
 
-	Vector3* vertex_positions = allocator.allocate<Vector3>(vertex_count);
-	rescalePositions(vertex_positions, vertex_positions_data, vertex_count, vertex_positions_stride);
+	// the base mesh matches the result of the regular simplification
+	assert(base_vertex_count == 0 || splits[base_vertex_count - 1].triangle_count * 3 == base_index_count);
 
-	Quadric* vertex_quadrics = allocator.allocate<Quadric>(vertex_count);
-	memset(vertex_quadrics, 0, vertex_count * sizeof(Quadric));
+	return progressive_vertex_count;
+}
 
-	fillFaceQuadrics(vertex_quadrics, indices, index_count, vertex_positions, remap);
-	fillEdgeQuadrics(vertex_quadrics, indices, index_count, vertex_positions, remap, vertex_kind, loop, loopback);
+size_t meshopt_simplifyWithErrors(unsigned int* destination, float* vertex_errors, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options, float* out_result_error)
+{
+	using namespace meshopt;
 
-	if (result != indices)
-		memcpy(result, indices, index_count * sizeof(unsigned int));
+	meshopt_Allocator allocator;
 
-#if TRACE
-	size_t pass_count = 0;
-#endif
+	CollapseLog log = {};
+	log.parents = allocator.allocate<unsigned int>(vertex_count);
+	log.errors = allocator.allocate<float>(vertex_count);
+	log.sequence = allocator.allocate<unsigned int>(vertex_count);
+	log.pass_collapses = allocator.allocate<Collapse>(vertex_count);
+	log.pass_order = allocator.allocate<unsigned int>(vertex_count);
 
-	Collapse* edge_collapses = allocator.allocate<Collapse>(index_count);
-	unsigned int* collapse_order = allocator.allocate<unsigned int>(index_count);
-	unsigned int* collapse_remap = allocator.allocate<unsigned int>(vertex_count);
-	unsigned char* collapse_locked = allocator.allocate<unsigned char>(vertex_count);
+	memset(log.parents, -1, vertex_count * sizeof(unsigned int));
+	memset(log.errors, 0, vertex_count * sizeof(float));
 
-	size_t result_count = index_count;
-	float result_error = 0;
+	size_t result = meshopt_simplifyEdge(NULL, &log, destination, indices, index_count, vertex_positions_data, vertex_count, vertex_positions_stride, NULL, 0, NULL, 0, target_index_count, target_error, options, out_result_error);
 
-	// target_error input is linear; we need to adjust it to match quadricError units
-	float error_limit = target_error * target_error;
+	// each vertex accumulates the errors of all vertices that were collapsed into it, directly or transitively
+	// since collapse targets are collapsed after their sources (or never), processing collapses in order propagates errors in a single pass
+	memset(vertex_errors, 0, vertex_count * sizeof(float));
 
-	while (result_count > target_index_count)
+	for (size_t i = 0; i < log.sequence_count; ++i)
 	{
-		// note: throughout the simplification process adjacency structure reflects welded topology for result-in-progress
-		updateEdgeAdjacency(adjacency, result, result_count, vertex_count, remap);
+		unsigned int v = log.sequence[i];
+		unsigned int parent = log.parents[v];
 
-		size_t edge_collapse_count = pickEdgeCollapses(edge_collapses, result, result_count, remap, vertex_kind, loop);
-
-		// no edges can be collapsed any more due to topology restrictions
-		if (edge_collapse_count == 0)
-			break;
+		float error = vertex_errors[v] < log.errors[v] ? log.errors[v] : vertex_errors[v];
+		vertex_errors[parent] = vertex_errors[parent] < error ? error : vertex_errors[parent];
+	}
 
-		rankEdgeCollapses(edge_collapses, edge_collapse_count, vertex_positions, vertex_quadrics, remap);
+	// errors are quadratic; we need to remap them back to linear
+	for (size_t i = 0; i < vertex_count; ++i)
+		vertex_errors[i] = sqrtf(vertex_errors[i]);
 
-#if TRACE > 1
-		dumpEdgeCollapses(edge_collapses, edge_collapse_count, vertex_kind);
-#endif
+	return result;
+}
 
-		sortEdgeCollapses(collapse_order, edge_collapses, edge_collapse_count);
+size_t meshopt_refineProgressive(unsigned int* destination, const unsigned int* indices, const meshopt_VertexSplit* splits, size_t current_vertex_count, size_t vertex_count)
+{
+	// vertex_count can be 0 when the entire mesh collapses, in which case the result is empty
+	size_t current_triangle_count = current_vertex_count ? splits[current_vertex_count - 1].triangle_count : 0;
+	size_t triangle_count = vertex_count ? splits[vertex_count - 1].triangle_count : 0;
 
-		size_t triangle_collapse_goal = (result_count - target_index_count) / 3;
+	if (vertex_count >= current_vertex_count)
+	{
+		// only corners that reference vertices that weren't active yet may change when refining
+		for (size_t i = 0; i < current_triangle_count * 3; ++i)
+		{
+			unsigned int v = indices[i];
 
-		for (size_t i = 0; i < vertex_count; ++i)
-			collapse_remap[i] = unsigned(i);
+			if (v < current_vertex_count)
+				continue;
 
-		memset(collapse_locked, 0, vertex_count);
+			while (v >= vertex_count)
+				v = splits[v].parent;
 
-#if TRACE
-		printf("pass %d: ", int(pass_count++));
-#endif
+			destination[i] = v;
+		}
 
-		size_t collapses = performEdgeCollapses(collapse_remap, collapse_locked, vertex_quadrics, edge_collapses, edge_collapse_count, collapse_order, remap, wedge, vertex_kind, vertex_positions, adjacency, triangle_collapse_goal, error_limit, result_error);
+		for (size_t i = current_triangle_count * 3; i < triangle_count * 3; ++i)
+		{
+			unsigned int v = indices[i];
 
-		// no edges can be collapsed any more due to hitting the error limit or triangle collapse limit
-		if (collapses == 0)
-			break;
+			while (v >= vertex_count)
+				v = splits[v].parent;
 
-		remapEdgeLoops(loop, vertex_count, collapse_remap);
-		remapEdgeLoops(loopback, vertex_count, collapse_remap);
+			destination[i] = v;
+		}
+	}
+	else
+	{
+		// when coarsening, corners that reference vertices that are no longer active move to their ancestors
+		for (size_t i = 0; i < triangle_count * 3; ++i)
+		{
+			unsigned int v = destination[i];
 
-		size_t new_count = remapIndexBuffer(result, result_count, collapse_remap);
-		assert(new_count < result_count);
+			while (v >= vertex_count)
+				v = splits[v].parent;
 
-		result_count = new_count;
+			destination[i] = v;
+		}
 	}
 
-#if TRACE
-	printf("result: %d triangles, error: %e; total %d passes\n", int(result_count), sqrtf(result_error), int(pass_count));
-#endif
+	return triangle_count * 3;
+}
 
-#if TRACE > 1
-	dumpLockedCollapses(result, result_count, vertex_kind);
-#endif
+size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, float* out_result_error)
+{
+	return meshopt_simplifySloppyWithContext(NULL, destination, indices, index_count, vertex_positions_data, vertex_count, vertex_positions_stride, target_index_count, target_error, out_result_error);
+}
 
-#ifndef NDEBUG
-	if (meshopt_simplifyDebugKind)
-		memcpy(meshopt_simplifyDebugKind, vertex_kind, vertex_count);
+size_t meshopt_simplifySloppyScratchSize(size_t index_count, size_t vertex_count)
+{
+	using namespace meshopt;
 
-	if (meshopt_simplifyDebugLoop)
-		memcpy(meshopt_simplifyDebugLoop, loop, vertex_count * sizeof(unsigned int));
+	// this needs to match the allocation sequence in meshopt_simplifySloppyWithContext
+	// cell count and kept triangle count depend on the result, so we use vertex count and input triangle count as upper bounds
+	size_t size = 0;
 
-	if (meshopt_simplifyDebugLoopBack)
-		memcpy(meshopt_simplifyDebugLoopBack, loopback, vertex_count * sizeof(unsigned int));
-#endif
+	size = meshopt_Allocator::scratchSize<Vector3>(size, vertex_count); // vertex_positions
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // vertex_ids
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, hashBuckets2(vertex_count)); // table
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // vertex_cells
 
-	// result_error is quadratic; we need to remap it back to linear
-	if (out_result_error)
-		*out_result_error = sqrtf(result_error);
+	size = meshopt_Allocator::scratchSize<Quadric>(size, vertex_count); // cell_quadrics
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // cell_remap
+	size = meshopt_Allocator::scratchSize<float>(size, vertex_count); // cell_errors
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, hashBuckets2(index_count / 3)); // tritable
 
-	return result_count;
+	return size;
 }
 
-size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, float* out_result_error)
+size_t meshopt_simplifySloppyWithContext(meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, float* out_result_error)
 {
 	using namespace meshopt;
 
@@ -1432,16 +2595,15 @@ size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* ind
 	// we expect to get ~2 triangles/vertex in the output
 	size_t target_cell_count = target_index_count / 6;
 
-	meshopt_Allocator allocator;
+	meshopt_Tracer zone("meshopt_simplifySloppy");
+	meshopt_Allocator allocator(context);
 
 	Vector3* vertex_positions = allocator.allocate<Vector3>(vertex_count);
 	rescalePositions(vertex_positions, vertex_positions_data, vertex_count, vertex_positions_stride);
 
+	allocator.stage("grid");
+
 	// find the optimal grid size using guided binary search
-#if TRACE
-	printf("source: %d vertices, %d triangles\n", int(vertex_count), int(index_count / 3));
-	printf("target: %d cells, %d triangles\n", int(target_cell_count), int(target_index_count / 3));
-#endif
 
 	unsigned int* vertex_ids = allocator.allocate<unsigned int>(vertex_count);
 
@@ -1475,12 +2637,8 @@ size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* ind
 		computeVertexIds(vertex_ids, vertex_positions, vertex_count, grid_size);
 		size_t triangles = countTriangles(vertex_ids, indices, index_count);
 
-#if TRACE
-		printf("pass %d (%s): grid size %d, triangles %d, %s\n",
-		    pass, (pass == 0) ? "guess" : (pass <= kInterpolationPasses) ? "lerp" : "binary",
-		    grid_size, int(triangles),
-		    (triangles <= target_index_count / 3) ? "under" : "over");
-#endif
+		meshopt_Tracer::counter("simplifySloppy.grid_size", double(grid_size));
+		meshopt_Tracer::counter("simplifySloppy.grid_triangles", double(triangles));
 
 		float tip = interpolate(float(target_index_count / 3), float(min_grid), float(min_triangles), float(grid_size), float(triangles), float(max_grid), float(max_triangles));
 
@@ -1508,6 +2666,8 @@ size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* ind
 		return 0;
 	}
 
+	allocator.stage("cluster");
+
 	// build vertex->cell association by mapping all vertices with the same quantized position to the same cell
 	size_t table_size = hashBuckets2(vertex_count);
 	unsigned int* table = allocator.allocate<unsigned int>(table_size);
@@ -1527,7 +2687,7 @@ size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* ind
 	unsigned int* cell_remap = allocator.allocate<unsigned int>(cell_count);
 	float* cell_errors = allocator.allocate<float>(cell_count);
 
-	fillCellRemap(cell_remap, cell_errors, cell_count, vertex_cells, cell_quadrics, vertex_positions, vertex_count);
+	fillCellRemap(cell_remap, cell_errors, cell_count, vertex_cells, cell_quadrics, vertex_positions, vertex_count, NULL, NULL, 0, 0.f);
 
 	// compute error
 	float result_error = 0.f;
@@ -1542,9 +2702,9 @@ size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* ind
 
 	size_t write = filterTriangles(destination, tritable, tritable_size, indices, index_count, vertex_cells, cell_remap);
 
-#if TRACE
-	printf("result: %d cells, %d triangles (%d unfiltered), error %e\n", int(cell_count), int(write / 3), int(min_triangles), sqrtf(result_error));
-#endif
+	meshopt_Tracer::counter("simplifySloppy.cells", double(cell_count));
+	meshopt_Tracer::counter("simplifySloppy.result_triangles", double(write / 3));
+	meshopt_Tracer::counter("simplifySloppy.result_error", sqrtf(result_error));
 
 	if (out_result_error)
 		*out_result_error = sqrtf(result_error);
@@ -1552,14 +2712,10 @@ size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* ind
 	return write;
 }
 
-size_t meshopt_simplifyPoints(unsigned int* destination, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, size_t target_vertex_count)
+static size_t simplifyPointsGrid(unsigned int* destination, const meshopt::Vector3* vertex_positions, const float* vertex_colors, size_t vertex_colors_stride, float color_weight, size_t vertex_count, size_t target_vertex_count)
 {
 	using namespace meshopt;
 
-	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
-	assert(vertex_positions_stride % sizeof(float) == 0);
-	assert(target_vertex_count <= vertex_count);
-
 	size_t target_cell_count = target_vertex_count;
 
 	if (target_cell_count == 0)
@@ -1567,14 +2723,7 @@ size_t meshopt_simplifyPoints(unsigned int* destination, const float* vertex_pos
 
 	meshopt_Allocator allocator;
 
-	Vector3* vertex_positions = allocator.allocate<Vector3>(vertex_count);
-	rescalePositions(vertex_positions, vertex_positions_data, vertex_count, vertex_positions_stride);
-
 	// find the optimal grid size using guided binary search
-#if TRACE
-	printf("source: %d vertices\n", int(vertex_count));
-	printf("target: %d cells\n", int(target_cell_count));
-#endif
 
 	unsigned int* vertex_ids = allocator.allocate<unsigned int>(vertex_count);
 
@@ -1604,12 +2753,8 @@ size_t meshopt_simplifyPoints(unsigned int* destination, const float* vertex_pos
 		computeVertexIds(vertex_ids, vertex_positions, vertex_count, grid_size);
 		size_t vertices = countVertexCells(table, table_size, vertex_ids, vertex_count);
 
-#if TRACE
-		printf("pass %d (%s): grid size %d, vertices %d, %s\n",
-		    pass, (pass == 0) ? "guess" : (pass <= kInterpolationPasses) ? "lerp" : "binary",
-		    grid_size, int(vertices),
-		    (vertices <= target_vertex_count) ? "under" : "over");
-#endif
+		meshopt_Tracer::counter("simplifyPoints.grid_size", double(grid_size));
+		meshopt_Tracer::counter("simplifyPoints.grid_vertices", double(vertices));
 
 		float tip = interpolate(float(target_vertex_count), float(min_grid), float(min_vertices), float(grid_size), float(vertices), float(max_grid), float(max_vertices));
 
@@ -1651,19 +2796,237 @@ size_t meshopt_simplifyPoints(unsigned int* destination, const float* vertex_pos
 	unsigned int* cell_remap = allocator.allocate<unsigned int>(cell_count);
 	float* cell_errors = allocator.allocate<float>(cell_count);
 
-	fillCellRemap(cell_remap, cell_errors, cell_count, vertex_cells, cell_quadrics, vertex_positions, vertex_count);
+	float* cell_colors = NULL;
+
+	if (vertex_colors)
+	{
+		cell_colors = allocator.allocate<float>(cell_count * 4);
+		memset(cell_colors, 0, cell_count * 4 * sizeof(float));
+
+		fillCellColors(cell_colors, vertex_colors, vertex_colors_stride, vertex_count, vertex_cells);
+	}
+
+	fillCellRemap(cell_remap, cell_errors, cell_count, vertex_cells, cell_quadrics, vertex_positions, vertex_count, cell_colors, vertex_colors, vertex_colors_stride, color_weight);
 
 	// copy results to the output
 	assert(cell_count <= target_vertex_count);
 	memcpy(destination, cell_remap, sizeof(unsigned int) * cell_count);
 
-#if TRACE
-	printf("result: %d cells\n", int(cell_count));
-#endif
+	meshopt_Tracer::counter("simplifyPoints.cells", double(cell_count));
 
 	return cell_count;
 }
 
+size_t meshopt_simplifyPoints(unsigned int* destination, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_colors, size_t vertex_colors_stride, float color_weight, size_t target_vertex_count)
+{
+	using namespace meshopt;
+
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+	assert(vertex_colors_stride == 0 || (vertex_colors_stride >= 12 && vertex_colors_stride <= 256));
+	assert(vertex_colors_stride % sizeof(float) == 0);
+	assert(target_vertex_count <= vertex_count);
+
+	if (target_vertex_count == 0)
+		return 0;
+
+	meshopt_Tracer zone("meshopt_simplifyPoints");
+	meshopt_Allocator allocator;
+
+	Vector3* vertex_positions = allocator.allocate<Vector3>(vertex_count);
+	rescalePositions(vertex_positions, vertex_positions_data, vertex_count, vertex_positions_stride);
+
+	return simplifyPointsGrid(destination, vertex_positions, vertex_colors, vertex_colors_stride, color_weight, vertex_count, target_vertex_count);
+}
+
+size_t meshopt_buildPointHierarchy(meshopt_PointNode* nodes, unsigned int* destination, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, size_t max_node_points, const float* root_bounds)
+{
+	using namespace meshopt;
+
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+	assert(max_node_points > 0);
+
+	// nodes that are this deep are always leaves; this limits recursion for clusters of coincident points
+	const int kMaxDepth = 20;
+
+	if (vertex_count == 0)
+		return 0;
+
+	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+
+	meshopt_Tracer zone("meshopt_buildPointHierarchy");
+	meshopt_Allocator allocator;
+
+	Vector3* node_positions = allocator.allocate<Vector3>(vertex_count);
+	Vector3* sort_positions = allocator.allocate<Vector3>(vertex_count);
+	unsigned int* node_selected = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* node_points = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* sort_remap = allocator.allocate<unsigned int>(vertex_count);
+	unsigned char* point_octants = allocator.allocate<unsigned char>(vertex_count);
+	unsigned char* node_depth = allocator.allocate<unsigned char>(vertex_count);
+
+	float center[3] = {};
+	float extent = 0.f;
+
+	if (root_bounds)
+	{
+		center[0] = root_bounds[0];
+		center[1] = root_bounds[1];
+		center[2] = root_bounds[2];
+		extent = root_bounds[3];
+	}
+	else
+	{
+		float minv[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		float maxv[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+		for (size_t i = 0; i < vertex_count; ++i)
+		{
+			const float* v = vertex_positions_data + i * vertex_stride_float;
+
+			for (int j = 0; j < 3; ++j)
+			{
+				minv[j] = minv[j] > v[j] ? v[j] : minv[j];
+				maxv[j] = maxv[j] < v[j] ? v[j] : maxv[j];
+			}
+		}
+
+		for (int j = 0; j < 3; ++j)
+		{
+			center[j] = (minv[j] + maxv[j]) * 0.5f;
+			extent = extent < (maxv[j] - minv[j]) * 0.5f ? (maxv[j] - minv[j]) * 0.5f : extent;
+		}
+	}
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		destination[i] = unsigned(i);
+
+	meshopt_PointNode root = {0, unsigned(vertex_count), 0, 0, {center[0], center[1], center[2]}, extent};
+	nodes[0] = root;
+	node_depth[0] = 0;
+
+	size_t node_count = 1;
+
+	// nodes are processed in breadth-first order; each node owns a range of points that it partitions into its own points followed by child ranges
+	for (size_t n = 0; n < node_count; ++n)
+	{
+		meshopt_PointNode& node = nodes[n];
+
+		unsigned int* points = destination + node.point_offset;
+		size_t count = node.point_count;
+
+		// compute positions in node space, where node bounds are [0..1]
+		float scale = node.extent > 0.f ? 0.5f / node.extent : 0.f;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float* v = vertex_positions_data + points[i] * vertex_stride_float;
+
+			float x = (v[0] - node.center[0]) * scale + 0.5f;
+			float y = (v[1] - node.center[1]) * scale + 0.5f;
+			float z = (v[2] - node.center[2]) * scale + 0.5f;
+
+			node_positions[i].x = x < 0.f ? 0.f : (x > 1.f ? 1.f : x);
+			node_positions[i].y = y < 0.f ? 0.f : (y > 1.f ? 1.f : y);
+			node_positions[i].z = z < 0.f ? 0.f : (z > 1.f ? 1.f : z);
+		}
+
+		// interior nodes keep a representative subset selected using cell quadrics; remaining points are distributed between children
+		size_t selected = 0;
+
+		if (count > max_node_points && node_depth[n] < kMaxDepth)
+			selected = simplifyPointsGrid(node_selected, node_positions, NULL, 0, 0.f, count, max_node_points);
+
+		const unsigned char kSelected = 8;
+
+		if (selected == 0)
+		{
+			memset(point_octants, kSelected, count);
+		}
+		else
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				const Vector3& v = node_positions[i];
+				point_octants[i] = (unsigned char)((v.x >= 0.5f) | ((v.y >= 0.5f) << 1) | ((v.z >= 0.5f) << 2));
+			}
+
+			for (size_t i = 0; i < selected; ++i)
+				point_octants[node_selected[i]] = kSelected;
+		}
+
+		// counting sort of points by octant; node points come first
+		size_t offsets[9] = {};
+
+		for (size_t i = 0; i < count; ++i)
+			offsets[point_octants[i] == kSelected ? 0 : point_octants[i] + 1]++;
+
+		size_t octant_counts[9];
+		memcpy(octant_counts, offsets, sizeof(offsets));
+
+		size_t offset_sum = 0;
+
+		for (int i = 0; i < 9; ++i)
+		{
+			size_t c = offsets[i];
+			offsets[i] = offset_sum;
+			offset_sum += c;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			size_t write = offsets[point_octants[i] == kSelected ? 0 : point_octants[i] + 1]++;
+
+			node_points[write] = points[i];
+			sort_positions[write] = node_positions[i];
+		}
+
+		// node points are sorted spatially to improve locality of fetches
+		size_t node_point_count = octant_counts[0];
+
+		meshopt_spatialSortRemap(sort_remap, &sort_positions[0].x, node_point_count, sizeof(Vector3));
+
+		for (size_t i = 0; i < node_point_count; ++i)
+			points[sort_remap[i]] = node_points[i];
+
+		memcpy(points + node_point_count, node_points + node_point_count, (count - node_point_count) * sizeof(unsigned int));
+
+		node.point_count = unsigned(node_point_count);
+		node.child_offset = unsigned(node_count);
+		node.child_count = 0;
+
+		// create non-empty children; child ranges follow node points in the same order
+		size_t child_offset = node.point_offset + node_point_count;
+
+		for (int i = 0; i < 8; ++i)
+		{
+			if (octant_counts[i + 1] == 0)
+				continue;
+
+			assert(node_count < vertex_count);
+
+			float child_extent = node.extent * 0.5f;
+
+			meshopt_PointNode child = {};
+			child.point_offset = unsigned(child_offset);
+			child.point_count = unsigned(octant_counts[i + 1]);
+			child.center[0] = node.center[0] + ((i & 1) ? child_extent : -child_extent);
+			child.center[1] = node.center[1] + ((i & 2) ? child_extent : -child_extent);
+			child.center[2] = node.center[2] + ((i & 4) ? child_extent : -child_extent);
+			child.extent = child_extent;
+
+			node_depth[node_count] = (unsigned char)(node_depth[n] + 1);
+			nodes[node_count++] = child;
+
+			node.child_count++;
+			child_offset += octant_counts[i + 1];
+		}
+	}
+
+	return node_count;
+}
+
 float meshopt_simplifyScale(const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
 {
 	using namespace meshopt;
@@ -4,6 +4,25 @@
 #include <assert.h>
 #include <string.h>
 
+namespace meshopt
+{
+
+struct VertexCacheState
+{
+	unsigned int cache_size;
+	unsigned int warp_size;
+	unsigned int primgroup_size;
+
+	unsigned int timestamp;
+	unsigned int warp_offset;
+	unsigned int primgroup_offset;
+
+	unsigned int vertices_transformed;
+	unsigned int warps_executed;
+};
+
+} // namespace meshopt
+
 meshopt_VertexCacheStatistics meshopt_analyzeVertexCache(const unsigned int* indices, size_t index_count, size_t vertex_count, unsigned int cache_size, unsigned int warp_size, unsigned int primgroup_size)
 {
 	assert(index_count % 3 == 0);
@@ -71,3 +90,153 @@ meshopt_VertexCacheStatistics meshopt_analyzeVertexCache(const unsigned int* ind
 
 	return result;
 }
+
+void meshopt_analyzeVertexCacheMulti(meshopt_VertexCacheStatistics* results, const unsigned int* indices, size_t index_count, size_t vertex_count, const unsigned int* cache_sizes, const unsigned int* warp_sizes, const unsigned int* primgroup_sizes, size_t config_count)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(config_count > 0);
+
+	meshopt_Allocator allocator;
+
+	// FIFO caches of different sizes miss on different vertices and flush at different points, so each configuration needs its own state;
+	// timestamps for all configurations are interleaved per vertex so that a single pass over the index buffer touches one contiguous row
+	unsigned int* cache_timestamps = allocator.allocate<unsigned int>(vertex_count * config_count);
+	memset(cache_timestamps, 0, vertex_count * config_count * sizeof(unsigned int));
+
+	VertexCacheState* states = allocator.allocate<VertexCacheState>(config_count);
+
+	for (size_t k = 0; k < config_count; ++k)
+	{
+		assert(cache_sizes[k] >= 3);
+		assert(warp_sizes[k] == 0 || warp_sizes[k] >= 3);
+
+		VertexCacheState& state = states[k];
+
+		state.cache_size = cache_sizes[k];
+		state.warp_size = warp_sizes[k];
+		state.primgroup_size = primgroup_sizes[k];
+		state.timestamp = cache_sizes[k] + 1;
+		state.warp_offset = 0;
+		state.primgroup_offset = 0;
+		state.vertices_transformed = 0;
+		state.warps_executed = 0;
+	}
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		unsigned int a = indices[i + 0], b = indices[i + 1], c = indices[i + 2];
+		assert(a < vertex_count && b < vertex_count && c < vertex_count);
+
+		unsigned int* ta = &cache_timestamps[a * config_count];
+		unsigned int* tb = &cache_timestamps[b * config_count];
+		unsigned int* tc = &cache_timestamps[c * config_count];
+
+		for (size_t k = 0; k < config_count; ++k)
+		{
+			VertexCacheState& state = states[k];
+
+			unsigned int cache_size = state.cache_size;
+			unsigned int timestamp = state.timestamp;
+
+			bool ac = (timestamp - ta[k]) > cache_size;
+			bool bc = (timestamp - tb[k]) > cache_size;
+			bool cc = (timestamp - tc[k]) > cache_size;
+
+			// flush cache if triangle doesn't fit into warp or into the primitive buffer
+			if ((state.primgroup_size && state.primgroup_offset == state.primgroup_size) || (state.warp_size && state.warp_offset + ac + bc + cc > state.warp_size))
+			{
+				state.warps_executed += state.warp_offset > 0;
+
+				state.warp_offset = 0;
+				state.primgroup_offset = 0;
+
+				// reset cache
+				timestamp += cache_size + 1;
+			}
+
+			// update cache and add vertices to warp
+			unsigned int start = timestamp;
+
+			if (timestamp - ta[k] > cache_size)
+				ta[k] = timestamp++;
+
+			if (timestamp - tb[k] > cache_size)
+				tb[k] = timestamp++;
+
+			if (timestamp - tc[k] > cache_size)
+				tc[k] = timestamp++;
+
+			state.vertices_transformed += timestamp - start;
+			state.warp_offset += timestamp - start;
+			state.primgroup_offset++;
+			state.timestamp = timestamp;
+		}
+	}
+
+	// every configuration transforms each referenced vertex at least once, so unique vertices can be counted using any of them
+	size_t unique_vertex_count = 0;
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		unique_vertex_count += cache_timestamps[i * config_count] > 0;
+
+	for (size_t k = 0; k < config_count; ++k)
+	{
+		const VertexCacheState& state = states[k];
+		meshopt_VertexCacheStatistics& result = results[k];
+
+		result.vertices_transformed = state.vertices_transformed;
+		result.warps_executed = state.warps_executed + (state.warp_offset > 0);
+
+		result.acmr = index_count == 0 ? 0 : float(result.vertices_transformed) / float(index_count / 3);
+		result.atvr = unique_vertex_count == 0 ? 0 : float(result.vertices_transformed) / float(unique_vertex_count);
+	}
+}
+
+meshopt_VertexCacheStatistics meshopt_analyzeMeshletCache(const meshopt_Meshlet* meshlets, size_t meshlet_count, const unsigned char* meshlet_triangles, unsigned int cache_size)
+{
+	assert(cache_size >= 3);
+
+	meshopt_VertexCacheStatistics result = {};
+
+	// meshlets have at most 255 vertices, so local vertex indices fit into a fixed size table
+	unsigned int cache_timestamps[256];
+	memset(cache_timestamps, 0, sizeof(cache_timestamps));
+
+	unsigned int timestamp = cache_size + 1;
+
+	size_t triangle_count = 0;
+	size_t vertex_count = 0;
+
+	for (size_t i = 0; i < meshlet_count; ++i)
+	{
+		const meshopt_Meshlet& meshlet = meshlets[i];
+		const unsigned char* indices = meshlet_triangles + meshlet.triangle_offset;
+
+		// reset cache
+		timestamp += cache_size + 1;
+
+		for (size_t j = 0; j < meshlet.triangle_count * 3; ++j)
+		{
+			unsigned char index = indices[j];
+			assert(index < meshlet.vertex_count);
+
+			if (timestamp - cache_timestamps[index] > cache_size)
+			{
+				cache_timestamps[index] = timestamp++;
+				result.vertices_transformed++;
+			}
+		}
+
+		triangle_count += meshlet.triangle_count;
+		vertex_count += meshlet.vertex_count;
+	}
+
+	result.warps_executed = unsigned(meshlet_count);
+
+	result.acmr = triangle_count == 0 ? 0 : float(result.vertices_transformed) / float(triangle_count);
+	result.atvr = vertex_count == 0 ? 0 : float(result.vertices_transformed) / float(vertex_count);
+
+	return result;
+}
@@ -13,11 +13,8 @@ namespace meshopt
 const size_t kCacheSizeMax = 16;
 const size_t kValenceMax = 8;
 
-struct VertexScoreTable
-{
-	float cache[1 + kCacheSizeMax];
-	float live[1 + kValenceMax];
-};
+// Public table type; its array sizes must match the limits above
+typedef meshopt_VertexScoreTable VertexScoreTable;
 
 // Tuned to minimize the ACMR of a GPU that has a cache profile similar to NVidia and AMD
 static const VertexScoreTable kVertexScoreTable = {
@@ -164,15 +161,37 @@ static unsigned int getNextTriangleDeadEnd(unsigned int& input_cursor, const uns
 	return ~0u;
 }
 
+static size_t optimizeVertexCacheScratchSize(size_t index_count, size_t vertex_count, bool inplace)
+{
+	size_t face_count = index_count / 3;
+
+	// this needs to match the allocation sequence in optimizeVertexCacheTable
+	size_t size = 0;
+
+	if (inplace)
+		size = meshopt_Allocator::scratchSize<unsigned int>(size, index_count); // indices_copy
+
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // adjacency.counts
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // adjacency.offsets
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, index_count); // adjacency.data
+	size = meshopt_Allocator::scratchSize<unsigned int>(size, vertex_count); // live_triangles
+	size = meshopt_Allocator::scratchSize<unsigned char>(size, face_count); // emitted_flags
+	size = meshopt_Allocator::scratchSize<float>(size, vertex_count); // vertex_scores
+	size = meshopt_Allocator::scratchSize<float>(size, face_count); // triangle_scores
+
+	return size;
+}
+
 } // namespace meshopt
 
-void meshopt_optimizeVertexCacheTable(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const meshopt::VertexScoreTable* table)
+static void optimizeVertexCacheTable(meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const meshopt::VertexScoreTable* table)
 {
 	using namespace meshopt;
 
 	assert(index_count % 3 == 0);
 
-	meshopt_Allocator allocator;
+	meshopt_Tracer zone("meshopt_optimizeVertexCache");
+	meshopt_Allocator allocator(context);
 
 	// guard for empty meshes
 	if (index_count == 0 || vertex_count == 0)
@@ -188,6 +207,7 @@ void meshopt_optimizeVertexCacheTable(unsigned int* destination, const unsigned
 
 	unsigned int cache_size = 16;
 	assert(cache_size <= kCacheSizeMax);
+	assert(sizeof(table->cache) == sizeof(float) * (1 + kCacheSizeMax) && sizeof(table->live) == sizeof(float) * (1 + kValenceMax));
 
 	size_t face_count = index_count / 3;
 
@@ -348,14 +368,108 @@ void meshopt_optimizeVertexCacheTable(unsigned int* destination, const unsigned
 	assert(output_triangle == face_count);
 }
 
+void meshopt_optimizeVertexCacheTable(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const meshopt_VertexScoreTable* table)
+{
+	optimizeVertexCacheTable(NULL, destination, indices, index_count, vertex_count, table);
+}
+
 void meshopt_optimizeVertexCache(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count)
 {
-	meshopt_optimizeVertexCacheTable(destination, indices, index_count, vertex_count, &meshopt::kVertexScoreTable);
+	optimizeVertexCacheTable(NULL, destination, indices, index_count, vertex_count, &meshopt::kVertexScoreTable);
+}
+
+void meshopt_optimizeVertexCacheWithContext(meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count)
+{
+	optimizeVertexCacheTable(context, destination, indices, index_count, vertex_count, &meshopt::kVertexScoreTable);
+}
+
+size_t meshopt_optimizeVertexCacheChunked(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t chunk_triangles)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(chunk_triangles >= 1);
+
+	meshopt_Tracer zone("meshopt_optimizeVertexCacheChunked");
+	meshopt_Allocator allocator;
+
+	// guard for empty meshes
+	if (index_count == 0 || vertex_count == 0)
+		return 0;
+
+	size_t face_count = index_count / 3;
+
+	// split the mesh into spatially coherent chunks; this also copies indices to destination, grouped by chunk
+	unsigned int* chunk_offsets = allocator.allocate<unsigned int>((face_count + chunk_triangles - 1) / chunk_triangles + 1);
+	size_t chunk_count = meshopt_partitionMeshletRegions(destination, chunk_offsets, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, chunk_triangles);
+
+	size_t chunk_indices = chunk_triangles * 3 < index_count ? chunk_triangles * 3 : index_count;
+
+	// chunk vertices are renumbered so that the cache optimizer only allocates memory proportional to the chunk size
+	// vertices that are not in the current chunk are marked with ~0u, or with ~1u if they were used by one of the previous chunks
+	unsigned int* remap = allocator.allocate<unsigned int>(vertex_count);
+	memset(remap, -1, vertex_count * sizeof(unsigned int));
+
+	unsigned int* chunk_vertices = allocator.allocate<unsigned int>(chunk_indices);
+	unsigned int* chunk_buffer = allocator.allocate<unsigned int>(chunk_indices);
+
+	// all chunks are optimized with the same scratch memory, which is sized for the largest possible chunk up front
+	meshopt_Context chunk_context = {};
+	chunk_context.scratch_size = optimizeVertexCacheScratchSize(chunk_indices, chunk_indices, /* inplace= */ true);
+
+	size_t duplicate_vertices = 0;
+
+	for (size_t i = 0; i < chunk_count; ++i)
+	{
+		unsigned int* chunk = destination + chunk_offsets[i];
+		size_t chunk_size = chunk_offsets[i + 1] - chunk_offsets[i];
+		assert(chunk_size <= chunk_indices);
+
+		unsigned int chunk_vertex_count = 0;
+
+		for (size_t j = 0; j < chunk_size; ++j)
+		{
+			unsigned int index = chunk[j];
+			assert(index < vertex_count);
+
+			if (remap[index] >= ~1u)
+			{
+				// vertices shared with a previous chunk will be transformed again
+				duplicate_vertices += remap[index] == ~1u;
+
+				chunk_vertices[chunk_vertex_count] = index;
+				remap[index] = chunk_vertex_count++;
+			}
+
+			chunk_buffer[j] = remap[index];
+		}
+
+		// chunks are independent, so this is the part that callers can parallelize if they split the mesh themselves
+		optimizeVertexCacheTable(&chunk_context, chunk_buffer, chunk_buffer, chunk_size, chunk_vertex_count, &kVertexScoreTable);
+
+		for (size_t j = 0; j < chunk_size; ++j)
+			chunk[j] = chunk_vertices[chunk_buffer[j]];
+
+		for (size_t j = 0; j < chunk_vertex_count; ++j)
+			remap[chunk_vertices[j]] = ~1u;
+	}
+
+	meshopt_freeContext(&chunk_context);
+
+	meshopt_Tracer::counter("optimizeVertexCacheChunked.chunks", double(chunk_count));
+	meshopt_Tracer::counter("optimizeVertexCacheChunked.duplicates", double(duplicate_vertices));
+
+	return duplicate_vertices;
 }
 
 void meshopt_optimizeVertexCacheStrip(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count)
 {
-	meshopt_optimizeVertexCacheTable(destination, indices, index_count, vertex_count, &meshopt::kVertexScoreTableStrip);
+	optimizeVertexCacheTable(NULL, destination, indices, index_count, vertex_count, &meshopt::kVertexScoreTableStrip);
+}
+
+void meshopt_optimizeVertexCacheStripWithContext(meshopt_Context* context, unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count)
+{
+	optimizeVertexCacheTable(context, destination, indices, index_count, vertex_count, &meshopt::kVertexScoreTableStrip);
 }
 
 void meshopt_optimizeVertexCacheFifo(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, unsigned int cache_size)
@@ -365,6 +479,7 @@ void meshopt_optimizeVertexCacheFifo(unsigned int* destination, const unsigned i
 	assert(index_count % 3 == 0);
 	assert(cache_size >= 3);
 
+	meshopt_Tracer zone("meshopt_optimizeVertexCacheFifo");
 	meshopt_Allocator allocator;
 
 	// guard for empty meshes
@@ -56,3 +56,79 @@ meshopt_VertexFetchStatistics meshopt_analyzeVertexFetch(const unsigned int* ind
 
 	return result;
 }
+
+void meshopt_analyzeVertexFetchMulti(meshopt_VertexFetchStatistics* results, const unsigned int* indices, size_t index_count, size_t vertex_count, const size_t* vertex_sizes, const size_t* cache_line_sizes, size_t stream_count)
+{
+	assert(index_count % 3 == 0);
+	assert(stream_count > 0 && stream_count <= 16);
+
+	meshopt_Allocator allocator;
+
+	unsigned char* vertex_visited = allocator.allocate<unsigned char>(vertex_count);
+	memset(vertex_visited, 0, vertex_count);
+
+	const size_t kCacheSize = 128 * 1024;
+	const size_t kCacheLineMin = 16;
+
+	// streams are placed in separate page-aligned buffers within one address space, so that they compete for the same cache
+	size_t stream_base[16];
+	size_t address = 0;
+
+	for (size_t k = 0; k < stream_count; ++k)
+	{
+		size_t cache_line = cache_line_sizes ? cache_line_sizes[k] : 64;
+
+		assert(vertex_sizes[k] > 0 && vertex_sizes[k] <= 256);
+		assert(cache_line >= kCacheLineMin && cache_line <= 4096 && (cache_line & (cache_line - 1)) == 0);
+		(void)cache_line;
+
+		stream_base[k] = address;
+		address += (vertex_count * vertex_sizes[k] + 4095) & ~size_t(4095);
+
+		meshopt_VertexFetchStatistics zero = {};
+		results[k] = zero;
+	}
+
+	// simple direct mapped cache shared by all streams, with a number of lines that depends on the cache line size of each stream;
+	// cache entries store the line address + 1 since cache is filled with 0 by default and line addresses are unique across streams
+	size_t* cache = allocator.allocate<size_t>(kCacheSize / kCacheLineMin);
+	memset(cache, 0, kCacheSize / kCacheLineMin * sizeof(size_t));
+
+	for (size_t i = 0; i < index_count; ++i)
+	{
+		unsigned int index = indices[i];
+		assert(index < vertex_count);
+
+		vertex_visited[index] = 1;
+
+		for (size_t k = 0; k < stream_count; ++k)
+		{
+			size_t vertex_size = vertex_sizes[k];
+			size_t cache_line = cache_line_sizes ? cache_line_sizes[k] : 64;
+
+			size_t start_address = stream_base[k] + index * vertex_size;
+			size_t end_address = start_address + vertex_size;
+
+			size_t start_tag = start_address / cache_line;
+			size_t end_tag = (end_address + cache_line - 1) / cache_line;
+
+			assert(start_tag < end_tag);
+
+			for (size_t tag = start_tag; tag < end_tag; ++tag)
+			{
+				size_t line = tag % (kCacheSize / cache_line);
+
+				results[k].bytes_fetched += (cache[line] != tag * cache_line + 1) * unsigned(cache_line);
+				cache[line] = tag * cache_line + 1;
+			}
+		}
+	}
+
+	size_t unique_vertex_count = 0;
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		unique_vertex_count += vertex_visited[i];
+
+	for (size_t k = 0; k < stream_count; ++k)
+		results[k].overfetch = unique_vertex_count == 0 ? 0 : float(results[k].bytes_fetched) / float(unique_vertex_count * vertex_sizes[k]);
+}
@@ -28,12 +28,69 @@ size_t meshopt_optimizeVertexFetchRemap(unsigned int* destination, const unsigne
 	return next_vertex;
 }
 
+size_t meshopt_optimizeVertexFetchRemapShadow(unsigned int* destination, const unsigned int* indices, const unsigned int* shadow_indices, size_t index_count, size_t vertex_count)
+{
+	assert(index_count % 3 == 0);
+
+	meshopt_Allocator allocator;
+
+	memset(destination, -1, vertex_count * sizeof(unsigned int));
+
+	// vertices that are only referenced by the full pass are deferred until the end of a window of vertices referenced by both passes;
+	// this keeps vertices used by the shadow index buffer contiguous without moving the rest far from their first use
+	const size_t kWindowSize = 256;
+
+	unsigned int* deferred = allocator.allocate<unsigned int>(vertex_count);
+	size_t deferred_count = 0;
+
+	unsigned int next_vertex = 0;
+	size_t window = 0;
+
+	for (size_t i = 0; i < index_count; ++i)
+	{
+		unsigned int index = indices[i];
+		unsigned int shadow = shadow_indices[i];
+		assert(index < vertex_count && shadow < vertex_count);
+
+		if (destination[shadow] == ~0u)
+		{
+			destination[shadow] = next_vertex++;
+			window++;
+		}
+
+		if (destination[index] == ~0u)
+		{
+			// mark vertex as deferred so that it's only added once
+			destination[index] = ~1u;
+			deferred[deferred_count++] = index;
+		}
+
+		if (window >= kWindowSize || i + 1 == index_count)
+		{
+			for (size_t j = 0; j < deferred_count; ++j)
+				destination[deferred[j]] = next_vertex++;
+
+			deferred_count = 0;
+			window = 0;
+		}
+	}
+
+	assert(next_vertex <= vertex_count);
+
+	return next_vertex;
+}
+
 size_t meshopt_optimizeVertexFetch(void* destination, unsigned int* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size)
+{
+	return meshopt_optimizeVertexFetchWithContext(NULL, destination, indices, index_count, vertices, vertex_count, vertex_size);
+}
+
+size_t meshopt_optimizeVertexFetchWithContext(meshopt_Context* context, void* destination, unsigned int* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size)
 {
 	assert(index_count % 3 == 0);
 	assert(vertex_size > 0 && vertex_size <= 256);
 
-	meshopt_Allocator allocator;
+	meshopt_Allocator allocator(context);
 
 	// support in-place optimization
 	if (destination == vertices)
@@ -72,3 +129,70 @@ size_t meshopt_optimizeVertexFetch(void* destination, unsigned int* indices, siz
 
 	return next_vertex;
 }
+
+size_t meshopt_optimizeMesh(unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, void* const* streams, const size_t* stream_sizes, size_t stream_count, unsigned int options, float overdraw_threshold)
+{
+	return meshopt_optimizeMeshWithContext(NULL, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, streams, stream_sizes, stream_count, options, overdraw_threshold);
+}
+
+size_t meshopt_optimizeMeshWithContext(meshopt_Context* context, unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, void* const* streams, const size_t* stream_sizes, size_t stream_count, unsigned int options, float overdraw_threshold)
+{
+	assert(index_count % 3 == 0);
+	assert((options & meshopt_OptimizeMeshOverdraw) == 0 || vertex_positions);
+
+	meshopt_Tracer zone("meshopt_optimizeMesh");
+
+	// individual steps are nested calls, so they reuse the same scratch memory one after another and statistics cover the entire call
+	meshopt_Allocator allocator(context);
+
+	if (options & meshopt_OptimizeMeshStrip)
+		meshopt_optimizeVertexCacheStripWithContext(context, indices, indices, index_count, vertex_count);
+	else
+		meshopt_optimizeVertexCacheWithContext(context, indices, indices, index_count, vertex_count);
+
+	// overdraw optimization reads positions before streams are remapped, so vertex_positions may point into one of the streams
+	if (options & meshopt_OptimizeMeshOverdraw)
+		meshopt_optimizeOverdrawWithContext(context, indices, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, overdraw_threshold);
+
+	// fetch remap and index buffer remap are done in a single pass
+	unsigned int* remap = allocator.allocate<unsigned int>(vertex_count);
+	memset(remap, -1, vertex_count * sizeof(unsigned int));
+
+	unsigned int next_vertex = 0;
+
+	for (size_t i = 0; i < index_count; ++i)
+	{
+		unsigned int index = indices[i];
+		assert(index < vertex_count);
+
+		if (remap[index] == ~0u)
+			remap[index] = next_vertex++;
+
+		indices[i] = remap[index];
+	}
+
+	// a single copy buffer is shared by all streams instead of allocating one per stream
+	size_t max_size = 0;
+
+	for (size_t k = 0; k < stream_count; ++k)
+	{
+		assert(stream_sizes[k] > 0 && stream_sizes[k] <= 256);
+		max_size = stream_sizes[k] > max_size ? stream_sizes[k] : max_size;
+	}
+
+	unsigned char* copy = allocator.allocate<unsigned char>(vertex_count * max_size);
+
+	for (size_t k = 0; k < stream_count; ++k)
+	{
+		unsigned char* data = static_cast<unsigned char*>(streams[k]);
+		size_t size = stream_sizes[k];
+
+		memcpy(copy, data, vertex_count * size);
+
+		for (size_t i = 0; i < vertex_count; ++i)
+			if (remap[i] != ~0u)
+				memcpy(data + remap[i] * size, copy + i * size, size);
+	}
+
+	return next_vertex;
+}
@@ -16,17 +16,6 @@
 const int kCacheSizeMax = 16;
 const int kValenceMax = 8;
 
-namespace meshopt
-{
-	struct VertexScoreTable
-	{
-		float cache[1 + kCacheSizeMax];
-		float live[1 + kValenceMax];
-	};
-} // namespace meshopt
-
-void meshopt_optimizeVertexCacheTable(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const meshopt::VertexScoreTable* table);
-
 struct Profile
 {
 	float weight;
@@ -209,7 +198,7 @@ void compute_metric(const State* state, const Mesh& mesh, float result[Profile_C
 
 	if (state)
 	{
-		meshopt::VertexScoreTable table = {};
+		meshopt_VertexScoreTable table = {};
 		memcpy(table.cache + 1, state->cache, kCacheSizeMax * sizeof(float));
 		memcpy(table.live + 1, state->live, kValenceMax * sizeof(float));
 		meshopt_optimizeVertexCacheTable(&indices[0], &mesh.indices[0], mesh.indices.size(), mesh.vertex_count, &table);
@@ -232,14 +221,35 @@ void compute_metric(const State* state, const Mesh& mesh, float result[Profile_C
 		}
 	}
 
+	// analyze all cache profiles in a single pass over the index buffer
+	unsigned int cache_sizes[Profile_Count], warp_sizes[Profile_Count], primgroup_sizes[Profile_Count];
+	int cache_profiles[Profile_Count];
+	size_t cache_count = 0;
+
 	for (int profile = 0; profile < Profile_Count; ++profile)
 	{
 		if (profiles[profile].cache)
 		{
-			meshopt_VertexCacheStatistics stats = meshopt_analyzeVertexCache(&indices[0], indices.size(), mesh.vertex_count, profiles[profile].cache, profiles[profile].warp, profiles[profile].triangle);
-			result[profile] = stats.atvr;
+			cache_sizes[cache_count] = profiles[profile].cache;
+			warp_sizes[cache_count] = profiles[profile].warp;
+			primgroup_sizes[cache_count] = profiles[profile].triangle;
+			cache_profiles[cache_count] = profile;
+			cache_count++;
 		}
-		else
+	}
+
+	if (cache_count)
+	{
+		meshopt_VertexCacheStatistics stats[Profile_Count];
+		meshopt_analyzeVertexCacheMulti(stats, &indices[0], indices.size(), mesh.vertex_count, cache_sizes, warp_sizes, primgroup_sizes, cache_count);
+
+		for (size_t i = 0; i < cache_count; ++i)
+			result[cache_profiles[i]] = stats[i].atvr;
+	}
+
+	for (int profile = 0; profile < Profile_Count; ++profile)
+	{
+		if (profiles[profile].cache == 0)
 		{
 			// take into account both pre-deflate and post-deflate size but focus a bit more on post-deflate
 			size_t csize = profiles[profile].compression ? compress(ibuf) : ibuf.size();
@@ -395,6 +405,30 @@ bool save_state(const char* path, const std::vector<State>& result)
 	return fclose(file) == 0;
 }
 
+bool save_table(const char* path, const State& state)
+{
+	FILE* file = fopen(path, "w");
+	if (!file)
+		return false;
+
+	// meshopt_VertexScoreTable initializer; entry 0 of both arrays is unused by the tuner
+	fprintf(file, "const meshopt_VertexScoreTable kVertexScoreTable = {\n");
+
+	fprintf(file, "    {0.f");
+	for (int i = 0; i < kCacheSizeMax; ++i)
+		fprintf(file, ", %.3ff", state.cache[i]);
+	fprintf(file, "},\n");
+
+	fprintf(file, "    {0.f");
+	for (int i = 0; i < kValenceMax; ++i)
+		fprintf(file, ", %.3ff", state.live[i]);
+	fprintf(file, "},\n");
+
+	fprintf(file, "};\n");
+
+	return fclose(file) == 0;
+}
+
 void dump_state(const State& state)
 {
 	printf("cache:");
@@ -494,5 +528,10 @@ int main(int argc, char** argv)
 		{
 			printf("ERROR: Can't save state\n");
 		}
+
+		if (!save_table("mutator.table", best.first))
+		{
+			printf("ERROR: Can't save table\n");
+		}
 	}
 }